@@ -0,0 +1,198 @@
+/** @file
+*
+* @defgroup nrf-sync_common_beacon_impl sync_beacon.c
+* @{
+* @ingroup nrf-sync_common
+* @brief Sync beacon implementation.
+*
+*/
+
+#include "sync_beacon.h"
+
+/**
+ * @brief Function for writing a little endian 32-bit value.
+ */
+static void put32(uint8_t *buffer, uint32_t value) {
+    buffer[0] = (uint8_t)(value);
+    buffer[1] = (uint8_t)(value >> 8);
+    buffer[2] = (uint8_t)(value >> 16);
+    buffer[3] = (uint8_t)(value >> 24);
+}
+
+/**
+ * @brief Function for reading a little endian 32-bit value.
+ */
+static uint32_t get32(const uint8_t *buffer) {
+    return  (uint32_t)buffer[0]        |
+           ((uint32_t)buffer[1] << 8)  |
+           ((uint32_t)buffer[2] << 16) |
+           ((uint32_t)buffer[3] << 24);
+}
+
+/**
+ * @brief Function for converting a tick count to ns without overflowing on long intervals.
+ */
+static int64_t ticks_to_ns(uint32_t ticks, uint8_t prescaler) {
+    return ((int64_t)ticks * 1000000) / (int64_t)SYNC_TICKS_PER_MS(prescaler);
+}
+
+void sync_beacon_pack(uint8_t *buffer, const sync_beacon_t *beacon) {
+    buffer[0] = SYNC_BEACON_MAGIC;
+    buffer[1] = SYNC_BEACON_VERSION;
+    buffer[2] = beacon->prescaler;
+    buffer[3] = (uint8_t)((beacon->copy & 0x0F) | ((beacon->copies - 1) << 4));
+    put32(&buffer[4],  beacon->sequence);
+    put32(&buffer[8],  beacon->period_us);
+    put32(&buffer[12], beacon->width_us);
+    put32(&buffer[16], beacon->timestamp);
+    put32(&buffer[20], beacon->next_period_us);
+    put32(&buffer[24], beacon->next_width_us);
+    put32(&buffer[28], beacon->switch_sequence);
+    put32(&buffer[32], beacon->channel_map);
+    put32(&buffer[36], beacon->next_channel_map);
+    put32(&buffer[40], beacon->channel_switch);
+    put32(&buffer[44], (beacon->reply_time & SYNC_BEACON_REPLY_MAX) | ((uint32_t)beacon->reply_node << 24));
+}
+
+void sync_beacon_copy(uint8_t *buffer, const uint8_t *beacon, uint8_t copy) {
+
+    for (uint32_t i = 0; i < SYNC_BEACON_LENGTH; i++) {
+        buffer[i] = beacon[i];
+    }
+    buffer[3] = (uint8_t)((beacon[3] & 0xF0) | (copy & 0x0F));
+}
+
+bool sync_beacon_parse(const uint8_t *buffer, sync_beacon_t *beacon) {
+
+    if (buffer[0] != SYNC_BEACON_MAGIC || buffer[1] != SYNC_BEACON_VERSION || buffer[2] > SYNC_PRESCALER_1MHZ) {
+        return false;
+    }
+
+    beacon->prescaler       = buffer[2];
+    beacon->copy            = buffer[3] & 0x0F;
+    beacon->copies          = (uint8_t)((buffer[3] >> 4) + 1);
+    beacon->sequence        = get32(&buffer[4]);
+    beacon->period_us       = get32(&buffer[8]);
+    beacon->width_us        = get32(&buffer[12]);
+    beacon->timestamp       = get32(&buffer[16]);
+    beacon->next_period_us  = get32(&buffer[20]);
+    beacon->next_width_us   = get32(&buffer[24]);
+    beacon->switch_sequence = get32(&buffer[28]);
+    beacon->channel_map     = get32(&buffer[32]);
+    beacon->next_channel_map = get32(&buffer[36]);
+    beacon->channel_switch  = get32(&buffer[40]);
+    beacon->reply_time      = get32(&buffer[44]) & SYNC_BEACON_REPLY_MAX;
+    beacon->reply_node      = buffer[47];
+
+    if (beacon->copy >= beacon->copies || beacon->width_us == 0 || beacon->width_us >= beacon->period_us) {
+        return false;
+    }
+
+    return !sync_beacon_pending(beacon) ||
+           (beacon->next_width_us > 0 && beacon->next_width_us < beacon->next_period_us);
+}
+
+bool sync_beacon_pending(const sync_beacon_t *beacon) {
+    // sequence numbers wrap, the switch is at most half the sequence range ahead
+    return (int32_t)(beacon->switch_sequence - beacon->sequence) > 0;
+}
+
+void sync_beacon_schedule(const sync_beacon_t *beacon, uint32_t sequence, uint32_t *period_us, uint32_t *width_us) {
+
+    if (sync_beacon_pending(beacon) && (int32_t)(sequence - beacon->switch_sequence) >= 0) {
+        *period_us = beacon->next_period_us;
+        *width_us  = beacon->next_width_us;
+    } else {
+        *period_us = beacon->period_us;
+        *width_us  = beacon->width_us;
+    }
+}
+
+uint32_t sync_beacon_channel_map(const sync_beacon_t *beacon, uint32_t sequence) {
+
+    // same wrapping rule as sync_beacon_pending()
+    if ((int32_t)(beacon->channel_switch - beacon->sequence) > 0 && (int32_t)(sequence - beacon->channel_switch) >= 0) {
+        return beacon->next_channel_map;
+    }
+    return beacon->channel_map;
+}
+
+void sync_beacon_stats_init(sync_beacon_stats_t *stats) {
+    stats->received       = 0;
+    stats->missed         = 0;
+    stats->invalid        = 0;
+    stats->restarts       = 0;
+    stats->last_sequence  = 0;
+    stats->last_rx        = 0;
+    stats->pair_rx        = 0;
+    stats->pair_tx        = 0;
+    stats->pair_prescaler = 0;
+    stats->has_last       = false;
+    stats->has_pair       = false;
+    stats->intervals      = 0;
+    stats->interval_min   = 0;
+    stats->interval_max   = 0;
+    stats->interval_sum   = 0;
+}
+
+uint32_t sync_beacon_stats_add(sync_beacon_stats_t *stats, const sync_beacon_t *beacon, uint32_t rx_timestamp, uint8_t rx_prescaler) {
+    uint32_t missed = 0;
+
+    stats->received++;
+
+    if (stats->has_last) {
+        uint32_t gap = beacon->sequence - stats->last_sequence;
+
+        if (gap == 0 || gap > 0x80000000UL || beacon->prescaler != stats->pair_prescaler) {
+            // transmitter restarted (or reconfigured), earlier timestamps are meaningless
+            stats->restarts++;
+            stats->has_pair = false;
+        } else {
+            missed         = gap - 1;
+            stats->missed += missed;
+
+            if (gap == 1) {
+                // the timestamp is the transmission time of the last beacon we received
+                if (stats->has_pair) {
+                    int64_t rx_interval = ticks_to_ns(stats->last_rx - stats->pair_rx, rx_prescaler);
+                    int64_t tx_interval = ticks_to_ns(beacon->timestamp - stats->pair_tx, beacon->prescaler);
+                    int32_t error       = (int32_t)(rx_interval - tx_interval);
+
+                    if (stats->intervals == 0 || error < stats->interval_min) {
+                        stats->interval_min = error;
+                    }
+                    if (stats->intervals == 0 || error > stats->interval_max) {
+                        stats->interval_max = error;
+                    }
+                    stats->interval_sum += error;
+                    stats->intervals++;
+                }
+
+                stats->pair_rx  = stats->last_rx;
+                stats->pair_tx  = beacon->timestamp;
+                stats->has_pair = true;
+            } else {
+                // only compare intervals of one period, so the errors can be compared with each other
+                stats->has_pair = false;
+            }
+        }
+    }
+
+    stats->pair_prescaler = beacon->prescaler;
+    stats->last_sequence  = beacon->sequence;
+    stats->last_rx        = rx_timestamp;
+    stats->has_last       = true;
+
+    return missed;
+}
+
+int32_t sync_beacon_stats_interval_mean(const sync_beacon_stats_t *stats) {
+    if (stats->intervals == 0) {
+        return 0;
+    }
+    return (int32_t)(stats->interval_sum / (int64_t)stats->intervals);
+}
+
+/**
+ *@}
+ **/
@@ -0,0 +1,173 @@
+/** @file
+*
+* @defgroup nrf-sync_common_beacon sync_beacon.h
+* @{
+* @ingroup nrf-sync_common
+* @brief Sync beacon format and receiver statistics.
+*
+* The beacon is the payload the transmitter sends every period. It is packed
+* and parsed directly in the buffer RADIO PACKETPTR points to, so there is no
+* intermediate copy. All fields are little endian, byte by byte:
+*
+*     offset  size  field
+*     0       1     magic (SYNC_BEACON_MAGIC)
+*     1       1     version (SYNC_BEACON_VERSION)
+*     2       1     TIMER prescaler of the timestamp
+*     3       1     copy index in the burst (bits 0-3) and copies per burst - 1 (bits 4-7), see sync_burst.h
+*     4       4     sequence number, +1 every beacon
+*     8       4     period in us
+*     12      4     pulse width in us
+*     16      4     address time of the previous beacon on the transmitter TIMER
+*     20      4     next period in us
+*     24      4     next pulse width in us
+*     28      4     switch sequence number, first beacon of the next schedule
+*     32      4     channel map of the hop sequence (see sync_hop.h), 0 on a fixed channel
+*     36      4     next channel map
+*     40      4     channel switch sequence number, first beacon sent with the next channel map
+*     44      4     reply time in ns (bits 0-23) and node (bits 24-31) of the last two-way request, see sync_twoway.h
+*
+* A schedule change is announced ahead: until the switch sequence number, the
+* beacons carry both the schedule in effect and the next one, so every receiver
+* switches on the same beacon. Without a pending change, the next schedule
+* repeats the current one and the switch sequence number is not in the future.
+*
+* The channel map of a beacon selects the channels the following beacon can be
+* sent on, so a receiver that heard it knows where to listen next. A change of
+* channel map is announced ahead the same way as a schedule change, with its own
+* switch sequence number.
+*
+* The copies of a burst are the same beacon but for the copy index, and their
+* timestamp is the one of the first copy of the burst before.
+*
+* The reply answers the two-way request sent after the beacon before, if the
+* transmitter received one: the time from the address of that beacon to the
+* request, on the transmitter clock. The node is SYNC_BEACON_NO_REPLY otherwise.
+*
+* The timestamp cannot be the one of the beacon carrying it (the payload is
+* read by EasyDMA before the address is sent), so it is the one of the beacon
+* before, the same way as a two-step clock sends a follow-up.
+*
+* This module does not touch any peripheral so it can also be built on a host.
+*
+*/
+
+#ifndef SYNC_BEACON_H
+#define SYNC_BEACON_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sync_timing.h"
+
+#define SYNC_BEACON_MAGIC            42     // first byte of every beacon
+#define SYNC_BEACON_VERSION          6      // incremented when the format changes
+#define SYNC_BEACON_LENGTH           48UL   // payload length in bytes
+#define SYNC_BEACON_PERIOD_LONG      0xFFFFFFFFUL  // period_us of a period too long for the field (~71 min)
+#define SYNC_BEACON_NO_REPLY         0xFF   // reply_node of a beacon answering no request
+#define SYNC_BEACON_REPLY_MAX        0xFFFFFFUL    // longest reply time in ns (~16.7 ms)
+
+/**
+ * @brief Conversion of a time in ms to the us of the beacon fields.
+ */
+#define SYNC_BEACON_MS_TO_US(ms)     SYNC_MS_TO_TICKS(ms, SYNC_PRESCALER_1MHZ)
+
+/**
+ * @brief Beacon fields.
+ */
+typedef struct {
+    uint32_t sequence;          // sequence number
+    uint32_t period_us;         // period of the schedule in us, or SYNC_BEACON_PERIOD_LONG
+    uint32_t width_us;          // pulse width in us
+    uint32_t timestamp;         // address time of beacon sequence - 1, in transmitter ticks
+    uint8_t  prescaler;         // TIMER prescaler of the timestamp
+    uint8_t  copy;              // copy index in the burst
+    uint8_t  copies;            // copies per burst, 1 to 16
+    uint32_t next_period_us;    // period from beacon switch_sequence on
+    uint32_t next_width_us;     // pulse width from beacon switch_sequence on
+    uint32_t switch_sequence;   // first beacon of the next schedule
+    uint32_t channel_map;       // channels of the hop sequence from beacon sequence + 1, 0 without hopping
+    uint32_t next_channel_map;  // channels of the hop sequence from beacon channel_switch on
+    uint32_t channel_switch;    // first beacon sent with the next channel map
+    uint32_t reply_time;        // time from the address of beacon sequence - 1 to the request answered, in ns
+    uint8_t  reply_node;        // node of the request answered, or SYNC_BEACON_NO_REPLY
+} sync_beacon_t;
+
+/**
+ * @brief Receiver statistics.
+ * The interval error compares the time between two consecutive beacons on both
+ * clocks: its mean is the crystal frequency offset over one period, its spread
+ * the reception jitter.
+ */
+typedef struct {
+    uint32_t received;          // valid beacons
+    uint32_t missed;            // beacons lost, from the gaps in the sequence numbers
+    uint32_t invalid;           // payloads with a CRC match but an unknown magic, version or schedule
+    uint32_t restarts;          // sequence numbers going backwards (transmitter reset)
+    uint32_t last_sequence;     // sequence number of the last beacon
+    uint32_t last_rx;           // reception time of the last beacon
+    uint32_t pair_rx;           // reception time of an earlier beacon ...
+    uint32_t pair_tx;           // ... and its transmission time
+    uint8_t  pair_prescaler;    // prescaler of pair_tx
+    bool     has_last;
+    bool     has_pair;
+    uint32_t intervals;         // number of interval errors below
+    int32_t  interval_min;      // smallest interval error in ns
+    int32_t  interval_max;      // largest interval error in ns
+    int64_t  interval_sum;      // sum of the interval errors in ns
+} sync_beacon_stats_t;
+
+/**
+ * @brief Function for writing a beacon in the radio buffer (SYNC_BEACON_LENGTH bytes).
+ */
+void sync_beacon_pack(uint8_t *buffer, const sync_beacon_t *beacon);
+
+/**
+ * @brief Function for copying a packed beacon to another radio buffer, as copy number copy of the burst.
+ */
+void sync_beacon_copy(uint8_t *buffer, const uint8_t *beacon, uint8_t copy);
+
+/**
+ * @brief Function for reading a beacon from the radio buffer.
+ * Returns false if the buffer does not hold a beacon of this version, or if a
+ * schedule it carries is not usable (width 0 or not shorter than the period).
+ */
+bool sync_beacon_parse(const uint8_t *buffer, sync_beacon_t *beacon);
+
+/**
+ * @brief Function for knowing if a beacon announces a schedule change for a later beacon.
+ */
+bool sync_beacon_pending(const sync_beacon_t *beacon);
+
+/**
+ * @brief Function for getting the schedule of beacon number sequence (not before the one given), as
+ * announced by a beacon.
+ */
+void sync_beacon_schedule(const sync_beacon_t *beacon, uint32_t sequence, uint32_t *period_us, uint32_t *width_us);
+
+/**
+ * @brief Function for getting the channel map of beacon number sequence (after the one given), as
+ * announced by a beacon.
+ */
+uint32_t sync_beacon_channel_map(const sync_beacon_t *beacon, uint32_t sequence);
+
+/**
+ * @brief Function for initializing the receiver statistics.
+ */
+void sync_beacon_stats_init(sync_beacon_stats_t *stats);
+
+/**
+ * @brief Function for adding a received beacon to the statistics.
+ * rx_timestamp is the reception time on the receiver TIMER running with rx_prescaler.
+ * Returns the number of beacons missed just before this one.
+ */
+uint32_t sync_beacon_stats_add(sync_beacon_stats_t *stats, const sync_beacon_t *beacon, uint32_t rx_timestamp, uint8_t rx_prescaler);
+
+/**
+ * @brief Function for getting the mean interval error in ns (0 without any interval).
+ */
+int32_t sync_beacon_stats_interval_mean(const sync_beacon_stats_t *stats);
+
+#endif // SYNC_BEACON_H
+
+/**
+ *@}
+ **/
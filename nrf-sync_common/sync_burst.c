@@ -0,0 +1,67 @@
+/** @file
+*
+* @defgroup nrf-sync_common_burst_impl sync_burst.c
+* @{
+* @ingroup nrf-sync_common
+* @brief Redundant beacon bursts implementation.
+*
+*/
+
+#include "sync_burst.h"
+
+/**
+ * @brief Function for multiplying two probabilities in parts per billion, rounded.
+ */
+static uint32_t mul(uint32_t a, uint32_t b) {
+    return (uint32_t)(((uint64_t)a * b + SYNC_BURST_PPB / 2) / SYNC_BURST_PPB);
+}
+
+uint32_t sync_burst_delay(uint32_t copies, uint32_t spacing, uint32_t margin, uint8_t copy) {
+    return (copies - 1 - copy) * spacing + margin;
+}
+
+void sync_burst_default_channel(sync_burst_channel_t *channel) {
+    channel->loss_good   = 5000000UL;
+    channel->loss_bad    = 600000000UL;
+    channel->good_to_bad = 20000000UL;
+    channel->bad_to_good = 250000000UL;
+}
+
+uint32_t sync_burst_loss(const sync_burst_channel_t *channel, uint32_t copies) {
+    uint32_t changes = channel->good_to_bad + channel->bad_to_good;
+    uint32_t good;              // probability of all the copies so far lost, and the channel good at the last one
+    uint32_t bad;               // same, the channel bad at the last one
+
+    if (copies == 0) {
+        return SYNC_BURST_PPB;
+    }
+
+    // steady state for the first copy
+    bad  = changes == 0 ? 0 : (uint32_t)((uint64_t)channel->good_to_bad * SYNC_BURST_PPB / changes);
+    good = SYNC_BURST_PPB - bad;
+
+    good = mul(good, channel->loss_good);
+    bad  = mul(bad,  channel->loss_bad);
+
+    for (uint32_t i = 1; i < copies; i++) {
+        uint32_t next_good = mul(good, SYNC_BURST_PPB - channel->good_to_bad) + mul(bad, channel->bad_to_good);
+        uint32_t next_bad  = mul(good, channel->good_to_bad) + mul(bad, SYNC_BURST_PPB - channel->bad_to_good);
+
+        good = mul(next_good, channel->loss_good);
+        bad  = mul(next_bad,  channel->loss_bad);
+    }
+
+    return good + bad;
+}
+
+void sync_burst_evaluate(const sync_burst_channel_t *channel, uint32_t copies, uint32_t spacing, uint32_t margin,
+                         uint32_t frame, sync_burst_report_t *report) {
+    report->copies  = copies;
+    report->delay   = sync_burst_delay(copies, spacing, margin, 0);
+    report->airtime = copies * frame;
+    report->loss    = sync_burst_loss(channel, copies);
+}
+
+/**
+ *@}
+ **/
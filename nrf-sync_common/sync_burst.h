@@ -0,0 +1,84 @@
+/** @file
+*
+* @defgroup nrf-sync_common_burst sync_burst.h
+* @{
+* @ingroup nrf-sync_common
+* @brief Redundant beacon bursts.
+*
+* The transmitter sends every beacon as a burst of copies, a fixed spacing
+* apart, each carrying its copy index. The receiver starts its pulse timer on
+* whichever copy arrives first and sets the rising edge after a delay that
+* depends on the copy index: copy i waits (copies - 1 - i) spacings less than
+* copy 0, so the edge falls at the same time for every copy. The last copy
+* still waits a margin, which bounds the latency of the interrupt writing the
+* delay. The transmitter delays its own edge by the same amount.
+*
+* Every extra copy adds one spacing to the delay of the pulse and one frame to
+* the airtime. What it buys depends on how the losses are spread: the loss
+* model is a two-state (Gilbert-Elliott) channel, good or bad, changing state
+* between two copies with fixed probabilities, so a burst of interference
+* longer than the spacing takes several copies at once. A beacon is lost when
+* all its copies are. The channel is assumed to be back to its steady state
+* from one period to the next.
+*
+* This module does not touch any peripheral so it can also be built on a host.
+*
+*/
+
+#ifndef SYNC_BURST_H
+#define SYNC_BURST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SYNC_BURST_MAX_COPIES        16     // the copy index and count share one byte of the beacon
+#define SYNC_BURST_PPB               1000000000UL   // probability 1 in parts per billion
+
+/**
+ * @brief Two-state loss model, probabilities in parts per billion.
+ */
+typedef struct {
+    uint32_t loss_good;         // loss of a copy in the good state
+    uint32_t loss_bad;          // loss of a copy in the bad state
+    uint32_t good_to_bad;       // from one copy to the next
+    uint32_t bad_to_good;       // from one copy to the next
+} sync_burst_channel_t;
+
+/**
+ * @brief Trade-off of one burst length.
+ */
+typedef struct {
+    uint32_t copies;
+    uint32_t delay;             // delay of the pulse, in the unit of the spacing
+    uint32_t airtime;           // airtime of the burst, in the unit of the frame time
+    uint32_t loss;              // probability of losing all the copies, in parts per billion
+} sync_burst_report_t;
+
+/**
+ * @brief Function for getting the delay from the reception of a copy to the rising edge.
+ * The delay of copy 0 is the one the transmitter adds to its offset.
+ */
+uint32_t sync_burst_delay(uint32_t copies, uint32_t spacing, uint32_t margin, uint8_t copy);
+
+/**
+ * @brief Function for loading a default channel: 0.5 % loss when good, 60 % when bad, turning bad on
+ * 2 % of the copies and staying bad for 4 copies on average (a Wi-Fi frame over a 0.5 ms spacing).
+ */
+void sync_burst_default_channel(sync_burst_channel_t *channel);
+
+/**
+ * @brief Function for getting the probability of losing all the copies of a burst, in parts per billion.
+ */
+uint32_t sync_burst_loss(const sync_burst_channel_t *channel, uint32_t copies);
+
+/**
+ * @brief Function for evaluating a burst length.
+ */
+void sync_burst_evaluate(const sync_burst_channel_t *channel, uint32_t copies, uint32_t spacing, uint32_t margin,
+                         uint32_t frame, sync_burst_report_t *report);
+
+#endif // SYNC_BURST_H
+
+/**
+ *@}
+ **/
@@ -0,0 +1,85 @@
+/** @file
+*
+* @defgroup nrf-sync_common_calib_impl sync_calib.c
+* @{
+* @ingroup nrf-sync_common
+* @brief Offset calibration implementation.
+*
+*/
+
+#include "sync_calib.h"
+
+/**
+ * @brief Function for dividing rounding to the nearest integer (halves away from zero).
+ */
+static int64_t div_round(int64_t sum, uint32_t count) {
+    return (sum >= 0) ? (sum + count / 2) / count : (sum - (int64_t)(count / 2)) / count;
+}
+
+void sync_calib_init(sync_calib_t *calib) {
+    calib->tx_end_sum   = 0;
+    calib->tx_samples   = 0;
+    calib->rx_delay_sum = 0;
+    calib->rx_samples   = 0;
+    calib->rejected     = 0;
+}
+
+bool sync_calib_add_tx(sync_calib_t *calib, uint32_t address, uint32_t end) {
+
+    if (address == 0 || end <= address) {
+        calib->rejected++;
+        return false;
+    }
+
+    calib->tx_end_sum += end;
+    calib->tx_samples++;
+
+    return true;
+}
+
+bool sync_calib_add_rx(sync_calib_t *calib, uint32_t end, uint32_t trigger) {
+
+    if (end == 0 || trigger == 0) {
+        calib->rejected++;
+        return false;
+    }
+
+    // difference of two counter values, still correct if the counter wrapped in between
+    calib->rx_delay_sum += (int32_t)(trigger - end);
+    calib->rx_samples++;
+
+    return true;
+}
+
+bool sync_calib_rx_trigger_delay(const sync_calib_t *calib, uint32_t min_samples, int32_t *delay) {
+
+    if (calib->rx_samples == 0 || calib->rx_samples < min_samples) {
+        return false;
+    }
+
+    *delay = (int32_t)div_round(calib->rx_delay_sum, calib->rx_samples);
+
+    return true;
+}
+
+bool sync_calib_offset(const sync_calib_t *calib, uint32_t min_samples, int32_t rx_chain_delay,
+                       int32_t rx_trigger_delay, uint32_t *offset) {
+
+    if (calib->tx_samples == 0 || calib->tx_samples < min_samples) {
+        return false;
+    }
+
+    int64_t result = div_round((int64_t)calib->tx_end_sum, calib->tx_samples) + rx_chain_delay + rx_trigger_delay;
+
+    if (result <= 0 || result > UINT32_MAX) {
+        return false;
+    }
+
+    *offset = (uint32_t)result;
+
+    return true;
+}
+
+/**
+ *@}
+ **/
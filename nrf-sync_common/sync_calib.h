@@ -0,0 +1,79 @@
+/** @file
+*
+* @defgroup nrf-sync_common_calib sync_calib.h
+* @{
+* @ingroup nrf-sync_common
+* @brief Offset calibration from radio event timestamps.
+*
+* The transmitter captures the time of its RADIO EVENTS_ADDRESS and EVENTS_END
+* relative to the radio start, the receiver captures the time between its own
+* EVENTS_END and the event that triggers its pulse. Averaging both gives the
+* offset the transmitter has to wait after the radio start so that both pulses
+* go high at the same time:
+*
+*     offset = tx END + rx chain delay + rx trigger delay
+*
+* where the rx chain delay is how much later the receiver sees the end of the
+* packet compared to the transmitter (fixed by the radio, see the product
+* specification).
+*
+* This module does not touch any peripheral so it can also be built on a host.
+*
+*/
+
+#ifndef SYNC_CALIB_H
+#define SYNC_CALIB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Calibration state, all values in timer ticks.
+ */
+typedef struct {
+    uint64_t tx_end_sum;        // sum of the accepted transmitter END captures
+    uint32_t tx_samples;        // number of accepted transmitter samples
+    int64_t  rx_delay_sum;      // sum of the accepted receiver END -> trigger delays
+    uint32_t rx_samples;        // number of accepted receiver samples
+    uint32_t rejected;          // number of samples with missing or inconsistent captures
+} sync_calib_t;
+
+/**
+ * @brief Function for clearing all the samples.
+ */
+void sync_calib_init(sync_calib_t *calib);
+
+/**
+ * @brief Function for adding one transmitter sample.
+ * Both captures are relative to the radio start. A capture of 0 means the event
+ * did not happen while the capture timer was running, so the sample is rejected,
+ * as well as any sample where the address is not seen before the end.
+ */
+bool sync_calib_add_tx(sync_calib_t *calib, uint32_t address, uint32_t end);
+
+/**
+ * @brief Function for adding one receiver sample.
+ * Both captures come from the same free-running timer, so the counter may have
+ * wrapped in between. A capture of 0 means the event did not happen (CRC error).
+ */
+bool sync_calib_add_rx(sync_calib_t *calib, uint32_t end, uint32_t trigger);
+
+/**
+ * @brief Function for getting the averaged receiver END -> trigger delay.
+ * Returns false until at least min_samples receiver samples were accepted.
+ */
+bool sync_calib_rx_trigger_delay(const sync_calib_t *calib, uint32_t min_samples, int32_t *delay);
+
+/**
+ * @brief Function for computing the calibrated offset.
+ * Returns false until at least min_samples transmitter samples were accepted, or
+ * if the resulting offset would not be positive.
+ */
+bool sync_calib_offset(const sync_calib_t *calib, uint32_t min_samples, int32_t rx_chain_delay,
+                       int32_t rx_trigger_delay, uint32_t *offset);
+
+#endif // SYNC_CALIB_H
+
+/**
+ *@}
+ **/
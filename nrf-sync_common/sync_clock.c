@@ -0,0 +1,67 @@
+/** @file
+*
+* @defgroup nrf-sync_common_clock_impl sync_clock.c
+* @{
+* @ingroup nrf-sync_common
+* @brief Disciplined clock synthesizer implementation.
+*
+*/
+
+#include "sync_clock.h"
+#include "sync_pwm.h"
+
+void sync_clock_init(sync_clock_t *clock, uint32_t cycles, uint32_t period) {
+    clock->cycles     = cycles;
+    clock->period     = period;
+    clock->index      = 0;
+    clock->generated  = 0;
+    clock->base_index = 0;
+    clock->base       = 0;
+}
+
+void sync_clock_period(sync_clock_t *clock, uint32_t period) {
+    clock->period     = period;
+    clock->base_index = clock->index;
+    clock->base       = clock->generated;
+}
+
+uint32_t sync_clock_next(sync_clock_t *clock) {
+    uint32_t remaining = clock->cycles - clock->base_index;
+    uint32_t end       = clock->base;
+    uint32_t length;
+
+    // cycle ends evenly spaced from the last period update to the end of the grid period
+    if (clock->period > clock->base) {
+        end += (uint32_t)(((uint64_t)(clock->index + 1 - clock->base_index) * (clock->period - clock->base) +
+                           remaining / 2) / remaining);
+    }
+
+    if (end < clock->generated + SYNC_CLOCK_MIN_LENGTH) {
+        end = clock->generated + SYNC_CLOCK_MIN_LENGTH;
+    }
+    length = end - clock->generated;
+
+    clock->index++;
+    if (clock->index == clock->cycles) {
+        // next grid period
+        clock->index      = 0;
+        clock->generated  = 0;
+        clock->base_index = 0;
+        clock->base       = 0;
+    } else {
+        clock->generated = end;
+    }
+
+    return length;
+}
+
+void sync_clock_wave(uint16_t *value, uint32_t length) {
+    value[0] = (uint16_t)(length / 2) | SYNC_PWM_FALLING_EDGE;     // high first, low from the compare
+    value[1] = 0;
+    value[2] = 0;
+    value[3] = (uint16_t)length;                                    // countertop
+}
+
+/**
+ *@}
+ **/
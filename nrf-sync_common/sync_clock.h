@@ -0,0 +1,72 @@
+/** @file
+*
+* @defgroup nrf-sync_common_clock sync_clock.h
+* @{
+* @ingroup nrf-sync_common
+* @brief Disciplined clock synthesizer.
+*
+* Splits every period of a disciplined grid (the servo pulses) into a fixed
+* number of clock cycles, so a beacon period drives a much faster clock that
+* stays phase-locked to it. Cycle lengths are whole ticks, cycle i of a period
+* ends at round((i + 1) * period / cycles), so two cycles differ by one tick
+* at most and the last one ends exactly on the next grid point, whatever the
+* frequency offset corrected by the grid.
+*
+* The period can be updated while it is being generated: the difference is
+* spread over the cycles still to come, which is how the grid corrections
+* reach the clock.
+*
+* Every cycle is played by the PWM in wave form mode, high for its first
+* half: the rising edge of the first cycle of a period falls on the grid point.
+*
+* This module does not touch any peripheral so it can also be built on a host.
+*
+*/
+
+#ifndef SYNC_CLOCK_H
+#define SYNC_CLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SYNC_CLOCK_MIN_LENGTH    3      // shortest cycle in ticks, if the period shrinks below what was generated
+#define SYNC_CLOCK_WAVE_VALUES   4      // PWM values of one cycle in wave form mode
+
+/**
+ * @brief Synthesizer state.
+ */
+typedef struct {
+    uint32_t cycles;        // clock cycles per grid period
+    uint32_t period;        // length of the grid period being generated, in ticks
+    uint32_t index;         // cycles generated in this grid period
+    uint32_t generated;     // ticks generated in this grid period
+    uint32_t base_index;    // cycles generated when the period was last set
+    uint32_t base;          // ticks generated when the period was last set
+} sync_clock_t;
+
+/**
+ * @brief Function for initializing the synthesizer at the start of a grid period.
+ */
+void sync_clock_init(sync_clock_t *clock, uint32_t cycles, uint32_t period);
+
+/**
+ * @brief Function for setting the length of the grid period being generated, and of the next ones.
+ */
+void sync_clock_period(sync_clock_t *clock, uint32_t period);
+
+/**
+ * @brief Function for getting the length in ticks of the next cycle.
+ */
+uint32_t sync_clock_next(sync_clock_t *clock);
+
+/**
+ * @brief Function for writing the SYNC_CLOCK_WAVE_VALUES PWM values of a cycle of length ticks, in wave form
+ * mode (compare of channel 0, then countertop): high for the first half of the cycle, then low.
+ */
+void sync_clock_wave(uint16_t *value, uint32_t length);
+
+#endif // SYNC_CLOCK_H
+
+/**
+ *@}
+ **/
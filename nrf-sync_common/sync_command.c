@@ -0,0 +1,128 @@
+/** @file
+*
+* @defgroup nrf-sync_common_command_impl sync_command.c
+* @{
+* @ingroup nrf-sync_common
+* @brief Binary command protocol implementation.
+*
+*/
+
+#include "sync_command.h"
+
+/**
+ * @brief Function for computing the CRC-8 of a frame, without its last byte.
+ */
+static uint8_t crc8(const uint8_t *buffer) {
+    uint8_t crc = 0;
+
+    for (uint8_t i = 0; i < SYNC_COMMAND_LENGTH - 1; i++) {
+        crc ^= buffer[i];
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+void sync_command_parser_init(sync_command_parser_t *parser) {
+    parser->length = 0;
+}
+
+sync_command_parse_t sync_command_parse(sync_command_parser_t *parser, uint8_t byte, sync_command_t *command) {
+    uint8_t *buffer = parser->buffer;
+    uint8_t  next;
+
+    if (parser->length == 0 && byte != SYNC_COMMAND_SYNC) {
+        return SYNC_COMMAND_PARSE_NONE;
+    }
+
+    buffer[parser->length++] = byte;
+    if (parser->length < SYNC_COMMAND_LENGTH) {
+        return SYNC_COMMAND_PARSE_NONE;
+    }
+
+    command->id    = buffer[1];
+    command->value =  (uint32_t)buffer[3]        |
+                     ((uint32_t)buffer[4] << 8)  |
+                     ((uint32_t)buffer[5] << 16) |
+                     ((uint32_t)buffer[6] << 24);
+
+    if (crc8(buffer) == buffer[SYNC_COMMAND_LENGTH - 1]) {
+        command->status = buffer[2];
+        parser->length  = 0;
+        return SYNC_COMMAND_PARSE_FRAME;
+    }
+
+    // the sync byte may have been noise, restart from the next one in the buffer
+    command->status = SYNC_COMMAND_CHECKSUM;
+    for (next = 1; next < SYNC_COMMAND_LENGTH && buffer[next] != SYNC_COMMAND_SYNC; next++) {
+    }
+    parser->length = SYNC_COMMAND_LENGTH - next;
+    for (uint8_t i = 0; i < parser->length; i++) {
+        buffer[i] = buffer[next + i];
+    }
+
+    return SYNC_COMMAND_PARSE_ERROR;
+}
+
+void sync_command_pack(uint8_t *buffer, const sync_command_t *command) {
+    buffer[0] = SYNC_COMMAND_SYNC;
+    buffer[1] = command->id;
+    buffer[2] = command->status;
+    buffer[3] = (uint8_t)(command->value);
+    buffer[4] = (uint8_t)(command->value >> 8);
+    buffer[5] = (uint8_t)(command->value >> 16);
+    buffer[6] = (uint8_t)(command->value >> 24);
+    buffer[7] = crc8(buffer);
+}
+
+uint8_t sync_command_apply(sync_command_config_t *config, sync_command_t *command, uint32_t margin, uint32_t max) {
+    sync_command_config_t next = *config;
+
+    switch (command->id) {
+        case SYNC_COMMAND_PERIOD:
+            next.period = command->value;
+            break;
+        case SYNC_COMMAND_WIDTH:
+            next.width  = command->value;
+            break;
+        case SYNC_COMMAND_OFFSET:
+            next.offset = command->value;
+            break;
+        case SYNC_COMMAND_CHANNELS:
+            next.channels = command->value;
+            break;
+        case SYNC_COMMAND_READ:
+            switch (command->value) {
+                case SYNC_COMMAND_PERIOD:
+                    command->value = config->period;
+                    return SYNC_COMMAND_OK;
+                case SYNC_COMMAND_WIDTH:
+                    command->value = config->width;
+                    return SYNC_COMMAND_OK;
+                case SYNC_COMMAND_OFFSET:
+                    command->value = config->offset;
+                    return SYNC_COMMAND_OK;
+                case SYNC_COMMAND_CHANNELS:
+                    command->value = config->channels;
+                    return SYNC_COMMAND_OK;
+                default:
+                    return SYNC_COMMAND_UNKNOWN;
+            }
+        default:
+            return SYNC_COMMAND_UNKNOWN;
+    }
+
+    if (next.width == 0 || next.period > max || next.offset < margin || next.offset >= next.period ||
+        (uint64_t)next.width + margin >= next.period) {
+        return SYNC_COMMAND_RANGE;
+    }
+
+    *config = next;
+    return SYNC_COMMAND_OK;
+}
+
+/**
+ *@}
+ **/
@@ -0,0 +1,115 @@
+/** @file
+*
+* @defgroup nrf-sync_common_command sync_command.h
+* @{
+* @ingroup nrf-sync_common
+* @brief Binary command protocol for runtime reconfiguration.
+*
+* Commands and their acknowledgements are fixed-length frames, all fields
+* little endian, byte by byte:
+*
+*     offset  size  field
+*     0       1     SYNC_COMMAND_SYNC
+*     1       1     command id, with SYNC_COMMAND_ACK set in acknowledgements
+*     2       1     status (SYNC_COMMAND_OK in commands)
+*     3       4     value: new value, or the parameter id for SYNC_COMMAND_READ
+*     7       1     CRC-8 (polynomial 0x07, initial value 0) of bytes 0 to 6
+*
+* Every command is acknowledged with the same id and the value in use, or
+* with an error status. A frame with a bad CRC is acknowledged with
+* SYNC_COMMAND_CHECKSUM and the parser resynchronizes on the next sync byte.
+*
+* This module does not touch any peripheral so it can also be built on a host.
+*
+*/
+
+#ifndef SYNC_COMMAND_H
+#define SYNC_COMMAND_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SYNC_COMMAND_SYNC            0x5A   // first byte of every frame
+#define SYNC_COMMAND_LENGTH          8      // frame length in bytes
+#define SYNC_COMMAND_ACK             0x80   // id flag of the acknowledgements
+
+// command ids
+#define SYNC_COMMAND_PERIOD          0x01   // period in us
+#define SYNC_COMMAND_WIDTH           0x02   // pulse width in us
+#define SYNC_COMMAND_OFFSET          0x03   // offset between the radio start and the rising edge in us
+#define SYNC_COMMAND_READ            0x04   // read the parameter whose id is the value, nothing is changed
+#define SYNC_COMMAND_CHANNELS        0x05   // channel map of the hop sequence (see sync_hop.h)
+#define SYNC_COMMAND_LOSS            0x06   // loss reported by a receiver: hop table index << 16 | loss in per mille,
+                                            // not a parameter of the schedule, left to the caller (see sync_scan.h)
+
+// status
+#define SYNC_COMMAND_OK              0
+#define SYNC_COMMAND_UNKNOWN         1      // unknown command or parameter id
+#define SYNC_COMMAND_RANGE           2      // the schedule would not be usable with this value
+#define SYNC_COMMAND_BUSY            3      // the previous change is not applied yet
+#define SYNC_COMMAND_CHECKSUM        4      // bad CRC, the id may be wrong too
+
+/**
+ * @brief Command or acknowledgement fields.
+ */
+typedef struct {
+    uint8_t  id;
+    uint8_t  status;
+    uint32_t value;
+} sync_command_t;
+
+/**
+ * @brief Parser state, fed one byte at a time.
+ */
+typedef struct {
+    uint8_t buffer[SYNC_COMMAND_LENGTH];
+    uint8_t length;             // bytes received of the current frame
+} sync_command_parser_t;
+
+typedef enum {
+    SYNC_COMMAND_PARSE_NONE,    // no complete frame yet
+    SYNC_COMMAND_PARSE_FRAME,   // a valid frame was received
+    SYNC_COMMAND_PARSE_ERROR    // a frame with a bad CRC was received
+} sync_command_parse_t;
+
+/**
+ * @brief Runtime schedule, all times in us.
+ */
+typedef struct {
+    uint32_t period;
+    uint32_t width;
+    uint32_t offset;
+    uint32_t channels;          // channel map, only checked by the caller
+} sync_command_config_t;
+
+/**
+ * @brief Function for initializing the parser.
+ */
+void sync_command_parser_init(sync_command_parser_t *parser);
+
+/**
+ * @brief Function for feeding a received byte.
+ * The command is written on SYNC_COMMAND_PARSE_FRAME, and also on SYNC_COMMAND_PARSE_ERROR
+ * with the id as received and status SYNC_COMMAND_CHECKSUM, so it can be acknowledged.
+ */
+sync_command_parse_t sync_command_parse(sync_command_parser_t *parser, uint8_t byte, sync_command_t *command);
+
+/**
+ * @brief Function for writing a frame (SYNC_COMMAND_LENGTH bytes).
+ */
+void sync_command_pack(uint8_t *buffer, const sync_command_t *command);
+
+/**
+ * @brief Function for applying a command to a schedule.
+ * The schedule is only changed if the command is accepted: the width must be at least margin
+ * shorter than the period, the offset at least margin and shorter than the period, and no value
+ * above max. For SYNC_COMMAND_READ, the value of the command is replaced by the one of the parameter.
+ * Returns the status to acknowledge the command with.
+ */
+uint8_t sync_command_apply(sync_command_config_t *config, sync_command_t *command, uint32_t margin, uint32_t max);
+
+#endif // SYNC_COMMAND_H
+
+/**
+ *@}
+ **/
@@ -0,0 +1,94 @@
+/** @file
+*
+* @defgroup nrf-sync_common_energy_impl sync_energy.c
+* @{
+* @ingroup nrf-sync_common
+* @brief Energy model implementation.
+*
+*/
+
+#include "sync_energy.h"
+
+/**
+ * @brief Function for appending a step, steps of 0 us are skipped.
+ */
+static void add_step(sync_energy_timeline_t *timeline, sync_energy_state_t state, uint32_t duration_us) {
+    if (duration_us > 0 && timeline->count < SYNC_ENERGY_MAX_STEPS) {
+        timeline->steps[timeline->count].state       = state;
+        timeline->steps[timeline->count].duration_us = duration_us;
+        timeline->count++;
+    }
+}
+
+/**
+ * @brief Function for the time from the end of the frame to the end of the pulse.
+ */
+static uint32_t after_frame(const sync_energy_timing_t *timing) {
+    uint32_t end = timing->offset + timing->width;
+
+    return (end > timing->airtime) ? end - timing->airtime : 0;
+}
+
+void sync_energy_default_model(sync_energy_model_t *model) {
+    model->current_na[SYNC_ENERGY_SLEEP]      = 3000;
+    model->current_na[SYNC_ENERGY_HFXO]       = 250000;
+    model->current_na[SYNC_ENERGY_TIMER]      = 500000;
+    model->current_na[SYNC_ENERGY_RAMPUP]     = 5000000;
+    model->current_na[SYNC_ENERGY_RADIO_IDLE] = 1500000;
+    model->current_na[SYNC_ENERGY_TX]         = 6400000;
+    model->voltage_mv                         = 3000;
+}
+
+void sync_energy_continuous_timeline(const sync_energy_timing_t *timing, sync_energy_timeline_t *timeline) {
+
+    timeline->count     = 0;
+    timeline->period_us = timing->period;
+
+    // the radio goes back to TXIDLE after every packet and the timers never stop
+    add_step(timeline, SYNC_ENERGY_TX, timing->airtime);
+    add_step(timeline, SYNC_ENERGY_RADIO_IDLE, (timing->period > timing->airtime) ? (uint32_t)(timing->period - timing->airtime) : 0);
+}
+
+void sync_energy_duty_cycled_timeline(const sync_energy_timing_t *timing, sync_energy_timeline_t *timeline) {
+    uint32_t waiting = timing->wake_lead;
+
+    timeline->count     = 0;
+    timeline->period_us = timing->period;
+
+    // HFCLK start, radio ramp-up, then TXIDLE until the radio start at the end of the lead
+    add_step(timeline, SYNC_ENERGY_HFXO, timing->hfxo_startup);
+    add_step(timeline, SYNC_ENERGY_RAMPUP, timing->rampup);
+    waiting = (waiting > timing->hfxo_startup + timing->rampup) ? waiting - timing->hfxo_startup - timing->rampup : 0;
+    add_step(timeline, SYNC_ENERGY_RADIO_IDLE, waiting);
+
+    // radio disabled at the end of the frame, HFCLK stopped at the end of the pulse
+    add_step(timeline, SYNC_ENERGY_TX, timing->airtime);
+    add_step(timeline, SYNC_ENERGY_TIMER, after_frame(timing));
+}
+
+bool sync_energy_evaluate(const sync_energy_model_t *model, const sync_energy_timeline_t *timeline,
+                          sync_energy_report_t *report) {
+    uint64_t busy_us   = 0;
+    uint64_t charge_fc = 0;    // femtocoulombs (nA x us)
+
+    for (uint32_t i = 0; i < timeline->count; i++) {
+        busy_us   += timeline->steps[i].duration_us;
+        charge_fc += (uint64_t)model->current_na[timeline->steps[i].state] * timeline->steps[i].duration_us;
+    }
+
+    if (timeline->period_us == 0 || busy_us > timeline->period_us) {
+        return false;
+    }
+
+    charge_fc += (uint64_t)model->current_na[SYNC_ENERGY_SLEEP] * (timeline->period_us - busy_us);
+
+    report->charge_nc  = (charge_fc + 500000) / 1000000;
+    report->energy_nj  = (report->charge_nc * model->voltage_mv + 500) / 1000;
+    report->average_na = (uint32_t)(charge_fc / timeline->period_us);
+
+    return true;
+}
+
+/**
+ *@}
+ **/
@@ -0,0 +1,117 @@
+/** @file
+*
+* @defgroup nrf-sync_common_energy sync_energy.h
+* @{
+* @ingroup nrf-sync_common
+* @brief Energy model of one transmitter period.
+*
+* One period is described as a timeline of steps, each spending some time in
+* a power state. The time left until the end of the period is spent asleep.
+* The charge drawn over the period is the sum of current x time of all the
+* steps, from which the average current and the energy at the supply voltage
+* follow.
+*
+* The default currents are rough nRF52840 figures (LDO regulator, 3 V, 0 dBm)
+* meant to compare the modes with each other, not to replace a measurement
+* with a power profiler.
+*
+* This module does not touch any peripheral so it can also be built on a host.
+*
+*/
+
+#ifndef SYNC_ENERGY_H
+#define SYNC_ENERGY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SYNC_ENERGY_MAX_STEPS        8      // longest timeline
+
+/**
+ * @brief Power states of the transmitter.
+ */
+typedef enum {
+    SYNC_ENERGY_SLEEP,          // System ON idle, LFCLK and RTC running, HFCLK off
+    SYNC_ENERGY_HFXO,           // HFXO running (or starting), CPU asleep
+    SYNC_ENERGY_TIMER,          // HFXO and a TIMER running
+    SYNC_ENERGY_RAMPUP,         // radio ramping up
+    SYNC_ENERGY_RADIO_IDLE,     // radio in TXIDLE, HFXO and TIMER running
+    SYNC_ENERGY_TX,             // radio transmitting
+    SYNC_ENERGY_STATES
+} sync_energy_state_t;
+
+/**
+ * @brief Current drawn in every state, and supply voltage.
+ */
+typedef struct {
+    uint32_t current_na[SYNC_ENERGY_STATES];
+    uint32_t voltage_mv;
+} sync_energy_model_t;
+
+/**
+ * @brief One step of the timeline.
+ */
+typedef struct {
+    sync_energy_state_t state;
+    uint32_t            duration_us;
+} sync_energy_step_t;
+
+/**
+ * @brief Timeline of one period.
+ */
+typedef struct {
+    sync_energy_step_t steps[SYNC_ENERGY_MAX_STEPS];
+    uint32_t           count;
+    uint64_t           period_us;
+} sync_energy_timeline_t;
+
+/**
+ * @brief Timing of one transmitter period, in us.
+ */
+typedef struct {
+    uint64_t period;            // beacon period
+    uint32_t wake_lead;         // HFCLK start to radio start (duty cycled only)
+    uint32_t hfxo_startup;      // HFCLK start to HFCLKSTARTED (duty cycled only)
+    uint32_t rampup;            // TXEN to READY
+    uint32_t airtime;           // radio start to the end of the frame
+    uint32_t offset;            // radio start to the rising edge of the pulse
+    uint32_t width;             // pulse width
+} sync_energy_timing_t;
+
+/**
+ * @brief Energy of one period.
+ */
+typedef struct {
+    uint64_t charge_nc;         // charge drawn in nC
+    uint64_t energy_nj;         // energy in nJ at the model voltage
+    uint32_t average_na;        // average current in nA
+} sync_energy_report_t;
+
+/**
+ * @brief Function for loading the default nRF52840 currents.
+ */
+void sync_energy_default_model(sync_energy_model_t *model);
+
+/**
+ * @brief Function for building the timeline of the default transmitter: HFCLK, radio and timers always on.
+ */
+void sync_energy_continuous_timeline(const sync_energy_timing_t *timing, sync_energy_timeline_t *timeline);
+
+/**
+ * @brief Function for building the timeline of the duty-cycled transmitter: HFCLK started
+ * wake_lead before the radio, and everything stopped at the end of the pulse.
+ */
+void sync_energy_duty_cycled_timeline(const sync_energy_timing_t *timing, sync_energy_timeline_t *timeline);
+
+/**
+ * @brief Function for computing the energy of one period.
+ * Returns false if the steps do not fit in the period.
+ */
+bool sync_energy_evaluate(const sync_energy_model_t *model, const sync_energy_timeline_t *timeline,
+                          sync_energy_report_t *report);
+
+#endif // SYNC_ENERGY_H
+
+/**
+ *@}
+ **/
@@ -0,0 +1,95 @@
+/** @file
+*
+* @defgroup nrf-sync_common_holdover_impl sync_holdover.c
+* @{
+* @ingroup nrf-sync_common
+* @brief Receiver holdover implementation.
+*
+*/
+
+#include "sync_holdover.h"
+
+#define ONE     (1ULL << SYNC_HOLDOVER_FRAC_BITS)
+#define HALF    (ONE >> 1)
+
+/**
+ * @brief Function for getting the time of n periods after the last beacon.
+ */
+static uint32_t predict(const sync_holdover_t *holdover, uint32_t n) {
+    return holdover->last_beacon + (uint32_t)((holdover->period * n + HALF) >> SYNC_HOLDOVER_FRAC_BITS);
+}
+
+void sync_holdover_init(sync_holdover_t *holdover, uint32_t nominal_period, uint32_t tolerance, uint32_t max_periods) {
+    holdover->period      = (uint64_t)nominal_period << SYNC_HOLDOVER_FRAC_BITS;
+    holdover->last_beacon = 0;
+    holdover->tolerance   = tolerance;
+    holdover->max_periods = max_periods;
+    holdover->beacons     = 0;
+    holdover->holdover    = 0;
+}
+
+void sync_holdover_beacon(sync_holdover_t *holdover, uint32_t timestamp, sync_holdover_report_t *report) {
+
+    report->missed      = 0;
+    report->phase_error = 0;
+    report->on_schedule = false;
+
+    if (holdover->beacons > 0) {
+        uint32_t elapsed = timestamp - holdover->last_beacon;
+
+        // number of periods since the last beacon, rounded
+        uint32_t n = (uint32_t)((((uint64_t)elapsed << SYNC_HOLDOVER_FRAC_BITS) + (holdover->period >> 1)) / holdover->period);
+
+        if (n >= 1) {
+            int32_t error = (int32_t)(timestamp - predict(holdover, n));
+
+            report->missed      = n - 1;
+            report->phase_error = error;
+
+            // the first interval is only predicted with the nominal period, so it is always
+            // accepted and gives the first period measurement
+            if (holdover->beacons == 1 || (uint32_t)(error < 0 ? -error : error) <= holdover->tolerance) {
+                report->on_schedule = true;
+
+                // elapsed / n is the period measured over this interval, filter it in
+                uint64_t measured = ((uint64_t)elapsed << SYNC_HOLDOVER_FRAC_BITS) / n;
+                if (holdover->beacons == 1) {
+                    holdover->period = measured;
+                } else if (measured >= holdover->period) {
+                    holdover->period += (measured - holdover->period) >> SYNC_HOLDOVER_PERIOD_SHIFT;
+                } else {
+                    holdover->period -= (holdover->period - measured) >> SYNC_HOLDOVER_PERIOD_SHIFT;
+                }
+            }
+        }
+    }
+
+    // a beacon off schedule restarts the acquisition from its own timestamp (the period is kept)
+    holdover->beacons     = report->on_schedule ? holdover->beacons + 1 : 1;
+    holdover->last_beacon = timestamp;
+    holdover->holdover    = 0;
+}
+
+bool sync_holdover_next(const sync_holdover_t *holdover, uint32_t *timestamp) {
+
+    if (holdover->beacons < SYNC_HOLDOVER_LOCK_BEACONS || holdover->holdover >= holdover->max_periods) {
+        return false;
+    }
+
+    // guard the prediction so that a beacon late by up to the tolerance still comes first
+    *timestamp = predict(holdover, holdover->holdover + 1) + holdover->tolerance + 1;
+
+    return true;
+}
+
+void sync_holdover_generated(sync_holdover_t *holdover) {
+    holdover->holdover++;
+}
+
+uint32_t sync_holdover_period(const sync_holdover_t *holdover) {
+    return (uint32_t)((holdover->period + HALF) >> SYNC_HOLDOVER_FRAC_BITS);
+}
+
+/**
+ *@}
+ **/
@@ -0,0 +1,90 @@
+/** @file
+*
+* @defgroup nrf-sync_common_holdover sync_holdover.h
+* @{
+* @ingroup nrf-sync_common
+* @brief Receiver holdover: pulse prediction when beacons are lost.
+*
+* Every beacon is timestamped on a free-running TIMER. From consecutive
+* timestamps the receiver learns the beacon period in its own ticks (so the
+* crystal difference with the transmitter is already included), and predicts
+* when the next beacon should arrive. If it does not, a pulse is generated
+* just after the latest time a beacon on schedule could arrive (the prediction
+* plus the tolerance), so that a late beacon still wins; the next beacon that arrives snaps the schedule
+* back to the transmitter and reports how long the holdover lasted and how far
+* the prediction was.
+*
+* All times are 32-bit timer values, differences are taken modulo 2^32 so the
+* counter may wrap as long as the period is shorter than the wrap time.
+*
+* This module does not touch any peripheral so it can also be built on a host.
+*
+*/
+
+#ifndef SYNC_HOLDOVER_H
+#define SYNC_HOLDOVER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SYNC_HOLDOVER_FRAC_BITS      8      // fractional bits of the learned period
+#define SYNC_HOLDOVER_PERIOD_SHIFT   3      // period filter gain is 1 / 2^SHIFT
+#define SYNC_HOLDOVER_LOCK_BEACONS   2      // beacons on schedule needed before holdover is allowed
+
+/**
+ * @brief Holdover state.
+ */
+typedef struct {
+    uint64_t period;            // learned period in 1 / 2^SYNC_HOLDOVER_FRAC_BITS ticks
+    uint32_t last_beacon;       // timestamp of the last beacon
+    uint32_t tolerance;         // max phase error (ticks) for a beacon to be on schedule
+    uint32_t max_periods;       // longest holdover, in periods
+    uint32_t beacons;           // consecutive beacons on schedule, 0 until the first beacon
+    uint32_t holdover;          // pulses generated since the last beacon
+} sync_holdover_t;
+
+/**
+ * @brief What happened when a beacon was received.
+ */
+typedef struct {
+    uint32_t missed;            // beacons missed just before this one (holdover duration in periods)
+    int32_t  phase_error;       // beacon timestamp minus predicted timestamp, in ticks
+    bool     on_schedule;       // false if the beacon was too far from the prediction (schedule reset)
+} sync_holdover_report_t;
+
+/**
+ * @brief Function for initializing the holdover.
+ * nominal_period is used until a period has been measured, and to count the
+ * periods between two beacons.
+ */
+void sync_holdover_init(sync_holdover_t *holdover, uint32_t nominal_period, uint32_t tolerance, uint32_t max_periods);
+
+/**
+ * @brief Function for feeding the timestamp of a received beacon.
+ */
+void sync_holdover_beacon(sync_holdover_t *holdover, uint32_t timestamp, sync_holdover_report_t *report);
+
+/**
+ * @brief Function for getting the timestamp of the next holdover pulse.
+ * The timestamp is the prediction plus the tolerance plus one tick: every beacon on schedule comes
+ * strictly before it, and a holdover pulse is that much later than the prediction.
+ * Returns false if no holdover pulse should be generated: not locked yet, or
+ * the holdover already lasted max_periods.
+ */
+bool sync_holdover_next(const sync_holdover_t *holdover, uint32_t *timestamp);
+
+/**
+ * @brief Function for telling that the pulse returned by sync_holdover_next() was generated.
+ */
+void sync_holdover_generated(sync_holdover_t *holdover);
+
+/**
+ * @brief Function for getting the learned period in ticks (rounded).
+ */
+uint32_t sync_holdover_period(const sync_holdover_t *holdover);
+
+#endif // SYNC_HOLDOVER_H
+
+/**
+ *@}
+ **/
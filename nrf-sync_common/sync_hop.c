@@ -0,0 +1,187 @@
+/** @file
+*
+* @defgroup nrf-sync_common_hop_impl sync_hop.c
+* @{
+* @ingroup nrf-sync_common
+* @brief Beacon frequency hopping implementation.
+*
+*/
+
+#include "sync_hop.h"
+
+/**
+ * @brief Function for mixing the bits of a 32-bit value (bijective, every input bit affects every output bit).
+ */
+static uint32_t mix(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7FEB352DUL;
+    x ^= x >> 15;
+    x *= 0x846CA68BUL;
+    x ^= x >> 16;
+    return x;
+}
+
+/**
+ * @brief Function for getting the table index of the n-th channel of a map (n below its count).
+ */
+static uint8_t nth(uint32_t map, uint8_t n) {
+    uint8_t index = 0;
+
+    for (; index < SYNC_HOP_MAX_CHANNELS; index++) {
+        if (map & (1UL << index)) {
+            if (n == 0) {
+                break;
+            }
+            n--;
+        }
+    }
+
+    return index;
+}
+
+uint8_t sync_hop_count(uint32_t map) {
+    uint8_t count = 0;
+
+    for (; map != 0; map &= map - 1) {
+        count++;
+    }
+
+    return count;
+}
+
+uint8_t sync_hop_index(uint32_t seed, uint32_t map, uint32_t sequence) {
+    uint32_t hash = mix(sequence ^ mix(seed));
+
+    if (map == 0) {
+        return SYNC_HOP_FIXED;
+    }
+
+    // multiply and shift instead of a modulo: same spread, no division
+    return nth(map, (uint8_t)(((uint64_t)hash * sync_hop_count(map)) >> 32));
+}
+
+uint8_t sync_hop_first(uint32_t map) {
+    return map == 0 ? SYNC_HOP_FIXED : nth(map, 0);
+}
+
+uint8_t sync_hop_following(uint32_t map, uint8_t index) {
+
+    for (uint8_t i = 1; i <= SYNC_HOP_MAX_CHANNELS; i++) {
+        uint8_t next = (uint8_t)((index + i) % SYNC_HOP_MAX_CHANNELS);
+
+        if (map & (1UL << next)) {
+            return next;
+        }
+    }
+
+    return SYNC_HOP_FIXED;
+}
+
+void sync_hop_rx_init(sync_hop_rx_t *rx, uint32_t seed, uint32_t map, uint32_t table, uint32_t max_misses, uint32_t dwell) {
+    rx->seed            = seed;
+    rx->map             = map;
+    rx->next_map        = map;
+    rx->switch_sequence = 0;
+    rx->table           = table;
+    rx->max_misses      = max_misses;
+    rx->dwell           = dwell;
+    rx->expected        = 0;
+    rx->misses          = 0;
+    rx->search          = sync_hop_first(map);
+    rx->synced          = false;
+}
+
+uint32_t sync_hop_rx_map(const sync_hop_rx_t *rx, uint32_t sequence) {
+    return (int32_t)(sequence - rx->switch_sequence) >= 0 ? rx->next_map : rx->map;
+}
+
+uint8_t sync_hop_rx_beacon(sync_hop_rx_t *rx, uint32_t sequence, uint32_t map, uint32_t next_map, uint32_t switch_sequence) {
+    rx->expected        = sequence + 1;
+    rx->map             = map;
+    rx->next_map        = next_map;
+    rx->switch_sequence = switch_sequence;
+    rx->misses          = 0;
+    rx->synced          = true;
+
+    return sync_hop_index(rx->seed, sync_hop_rx_map(rx, rx->expected), rx->expected);
+}
+
+uint8_t sync_hop_rx_missed(sync_hop_rx_t *rx) {
+
+    if (rx->synced) {
+        rx->expected++;
+        rx->misses++;
+        if (rx->misses < rx->max_misses) {
+            return sync_hop_index(rx->seed, sync_hop_rx_map(rx, rx->expected), rx->expected);
+        }
+        rx->synced = false;
+        rx->misses = 0;
+        rx->search = sync_hop_first(sync_hop_rx_map(rx, rx->expected));
+        return rx->search;
+    }
+
+    rx->misses++;
+    if (rx->dwell != 0 && rx->misses >= rx->dwell) {
+        rx->misses = 0;
+        rx->search = sync_hop_following(rx->table, rx->search);
+    }
+
+    return rx->search;
+}
+
+void sync_hop_stats_init(sync_hop_stats_t *stats) {
+    for (uint8_t i = 0; i < SYNC_HOP_MAX_CHANNELS; i++) {
+        stats->received[i] = 0;
+        stats->missed[i]   = 0;
+    }
+}
+
+void sync_hop_stats_add(sync_hop_stats_t *stats, uint8_t index, bool received) {
+
+    if (index >= SYNC_HOP_MAX_CHANNELS) {
+        return;
+    }
+
+    if (received) {
+        stats->received[index]++;
+    } else {
+        stats->missed[index]++;
+    }
+}
+
+uint32_t sync_hop_stats_loss(const sync_hop_stats_t *stats, uint8_t index) {
+    uint32_t beacons = stats->received[index] + stats->missed[index];
+
+    if (beacons == 0) {
+        return 0;
+    }
+    return (uint32_t)((uint64_t)stats->missed[index] * 1000 / beacons);
+}
+
+uint32_t sync_hop_blacklist(const sync_hop_stats_t *stats, uint32_t map, uint32_t min_beacons, uint32_t max_loss) {
+
+    while (sync_hop_count(map) > SYNC_HOP_MIN_CHANNELS) {
+        uint8_t  worst      = SYNC_HOP_FIXED;
+        uint32_t worst_loss = max_loss;
+
+        for (uint8_t i = 0; i < SYNC_HOP_MAX_CHANNELS; i++) {
+            uint32_t loss = sync_hop_stats_loss(stats, i);
+
+            if ((map & (1UL << i)) && stats->received[i] + stats->missed[i] >= min_beacons && loss > worst_loss) {
+                worst      = i;
+                worst_loss = loss;
+            }
+        }
+
+        if (worst == SYNC_HOP_FIXED) {
+            break;
+        }
+        map &= ~(uint32_t)(1UL << worst);
+    }
+
+    return map;
+}
+
+/**
+ *@}
+ **/
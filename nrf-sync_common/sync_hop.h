@@ -0,0 +1,141 @@
+/** @file
+*
+* @defgroup nrf-sync_common_hop sync_hop.h
+* @{
+* @ingroup nrf-sync_common
+* @brief Beacon frequency hopping.
+*
+* The channel of every beacon is picked from a table of up to
+* SYNC_HOP_MAX_CHANNELS radio channels, among those of a channel map (bit i
+* set: entry i of the table is in use). The pick only depends on a seed, the
+* map and the sequence number of the beacon: a hash of the seed and the
+* sequence number selects one of the channels of the map, so both boards get
+* the same sequence without sharing any state, and a receiver that missed
+* beacons only needs to count them to know where the next one will be.
+*
+* The receiver side tracks the sequence number of the next beacon, and falls
+* back to listening on the first channel of the map (the transmitter comes by
+* every few beacons on average) after too many misses in a row. A change of
+* channel map announced for a later beacon is followed at that beacon even if
+* the ones in between are missed. While searching, the receiver moves on to
+* the next channel of the whole table every few missed periods, so it also
+* finds a transmitter that moved to a map it never heard of.
+*
+* Loss statistics per channel tell which channels should be left out of the
+* map: a lossy channel is dropped, but the map always keeps at least
+* SYNC_HOP_MIN_CHANNELS channels.
+*
+* This module does not touch any peripheral so it can also be built on a host.
+*
+*/
+
+#ifndef SYNC_HOP_H
+#define SYNC_HOP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SYNC_HOP_MAX_CHANNELS        32     // one bit of the channel map per channel
+#define SYNC_HOP_MIN_CHANNELS        2      // channels a blacklist always leaves in the map
+#define SYNC_HOP_FIXED               0xFF   // channel index when the map is 0: the channel is not changed
+
+/**
+ * @brief Receiver state.
+ */
+typedef struct {
+    uint32_t seed;
+    uint32_t map;               // channel map announced by the last beacon
+    uint32_t next_map;          // channel map from beacon switch_sequence on
+    uint32_t switch_sequence;
+    uint32_t table;             // channels searched, all those of the table
+    uint32_t max_misses;        // missed beacons in a row before searching
+    uint32_t dwell;             // missed periods on each channel while searching, 0 to stay on the first one
+    uint32_t expected;          // sequence number of the next beacon
+    uint32_t misses;            // beacons missed since the last one, or periods on the search channel
+    uint8_t  search;            // table index of the search channel
+    bool     synced;            // false while searching
+} sync_hop_rx_t;
+
+/**
+ * @brief Per channel loss statistics.
+ */
+typedef struct {
+    uint32_t received[SYNC_HOP_MAX_CHANNELS];
+    uint32_t missed[SYNC_HOP_MAX_CHANNELS];
+} sync_hop_stats_t;
+
+/**
+ * @brief Function for counting the channels of a map.
+ */
+uint8_t sync_hop_count(uint32_t map);
+
+/**
+ * @brief Function for getting the table index of the channel of beacon number sequence.
+ * Returns SYNC_HOP_FIXED if map is 0.
+ */
+uint8_t sync_hop_index(uint32_t seed, uint32_t map, uint32_t sequence);
+
+/**
+ * @brief Function for getting the table index of the first channel of a map, SYNC_HOP_FIXED if map is 0.
+ */
+uint8_t sync_hop_first(uint32_t map);
+
+/**
+ * @brief Function for getting the table index of the channel after index in a map, wrapping
+ * around (SYNC_HOP_FIXED if map is 0).
+ */
+uint8_t sync_hop_following(uint32_t map, uint8_t index);
+
+/**
+ * @brief Function for initializing the receiver state (searching on the first channel of map).
+ * table holds the channels searched once dwell periods were missed on one of them.
+ */
+void sync_hop_rx_init(sync_hop_rx_t *rx, uint32_t seed, uint32_t map, uint32_t table, uint32_t max_misses, uint32_t dwell);
+
+/**
+ * @brief Function for getting the channel map of beacon number sequence, as last announced.
+ */
+uint32_t sync_hop_rx_map(const sync_hop_rx_t *rx, uint32_t sequence);
+
+/**
+ * @brief Function for feeding a received beacon, with the channel map it announces, and the next
+ * map from beacon switch_sequence on (same as map if there is no change).
+ * Returns the table index of the channel of the next beacon.
+ */
+uint8_t sync_hop_rx_beacon(sync_hop_rx_t *rx, uint32_t sequence, uint32_t map, uint32_t next_map, uint32_t switch_sequence);
+
+/**
+ * @brief Function for telling that the next beacon did not arrive.
+ * Returns the table index of the channel to listen on: the one of the beacon after, or a search
+ * channel once max_misses beacons were missed in a row, starting with the first channel of the map.
+ */
+uint8_t sync_hop_rx_missed(sync_hop_rx_t *rx);
+
+/**
+ * @brief Function for initializing the loss statistics.
+ */
+void sync_hop_stats_init(sync_hop_stats_t *stats);
+
+/**
+ * @brief Function for counting a beacon received or missed on a channel (ignored for SYNC_HOP_FIXED).
+ */
+void sync_hop_stats_add(sync_hop_stats_t *stats, uint8_t index, bool received);
+
+/**
+ * @brief Function for getting the loss of a channel in per mille (0 without any beacon).
+ */
+uint32_t sync_hop_stats_loss(const sync_hop_stats_t *stats, uint8_t index);
+
+/**
+ * @brief Function for removing the lossy channels from a map.
+ * A channel with at least min_beacons beacons and a loss above max_loss per mille is removed,
+ * the worst ones first, as long as SYNC_HOP_MIN_CHANNELS channels are left.
+ * Returns the new map.
+ */
+uint32_t sync_hop_blacklist(const sync_hop_stats_t *stats, uint32_t map, uint32_t min_beacons, uint32_t max_loss);
+
+#endif // SYNC_HOP_H
+
+/**
+ *@}
+ **/
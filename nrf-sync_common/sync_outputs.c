@@ -0,0 +1,58 @@
+/** @file
+*
+* @defgroup nrf-sync_common_outputs_impl sync_outputs.c
+* @{
+* @ingroup nrf-sync_common
+* @brief Extra synchronized outputs implementation.
+*
+*/
+
+#include "sync_outputs.h"
+
+bool sync_outputs_plan(const sync_output_t *outputs, uint8_t count, uint8_t cc_per_timer, uint32_t latency,
+                       uint32_t limit, sync_outputs_plan_t *plan) {
+    uint8_t per_timer = cc_per_timer / 2;
+    uint8_t last[SYNC_OUTPUTS_MAX];             // output with the latest falling edge on each timer
+
+    if (count > SYNC_OUTPUTS_MAX || per_timer == 0) {
+        return false;
+    }
+
+    plan->count  = count;
+    plan->timers = 0;
+
+    for (uint8_t i = 0; i < count; i++) {
+        const sync_output_t *output = &outputs[i];
+        sync_output_cc_t    *cc     = &plan->outputs[i];
+        uint64_t             end    = (uint64_t)output->delay + output->width;
+
+        // a compare value of 0 only matches after the counter wraps
+        if (output->width == 0 || output->delay <= latency || end - latency > UINT32_MAX) {
+            return false;
+        }
+        if (limit != 0 && end >= limit) {
+            return false;
+        }
+
+        cc->timer   = i / per_timer;
+        cc->cc_rise = 2 * (i % per_timer);
+        cc->cc_fall = cc->cc_rise + 1;
+        cc->rise    = output->delay - latency;
+        cc->fall    = (uint32_t)(end - latency);
+
+        if (cc->timer == plan->timers) {
+            // first output on this timer
+            plan->timers++;
+            last[cc->timer] = i;
+        } else if (cc->fall > plan->outputs[last[cc->timer]].fall) {
+            last[cc->timer] = i;
+        }
+        plan->stop_cc[cc->timer] = plan->outputs[last[cc->timer]].cc_fall;
+    }
+
+    return true;
+}
+
+/**
+ *@}
+ **/
@@ -0,0 +1,77 @@
+/** @file
+*
+* @defgroup nrf-sync_common_outputs sync_outputs.h
+* @{
+* @ingroup nrf-sync_common
+* @brief Extra synchronized outputs.
+*
+* Besides the main pulse, the firmware can drive a table of outputs, each one
+* with its own delay after the sync point (the rising edge of the main pulse)
+* and its own width. Every output takes one GPIOTE channel and two compares
+* (rising and falling edge) on a set of output timers, all started by the
+* sync point. Output i uses the compares 2 * (i % n) and 2 * (i % n) + 1 of
+* timer i / n, where n is half the number of compares per timer. Every timer
+* is stopped and cleared by its latest falling edge, so it is ready for the
+* next sync point.
+*
+* The output timers may start a fixed number of ticks after the sync point
+* (latency), which is taken off every compare value, so a delay must be
+* longer than the latency.
+*
+* This module does not touch any peripheral so it can also be built on a host.
+*
+*/
+
+#ifndef SYNC_OUTPUTS_H
+#define SYNC_OUTPUTS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SYNC_OUTPUTS_MAX     8      // one GPIOTE channel per output
+
+/**
+ * @brief Output description, times in timer ticks.
+ */
+typedef struct {
+    uint8_t  port;          // pin port
+    uint8_t  pin;           // pin number
+    uint32_t delay;         // time from the sync point to the rising edge
+    uint32_t width;         // time the output stays high
+} sync_output_t;
+
+/**
+ * @brief Compares driving one output.
+ */
+typedef struct {
+    uint8_t  timer;         // index of the output timer
+    uint8_t  cc_rise;       // compare register of the rising edge
+    uint8_t  cc_fall;       // compare register of the falling edge
+    uint32_t rise;          // compare value of the rising edge
+    uint32_t fall;          // compare value of the falling edge
+} sync_output_cc_t;
+
+/**
+ * @brief Compares of a whole output table.
+ */
+typedef struct {
+    sync_output_cc_t outputs[SYNC_OUTPUTS_MAX];
+    uint8_t          count;                     // number of outputs
+    uint8_t          timers;                    // number of output timers used
+    uint8_t          stop_cc[SYNC_OUTPUTS_MAX]; // compare register that stops and clears each timer
+} sync_outputs_plan_t;
+
+/**
+ * @brief Function for computing the compares of an output table.
+ * Returns false if the table is longer than SYNC_OUTPUTS_MAX, if an output has no width, rises
+ * before the output timers have started (delay <= latency) or does not end before limit ticks
+ * after the sync point (0 for no limit).
+ */
+bool sync_outputs_plan(const sync_output_t *outputs, uint8_t count, uint8_t cc_per_timer, uint32_t latency,
+                       uint32_t limit, sync_outputs_plan_t *plan);
+
+#endif // SYNC_OUTPUTS_H
+
+/**
+ *@}
+ **/
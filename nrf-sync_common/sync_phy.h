@@ -0,0 +1,136 @@
+/** @file
+*
+* @defgroup nrf-sync_common_phy sync_phy.h
+* @{
+* @ingroup nrf-sync_common
+* @brief Radio PHY selection and timing model.
+*
+* Both boards must be built with the same PHY. Instead of one hand-tuned offset,
+* the offset is derived from the frame structure of the selected PHY:
+*
+*     offset = tx chain delay + on-air time up to the end of the CRC + rx chain delay
+*
+* which is the time from the transmitter TASKS_START to the receiver EVENTS_CRCOK.
+* The chain delays are the typical values of the nRF52840 product specification,
+* calibration (see sync_calib.h) takes care of the remaining board differences.
+*
+* Coded PHY frames (Ble_LR125Kbit, Ble_LR500Kbit) are made of two FEC blocks:
+*
+*     | preamble 80 us | access address 256 us | CI 16 us | TERM1 24 us |   (always S=8)
+*     | payload + CRC 8*S us per bit | TERM2 3*S us |                       (S=8 or S=2)
+*
+* The receiver sees EVENTS_END/EVENTS_CRCOK after the CRC, TERM2 only adds to
+* the total on-air time.
+*
+* Everything is a macro on constants, so it is folded at compile time. The
+* RADIO_* register values are only expanded where the macros are used.
+*
+*/
+
+#ifndef SYNC_PHY_H
+#define SYNC_PHY_H
+
+#define SYNC_PHY_NRF_1MBIT                0
+#define SYNC_PHY_NRF_2MBIT                1
+#define SYNC_PHY_BLE_1MBIT                2
+#define SYNC_PHY_BLE_2MBIT                3
+#define SYNC_PHY_BLE_LR125KBIT            4
+#define SYNC_PHY_BLE_LR500KBIT            5
+
+#define SYNC_PHY_TX_CHAIN_DELAY_MS        0.0006   // TASKS_START to first bit on air, all PHYs
+
+/**
+ * @brief RADIO MODE register value.
+ */
+#define SYNC_PHY_MODE(phy)                                         \
+    ((phy) == SYNC_PHY_NRF_2MBIT     ? RADIO_MODE_MODE_Nrf_2Mbit     : \
+     (phy) == SYNC_PHY_BLE_1MBIT     ? RADIO_MODE_MODE_Ble_1Mbit     : \
+     (phy) == SYNC_PHY_BLE_2MBIT     ? RADIO_MODE_MODE_Ble_2Mbit     : \
+     (phy) == SYNC_PHY_BLE_LR125KBIT ? RADIO_MODE_MODE_Ble_LR125Kbit : \
+     (phy) == SYNC_PHY_BLE_LR500KBIT ? RADIO_MODE_MODE_Ble_LR500Kbit : \
+                                       RADIO_MODE_MODE_Nrf_1Mbit)
+
+/**
+ * @brief True for the 2 Mbit PHYs.
+ */
+#define SYNC_PHY_IS_2MBIT(phy)            ((phy) == SYNC_PHY_NRF_2MBIT || (phy) == SYNC_PHY_BLE_2MBIT)
+
+/**
+ * @brief True for the coded (long range) PHYs.
+ */
+#define SYNC_PHY_IS_CODED(phy)            ((phy) == SYNC_PHY_BLE_LR125KBIT || (phy) == SYNC_PHY_BLE_LR500KBIT)
+
+/**
+ * @brief Coding factor S of the second FEC block (coded PHYs only).
+ */
+#define SYNC_PHY_CODED_S(phy)             (((phy) == SYNC_PHY_BLE_LR125KBIT) ? 8 : 2)
+
+/**
+ * @brief Base address length (PCNF1 BALEN). Coded PHYs only support a 4 byte access address.
+ */
+#define SYNC_PHY_BALEN(phy)               (SYNC_PHY_IS_CODED(phy) ? 3UL : 4UL)
+
+/**
+ * @brief RADIO PCNF0 value: preamble length, and the CI/TERM fields of the coded PHYs.
+ */
+#define SYNC_PHY_PCNF0(phy)                                                            \
+    (SYNC_PHY_IS_CODED(phy) ? ((RADIO_PCNF0_PLEN_LongRange << RADIO_PCNF0_PLEN_Pos)  | \
+                               (2UL                        << RADIO_PCNF0_CILEN_Pos) | \
+                               (3UL                        << RADIO_PCNF0_TERMLEN_Pos)) : \
+     SYNC_PHY_IS_2MBIT(phy) ?  (RADIO_PCNF0_PLEN_16bit     << RADIO_PCNF0_PLEN_Pos)  : \
+                               (RADIO_PCNF0_PLEN_8bit      << RADIO_PCNF0_PLEN_Pos))
+
+/**
+ * @brief Time in ms to send one byte of payload.
+ */
+#define SYNC_PHY_BYTE_TIME_MS(phy)                                        \
+    (SYNC_PHY_IS_CODED(phy) ? 0.008 * SYNC_PHY_CODED_S(phy) :             \
+     SYNC_PHY_IS_2MBIT(phy) ? 0.004 : 0.008)
+
+/**
+ * @brief Time in ms from the last CRC bit on air to the receiver EVENTS_END/EVENTS_CRCOK.
+ * The coded PHY values are approximate (Viterbi decoding depth), refine them with calibration.
+ */
+#define SYNC_PHY_RX_CHAIN_DELAY_MS(phy)                                   \
+    ((phy) == SYNC_PHY_BLE_LR125KBIT ? 0.0428 :                           \
+     (phy) == SYNC_PHY_BLE_LR500KBIT ? 0.0206 :                           \
+     SYNC_PHY_IS_2MBIT(phy)          ? 0.005  : 0.0094)
+
+/**
+ * @brief On-air time in ms from the first preamble bit to the end of the address.
+ * address_bytes is BALEN + 1 (prefix).
+ */
+#define SYNC_PHY_ADDRESS_TIME_MS(phy, address_bytes)                      \
+    (SYNC_PHY_IS_CODED(phy) ? 0.080 + 0.064 * (address_bytes) :           \
+                              ((SYNC_PHY_IS_2MBIT(phy) ? 2 : 1) + (address_bytes)) * SYNC_PHY_BYTE_TIME_MS(phy))
+
+/**
+ * @brief On-air time in ms from the end of the address to the end of the CRC.
+ */
+#define SYNC_PHY_ADDRESS_TO_END_MS(phy, payload_bytes, crc_bytes)         \
+    ((SYNC_PHY_IS_CODED(phy) ? 0.016 + 0.024 : 0) + ((payload_bytes) + (crc_bytes)) * SYNC_PHY_BYTE_TIME_MS(phy))
+
+/**
+ * @brief On-air time in ms from the first preamble bit to the end of the CRC.
+ */
+#define SYNC_PHY_AIRTIME_MS(phy, address_bytes, payload_bytes, crc_bytes) \
+    (SYNC_PHY_ADDRESS_TIME_MS(phy, address_bytes) + SYNC_PHY_ADDRESS_TO_END_MS(phy, payload_bytes, crc_bytes))
+
+/**
+ * @brief Total on-air time in ms of a frame, including TERM2 on the coded PHYs.
+ */
+#define SYNC_PHY_FRAME_TIME_MS(phy, address_bytes, payload_bytes, crc_bytes) \
+    (SYNC_PHY_AIRTIME_MS(phy, address_bytes, payload_bytes, crc_bytes) +     \
+     (SYNC_PHY_IS_CODED(phy) ? 0.003 * SYNC_PHY_CODED_S(phy) : 0))
+
+/**
+ * @brief Time in ms from the transmitter TASKS_START to the receiver EVENTS_CRCOK.
+ */
+#define SYNC_PHY_OFFSET_MS(phy, address_bytes, payload_bytes, crc_bytes) \
+    (SYNC_PHY_TX_CHAIN_DELAY_MS + SYNC_PHY_AIRTIME_MS(phy, address_bytes, payload_bytes, crc_bytes) + SYNC_PHY_RX_CHAIN_DELAY_MS(phy))
+
+#endif // SYNC_PHY_H
+
+/**
+ *@}
+ **/
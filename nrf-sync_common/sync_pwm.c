@@ -0,0 +1,74 @@
+/** @file
+*
+* @defgroup nrf-sync_common_pwm_impl sync_pwm.c
+* @{
+* @ingroup nrf-sync_common
+* @brief PWM sequence compiler implementation.
+*
+*/
+
+#include "sync_pwm.h"
+
+uint16_t sync_pwm_compile(const sync_pwm_segment_t *segments, uint16_t count, uint16_t countertop,
+                          uint16_t *sequence, uint16_t max_length) {
+    uint64_t total = 0;
+    uint64_t slots;
+    uint16_t i     = 0;     // segment holding the start of the current slot
+    uint64_t end;           // end of segment i
+
+    if (countertop == 0 || countertop > SYNC_PWM_COUNTERTOP_MAX) {
+        return 0;
+    }
+
+    for (uint16_t j = 0; j < count; j++) {
+        total += segments[j].duration;
+    }
+
+    slots = (total + countertop - 1) / countertop;
+    if (slots == 0 || slots > max_length) {
+        return 0;
+    }
+
+    end = segments[0].duration;
+
+    for (uint16_t s = 0; s < slots; s++) {
+        uint64_t start = (uint64_t)s * countertop;
+        uint64_t stop  = start + countertop;
+        uint32_t edges = 0;
+        uint32_t at    = countertop;
+        bool     level;
+
+        while (i + 1 < count && end <= start) {
+            i++;
+            end += segments[i].duration;
+        }
+        level = segments[i].level;
+
+        // level changes strictly inside the slot
+        bool     current = level;
+        uint64_t edge    = end;
+        for (uint16_t j = i + 1; j < count && edge < stop; j++) {
+            if (segments[j].duration == 0) {
+                continue;
+            }
+            if (segments[j].level != current) {
+                edges++;
+                at      = (uint32_t)(edge - start);
+                current = segments[j].level;
+            }
+            edge += segments[j].duration;
+        }
+
+        if (edges > 1) {
+            return 0;
+        }
+
+        sequence[s] = (level ? SYNC_PWM_FALLING_EDGE : SYNC_PWM_RISING_EDGE) | (uint16_t)at;
+    }
+
+    return (uint16_t)slots;
+}
+
+/**
+ *@}
+ **/
@@ -0,0 +1,56 @@
+/** @file
+*
+* @defgroup nrf-sync_common_pwm sync_pwm.h
+* @{
+* @ingroup nrf-sync_common
+* @brief PWM sequence compiler.
+*
+* Turns an edge pattern, given as a list of (level, duration) segments
+* starting at the sync point, into a PWM sequence that EasyDMA plays without
+* CPU once the sequence is started by PPI. The PWM runs in up mode with one
+* value per PWM period (countertop ticks), so every period is a slot that
+* can hold at most one edge of the pattern:
+*     - a slot starting high uses a falling edge value, high until the
+*       compare value, then low
+*     - a slot starting low uses a rising edge value, low until the compare
+*       value, then high
+*     - a slot without edge uses countertop as compare value, which the
+*       counter never reaches, so the output keeps its level
+* An edge on a slot boundary only changes the level the slot starts with.
+* The last slot is padded with the last level of the pattern.
+*
+* This module does not touch any peripheral so it can also be built on a host.
+*
+*/
+
+#ifndef SYNC_PWM_H
+#define SYNC_PWM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SYNC_PWM_FALLING_EDGE    0x8000U    // sequence value polarity bit: first edge in the period is falling
+#define SYNC_PWM_RISING_EDGE     0x0000U    // sequence value polarity bit: first edge in the period is rising
+#define SYNC_PWM_COUNTERTOP_MAX  32767U     // widest PWM period in PWM clock ticks
+
+/**
+ * @brief Pattern segment.
+ */
+typedef struct {
+    bool     level;         // output level during the segment
+    uint32_t duration;      // duration in PWM clock ticks, 0 is allowed and ignored
+} sync_pwm_segment_t;
+
+/**
+ * @brief Function for compiling a pattern into a PWM sequence.
+ * Returns the number of values written into sequence, or 0 if the pattern is empty, countertop is out
+ * of range, a slot would hold more than one edge or the sequence does not fit in max_length values.
+ */
+uint16_t sync_pwm_compile(const sync_pwm_segment_t *segments, uint16_t count, uint16_t countertop,
+                          uint16_t *sequence, uint16_t max_length);
+
+#endif // SYNC_PWM_H
+
+/**
+ *@}
+ **/
@@ -0,0 +1,59 @@
+/** @file
+*
+* @defgroup nrf-sync_common_rtc_impl sync_rtc.c
+* @{
+* @ingroup nrf-sync_common
+* @brief RTC schedule implementation.
+*
+*/
+
+#include "sync_rtc.h"
+#include "sync_timing.h"
+
+bool sync_rtc_init(sync_rtc_t *rtc, uint64_t period_us, uint32_t lead_us) {
+
+    // period in prescaler 0 ticks, rounded up, decides the prescaler
+    uint64_t ticks     = (period_us * SYNC_RTC_BASE_HZ + 999999) / 1000000;
+    uint64_t prescaler = ticks / SYNC_RTC_MAX_PERIOD_TICKS;
+
+    if (period_us == 0 || prescaler > SYNC_RTC_PRESCALER_MAX) {
+        return false;
+    }
+
+    rtc->period_us = period_us;
+    rtc->prescaler = (uint32_t)prescaler;
+    rtc->index     = 0;
+
+    // lead rounded up to whole ticks
+    uint64_t tick_scaled = (uint64_t)(rtc->prescaler + 1) * 1000000;
+    rtc->lead = (uint32_t)(((uint64_t)lead_us * SYNC_RTC_BASE_HZ + tick_scaled - 1) / tick_scaled);
+    if (rtc->lead < SYNC_RTC_MIN_LEAD_TICKS) {
+        rtc->lead = SYNC_RTC_MIN_LEAD_TICKS;
+    }
+
+    // the next wake must come after the current fire
+    return (period_us * SYNC_RTC_BASE_HZ) / tick_scaled > rtc->lead;
+}
+
+void sync_rtc_next(sync_rtc_t *rtc, sync_rtc_slot_t *slot) {
+
+    rtc->index++;
+
+    // times scaled by SYNC_RTC_BASE_HZ, in us: one tick is (prescaler + 1) x 10^6
+    uint64_t start_scaled = rtc->index * rtc->period_us * SYNC_RTC_BASE_HZ;
+    uint64_t tick_scaled  = (uint64_t)(rtc->prescaler + 1) * 1000000;
+    uint64_t fire         = start_scaled / tick_scaled;
+    uint64_t remainder    = start_scaled - fire * tick_scaled;
+
+    slot->fire         = (uint32_t)fire & SYNC_RTC_COUNTER_MASK;
+    slot->wake         = (uint32_t)(fire - rtc->lead) & SYNC_RTC_COUNTER_MASK;
+    slot->remainder_us = (uint32_t)((remainder + SYNC_RTC_BASE_HZ / 2) / SYNC_RTC_BASE_HZ);
+}
+
+uint32_t sync_rtc_tick_us(const sync_rtc_t *rtc) {
+    return (uint32_t)(((uint64_t)(rtc->prescaler + 1) * 1000000 + SYNC_RTC_BASE_HZ / 2) / SYNC_RTC_BASE_HZ);
+}
+
+/**
+ *@}
+ **/
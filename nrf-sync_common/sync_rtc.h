@@ -0,0 +1,77 @@
+/** @file
+*
+* @defgroup nrf-sync_common_rtc sync_rtc.h
+* @{
+* @ingroup nrf-sync_common
+* @brief Long period schedule on the RTC, with a fine TIMER remainder.
+*
+* The period is kept by the 24-bit RTC, running from LFCLK, so HFCLK and the
+* TIMERs are only needed around each pulse. Period n starts at n x period us
+* after the RTC start, which in general falls between two RTC ticks:
+*
+*     - fire is the last RTC tick before it, it starts a TIMER
+*     - remainder is the time from that tick to the exact start, in us, that
+*       the TIMER adds (so the edges keep a TIMER resolution)
+*     - wake is lead ticks before fire, it starts HFCLK
+*
+* Every slot is computed from its index, so the rounding of the remainder does
+* not accumulate. The RTC prescaler is the smallest one that keeps the period
+* under half the counter range, which gives periods up to ~12 days with
+* 125 ms ticks.
+*
+* This module does not touch any peripheral so it can also be built on a host.
+*
+*/
+
+#ifndef SYNC_RTC_H
+#define SYNC_RTC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SYNC_RTC_PRESCALER_MAX       4095   // 8 Hz, 125 ms ticks
+#define SYNC_RTC_MAX_PERIOD_TICKS    (1UL << 23)   // half the counter range
+#define SYNC_RTC_MIN_LEAD_TICKS      2      // a compare closer than this to COUNTER may be missed
+
+/**
+ * @brief RTC schedule state.
+ */
+typedef struct {
+    uint64_t period_us;         // period in us
+    uint32_t prescaler;         // RTC PRESCALER
+    uint32_t lead;              // ticks from wake to fire
+    uint64_t index;             // index of the last slot returned by sync_rtc_next()
+} sync_rtc_t;
+
+/**
+ * @brief One period: RTC compare values (masked to 24 bits) and fine remainder.
+ */
+typedef struct {
+    uint32_t wake;              // RTC compare starting HFCLK
+    uint32_t fire;              // RTC compare starting the fine TIMER
+    uint32_t remainder_us;      // time from fire to the exact period start, below one tick
+} sync_rtc_slot_t;
+
+/**
+ * @brief Function for initializing the schedule.
+ * lead_us is the minimum time between HFCLK start and fire.
+ * Returns false if the period does not fit even with the largest prescaler,
+ * or is not longer than the lead.
+ */
+bool sync_rtc_init(sync_rtc_t *rtc, uint64_t period_us, uint32_t lead_us);
+
+/**
+ * @brief Function for getting the next slot (the first one is one period after the RTC start).
+ */
+void sync_rtc_next(sync_rtc_t *rtc, sync_rtc_slot_t *slot);
+
+/**
+ * @brief Function for getting the length of one RTC tick in us (rounded).
+ */
+uint32_t sync_rtc_tick_us(const sync_rtc_t *rtc);
+
+#endif // SYNC_RTC_H
+
+/**
+ *@}
+ **/
@@ -0,0 +1,113 @@
+/** @file
+*
+* @defgroup nrf-sync_common_scan_impl sync_scan.c
+* @{
+* @ingroup nrf-sync_common
+* @brief Channel ranking from noise floor scans implementation.
+*
+*/
+
+#include "sync_scan.h"
+
+/**
+ * @brief Function for getting the mean score of the scanned channels of a map, in 1/16 dB.
+ * Returns false if none of them was scanned.
+ */
+static bool mean(const sync_scan_t *scan, uint32_t map, int32_t *score) {
+    int32_t sum   = 0;
+    int32_t count = 0;
+
+    for (uint8_t i = 0; i < scan->channels; i++) {
+        if ((map & scan->scanned) & (1UL << i)) {
+            sum += sync_scan_score(scan, i);
+            count++;
+        }
+    }
+
+    if (count == 0) {
+        return false;
+    }
+    *score = sum / count;
+    return true;
+}
+
+bool sync_scan_init(sync_scan_t *scan, uint8_t channels) {
+    scan->channels = channels > SYNC_HOP_MAX_CHANNELS ? SYNC_HOP_MAX_CHANNELS : channels;
+    scan->next     = 0;
+    scan->scanned  = 0;
+    for (uint8_t i = 0; i < SYNC_HOP_MAX_CHANNELS; i++) {
+        scan->noise[i] = 0;
+        scan->loss[i]  = 0;
+    }
+
+    // sync_scan_next() wraps around the table
+    return channels > 0;
+}
+
+bool sync_scan_next(sync_scan_t *scan, uint8_t *index) {
+    *index     = scan->next;
+    scan->next = (uint8_t)((scan->next + 1) % scan->channels);
+
+    return scan->next == 0;
+}
+
+void sync_scan_add(sync_scan_t *scan, uint8_t index, uint8_t rssi) {
+    int32_t sample = -16 * (int32_t)rssi;
+
+    if (index >= scan->channels) {
+        return;
+    }
+
+    if (scan->scanned & (1UL << index)) {
+        // arithmetic shift of a signed difference: rounds towards minus infinity, fine for a filter
+        scan->noise[index] += (sample - scan->noise[index]) / (1 << SYNC_SCAN_FILTER);
+    } else {
+        scan->noise[index] = sample;
+        scan->scanned     |= 1UL << index;
+    }
+}
+
+void sync_scan_loss(sync_scan_t *scan, uint8_t index, uint32_t loss) {
+
+    if (index >= scan->channels) {
+        return;
+    }
+    scan->loss[index] = loss > 1000 ? 1000 : loss;
+}
+
+int32_t sync_scan_score(const sync_scan_t *scan, uint8_t index) {
+    return scan->noise[index] + (int32_t)(scan->loss[index] * 16 / SYNC_SCAN_LOSS_PER_DB);
+}
+
+uint32_t sync_scan_best(const sync_scan_t *scan, uint8_t count, uint32_t map, uint32_t hysteresis) {
+    uint32_t best = 0;
+    int32_t  best_score;
+    int32_t  score;
+
+    if (count == 0 || sync_hop_count(scan->scanned) < count) {
+        return map;
+    }
+
+    // selection of the count lowest scores, the lowest index first on a tie
+    for (uint8_t n = 0; n < count; n++) {
+        uint8_t pick = SYNC_HOP_FIXED;
+
+        for (uint8_t i = 0; i < scan->channels; i++) {
+            if ((scan->scanned & ~best & (1UL << i)) &&
+                (pick == SYNC_HOP_FIXED || sync_scan_score(scan, i) < sync_scan_score(scan, pick))) {
+                pick = i;
+            }
+        }
+        best |= 1UL << pick;
+    }
+
+    mean(scan, best, &best_score);
+    if (best == map || (mean(scan, map, &score) && score - best_score < (int32_t)(hysteresis * 16))) {
+        return map;
+    }
+    return best;
+}
+
+/**
+ *@}
+ **/
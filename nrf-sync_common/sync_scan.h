@@ -0,0 +1,82 @@
+/** @file
+*
+* @defgroup nrf-sync_common_scan sync_scan.h
+* @{
+* @ingroup nrf-sync_common
+* @brief Channel ranking from noise floor scans.
+*
+* The channels of a hop table (see sync_hop.h) are scanned one at a time, in
+* turn: every RSSI sample updates the noise floor of its channel, filtered
+* over a few scans. Each channel is scored with its noise floor plus a penalty
+* for the beacon loss reported on it by the receivers, SYNC_SCAN_LOSS_PER_DB
+* per mille of loss weighing as much as 1 dB of noise.
+*
+* After every round of the table, the best channels make a new channel map.
+* It only replaces the map in use if its mean score is better by a
+* hysteresis, so the group does not move back and forth between channels of
+* about the same quality.
+*
+* This module does not touch any peripheral so it can also be built on a host.
+*
+*/
+
+#ifndef SYNC_SCAN_H
+#define SYNC_SCAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sync_hop.h"
+
+#define SYNC_SCAN_LOSS_PER_DB        10     // loss in per mille weighing as much as 1 dB of noise floor
+#define SYNC_SCAN_FILTER             2      // each sample moves the noise floor by 1 / 2^SYNC_SCAN_FILTER of the difference
+
+/**
+ * @brief Scan state.
+ */
+typedef struct {
+    uint8_t  channels;                          // entries of the hop table
+    uint8_t  next;                              // table index of the next channel to scan
+    uint32_t scanned;                           // channels with a noise floor
+    int32_t  noise[SYNC_HOP_MAX_CHANNELS];      // noise floor in 1/16 dBm
+    uint32_t loss[SYNC_HOP_MAX_CHANNELS];       // reported loss in per mille
+} sync_scan_t;
+
+/**
+ * @brief Function for initializing the scan of the first channels entries of a hop table.
+ * Returns false if channels is 0: there is nothing to scan, and the scan must not be used.
+ */
+bool sync_scan_init(sync_scan_t *scan, uint8_t channels);
+
+/**
+ * @brief Function for getting the table index of the next channel to scan.
+ * Returns true if the channel is the last one of a round. Only valid after a successful sync_scan_init().
+ */
+bool sync_scan_next(sync_scan_t *scan, uint8_t *index);
+
+/**
+ * @brief Function for adding an RSSI sample of a channel, as read from RSSISAMPLE (-dBm).
+ */
+void sync_scan_add(sync_scan_t *scan, uint8_t index, uint8_t rssi);
+
+/**
+ * @brief Function for setting the loss in per mille reported by a receiver for a channel.
+ */
+void sync_scan_loss(sync_scan_t *scan, uint8_t index, uint32_t loss);
+
+/**
+ * @brief Function for getting the score of a channel in 1/16 dB, the lower the better.
+ */
+int32_t sync_scan_score(const sync_scan_t *scan, uint8_t index);
+
+/**
+ * @brief Function for ranking the scanned channels.
+ * Returns the map of the count best ones, or map if they are not better by at least hysteresis dB
+ * on average, or if fewer than count channels were scanned.
+ */
+uint32_t sync_scan_best(const sync_scan_t *scan, uint8_t count, uint32_t map, uint32_t hysteresis);
+
+#endif // SYNC_SCAN_H
+
+/**
+ *@}
+ **/
@@ -0,0 +1,47 @@
+/** @file
+*
+* @defgroup nrf-sync_common_schedule_impl sync_schedule.c
+* @{
+* @ingroup nrf-sync_common
+* @brief Free-running pulse schedule implementation.
+*
+*/
+
+#include "sync_schedule.h"
+
+bool sync_schedule_compute(const sync_schedule_t *schedule, sync_schedule_cc_t *cc) {
+    
+    // the compare event at 0 never fires after a clear, and the falling edge
+    // must come before the period end or it would be lost
+    if (schedule->offset == 0 || schedule->width == 0) {
+        return false;
+    }
+    if ((uint64_t)schedule->offset + schedule->width >= schedule->period) {
+        return false;
+    }
+
+    cc->rise   = schedule->offset;
+    cc->fall   = schedule->offset + schedule->width;
+    cc->period = schedule->period;
+
+    return true;
+}
+
+uint64_t sync_schedule_edge_time(const sync_schedule_cc_t *cc, uint32_t period_index, sync_schedule_edge_t edge) {
+
+    uint64_t period_start = (uint64_t)period_index * cc->period;
+
+    switch (edge) {
+        case SYNC_SCHEDULE_EDGE_RISE:
+            return period_start + cc->rise;
+        case SYNC_SCHEDULE_EDGE_FALL:
+            return period_start + cc->fall;
+        case SYNC_SCHEDULE_EDGE_RADIO_START:
+        default:
+            return period_start;
+    }
+}
+
+/**
+ *@}
+ **/
@@ -0,0 +1,69 @@
+/** @file
+*
+* @defgroup nrf-sync_common_schedule sync_schedule.h
+* @{
+* @ingroup nrf-sync_common
+* @brief Free-running pulse schedule.
+*
+* Computes the TIMER compare values used when the transmitter runs its timer
+* without ever stopping it. The radio start, the rising edge and the falling
+* edge of the pulse are all compare points on the same timebase, and the
+* period-end compare clears the counter, so the period is exactly the
+* configured number of ticks.
+*
+* This module does not touch any peripheral so it can also be built on a host.
+*
+*/
+
+#ifndef SYNC_SCHEDULE_H
+#define SYNC_SCHEDULE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Pulse schedule, all values in timer ticks.
+ */
+typedef struct {
+    uint32_t period;        // time between two radio starts
+    uint32_t offset;        // time between the radio start and the rising edge
+    uint32_t width;         // time the pulse stays high
+} sync_schedule_t;
+
+/**
+ * @brief Compare values for one period of the free-running timer.
+ * The counter is cleared by the period compare, which also starts the radio.
+ */
+typedef struct {
+    uint32_t rise;          // compare value of the rising edge
+    uint32_t fall;          // compare value of the falling edge
+    uint32_t period;        // compare value of the period end (clears the counter)
+} sync_schedule_cc_t;
+
+typedef enum {
+    SYNC_SCHEDULE_EDGE_RADIO_START,
+    SYNC_SCHEDULE_EDGE_RISE,
+    SYNC_SCHEDULE_EDGE_FALL
+} sync_schedule_edge_t;
+
+/**
+ * @brief Function for computing the compare values of a schedule.
+ * Returns false if the pulse does not fit in the period: both edges must
+ * happen strictly after the counter has been cleared and strictly before
+ * the next period end.
+ */
+bool sync_schedule_compute(const sync_schedule_t *schedule, sync_schedule_cc_t *cc);
+
+/**
+ * @brief Function for getting the absolute time of an edge.
+ * Returns the number of ticks elapsed from the first timer start until the
+ * given edge of period number period_index. Since the counter is never
+ * stopped, this is always period_index * period plus a constant.
+ */
+uint64_t sync_schedule_edge_time(const sync_schedule_cc_t *cc, uint32_t period_index, sync_schedule_edge_t edge);
+
+#endif // SYNC_SCHEDULE_H
+
+/**
+ *@}
+ **/
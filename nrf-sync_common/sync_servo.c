@@ -0,0 +1,126 @@
+/** @file
+*
+* @defgroup nrf-sync_common_servo_impl sync_servo.c
+* @{
+* @ingroup nrf-sync_common
+* @brief Clock-drift servo implementation.
+*
+*/
+
+#include "sync_servo.h"
+
+#define ONE     (1ULL << SYNC_SERVO_FRAC_BITS)
+#define HALF    (ONE >> 1)
+
+/**
+ * @brief Function for shifting a signed value right, rounding to the nearest (halves away from zero).
+ */
+static int64_t shift_round(int64_t value, uint8_t shift) {
+    if (shift == 0) {
+        return value;
+    }
+    int64_t half = 1LL << (shift - 1);
+    return (value >= 0) ? (value + half) >> shift : -((-value + half) >> shift);
+}
+
+/**
+ * @brief Function for dividing a signed value, rounding to the nearest.
+ */
+static int64_t div_round(int64_t value, int64_t divisor) {
+    return (value >= 0) ? (value + divisor / 2) / divisor : -((-value + divisor / 2) / divisor);
+}
+
+/**
+ * @brief Function for restarting the grid on a beacon.
+ * The first new pulse is placed at least half a period after the pulse that may already be
+ * programmed, so a restart never produces two pulses close to each other.
+ */
+static void reset(sync_servo_t *servo, uint32_t timestamp) {
+    servo->next = ((uint64_t)timestamp << SYNC_SERVO_FRAC_BITS) + servo->period;
+
+    if (servo->has_pending) {
+        while ((int64_t)(int32_t)((uint32_t)(servo->next >> SYNC_SERVO_FRAC_BITS) - servo->pending) <
+               (int64_t)(servo->period >> (SYNC_SERVO_FRAC_BITS + 1))) {
+            servo->next += servo->period;
+        }
+    }
+
+    servo->beacons     = 1;
+    servo->last_beacon = timestamp;
+}
+
+void sync_servo_init(sync_servo_t *servo, uint32_t nominal_period, uint32_t tolerance, uint8_t kp_shift, uint8_t ki_shift) {
+    servo->next        = 0;
+    servo->period      = (uint64_t)nominal_period << SYNC_SERVO_FRAC_BITS;
+    servo->nominal     = nominal_period;
+    servo->tolerance   = tolerance;
+    servo->kp_shift    = kp_shift;
+    servo->ki_shift    = ki_shift;
+    servo->beacons     = 0;
+    servo->last_beacon = 0;
+    servo->pending     = 0;
+    servo->has_pending = false;
+}
+
+void sync_servo_beacon(sync_servo_t *servo, uint32_t timestamp, sync_servo_report_t *report) {
+
+    report->phase_error = 0;
+    report->reset       = false;
+
+    if (servo->beacons == 0) {
+        reset(servo, timestamp);
+        report->reset = true;
+    } else {
+        // periods since the last beacon
+        uint32_t elapsed = timestamp - servo->last_beacon;
+        uint32_t periods = (uint32_t)((((uint64_t)elapsed << SYNC_SERVO_FRAC_BITS) + (servo->period >> 1)) / servo->period);
+
+        // distance to the next pulse in fractional ticks, the integer part is a 32-bit difference
+        int64_t distance = (int64_t)(int32_t)(timestamp - (uint32_t)(servo->next >> SYNC_SERVO_FRAC_BITS)) * (int64_t)ONE -
+                           (int64_t)(servo->next & (ONE - 1));
+
+        // error to the nearest grid point
+        int64_t error = distance - div_round(distance, (int64_t)servo->period) * (int64_t)servo->period;
+
+        report->phase_error = (int32_t)shift_round(error, SYNC_SERVO_FRAC_BITS);
+
+        uint32_t abs_error = (uint32_t)(report->phase_error < 0 ? -report->phase_error : report->phase_error);
+
+        if (periods == 0) {
+            // duplicate beacon, nothing to learn from it
+        } else if (servo->beacons == 1) {
+            // first interval: the grid ran on the nominal period, take the measured one instead
+            servo->period = ((uint64_t)elapsed << SYNC_SERVO_FRAC_BITS) / periods;
+            reset(servo, timestamp);
+            servo->beacons = 2;
+        } else if (abs_error > servo->tolerance) {
+            reset(servo, timestamp);
+            report->reset = true;
+        } else {
+            // beacons may be several periods apart, the frequency error is spread over all of them
+            servo->next   += (uint64_t)shift_round(error, servo->kp_shift);
+            servo->period += (uint64_t)shift_round(error / (int64_t)periods, servo->ki_shift);
+            servo->beacons++;
+            servo->last_beacon = timestamp;
+        }
+    }
+
+    int64_t diff = (int64_t)servo->period - ((int64_t)servo->nominal << SYNC_SERVO_FRAC_BITS);
+    report->freq_offset_ppb = (int32_t)(diff * 1000000000LL / ((int64_t)servo->nominal << SYNC_SERVO_FRAC_BITS));
+}
+
+bool sync_servo_running(const sync_servo_t *servo) {
+    return servo->beacons > 0;
+}
+
+uint32_t sync_servo_advance(sync_servo_t *servo) {
+    servo->pending     = (uint32_t)((servo->next + HALF) >> SYNC_SERVO_FRAC_BITS);
+    servo->has_pending = true;
+    servo->next       += servo->period;
+
+    return servo->pending;
+}
+
+/**
+ *@}
+ **/
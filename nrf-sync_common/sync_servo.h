@@ -0,0 +1,83 @@
+/** @file
+*
+* @defgroup nrf-sync_common_servo sync_servo.h
+* @{
+* @ingroup nrf-sync_common
+* @brief Clock-drift servo (software PLL) for the receiver pulse schedule.
+*
+* The receiver generates every pulse from its own free-running TIMER, on a grid
+* of one pulse per period. Each beacon is timestamped on the same TIMER and
+* compared with the nearest point of the grid. A PI filter then corrects:
+*
+*     - the phase of the grid by error / 2^kp_shift
+*     - the period (the frequency offset with the transmitter crystal) by
+*       error / (periods since the last beacon) / 2^ki_shift
+*
+* so the pulses stay aligned between beacons, and beacons can be lost or sent
+* less often than pulses. Times are kept with SYNC_SERVO_FRAC_BITS fractional
+* bits; the integer part is a 32-bit timer value and may wrap.
+*
+* This module does not touch any peripheral so it can also be built on a host.
+*
+*/
+
+#ifndef SYNC_SERVO_H
+#define SYNC_SERVO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SYNC_SERVO_FRAC_BITS         16     // fractional bits of the period and phase
+
+/**
+ * @brief Servo state.
+ */
+typedef struct {
+    uint64_t next;              // time of the next pulse to schedule, in 1 / 2^FRAC ticks
+    uint64_t period;            // disciplined period, in 1 / 2^FRAC ticks
+    uint32_t nominal;           // nominal period in ticks
+    uint32_t tolerance;         // max phase error (ticks) before the grid is reset on a beacon
+    uint8_t  kp_shift;          // phase gain is 1 / 2^kp_shift
+    uint8_t  ki_shift;          // frequency gain is 1 / 2^ki_shift
+    uint32_t beacons;           // beacons used since the last reset, 0 until the first one
+    uint32_t last_beacon;       // timestamp of the last beacon
+    uint32_t pending;           // timer value returned by the last sync_servo_advance() call
+    bool     has_pending;       // false until sync_servo_advance() is called
+} sync_servo_t;
+
+/**
+ * @brief What the servo did with a beacon.
+ */
+typedef struct {
+    int32_t  phase_error;       // beacon timestamp minus nearest grid point, in ticks
+    int32_t  freq_offset_ppb;   // disciplined period compared to the nominal one, in parts per billion
+    bool     reset;             // true if the grid was (re)started from this beacon
+} sync_servo_report_t;
+
+/**
+ * @brief Function for initializing the servo.
+ */
+void sync_servo_init(sync_servo_t *servo, uint32_t nominal_period, uint32_t tolerance, uint8_t kp_shift, uint8_t ki_shift);
+
+/**
+ * @brief Function for feeding the timestamp of a received beacon.
+ * Does not move the pulse returned by the last sync_servo_advance() call, corrections
+ * apply from the one after, so a compare that is already programmed is never changed.
+ */
+void sync_servo_beacon(sync_servo_t *servo, uint32_t timestamp, sync_servo_report_t *report);
+
+/**
+ * @brief Function for knowing if pulses can be generated (at least one beacon was received).
+ */
+bool sync_servo_running(const sync_servo_t *servo);
+
+/**
+ * @brief Function for getting the timer value of the next pulse and moving the grid one period forward.
+ */
+uint32_t sync_servo_advance(sync_servo_t *servo);
+
+#endif // SYNC_SERVO_H
+
+/**
+ *@}
+ **/
@@ -0,0 +1,66 @@
+/** @file
+*
+* @defgroup nrf-sync_common_timing sync_timing.h
+* @{
+* @ingroup nrf-sync_common
+* @brief Time to TIMER tick conversions.
+*
+* TIMER runs from the 16 MHz clock divided by 2^PRESCALER. All the macros below
+* only use constants, so when they are given the compile time configuration of
+* main.c they are folded by the compiler and cost nothing at runtime.
+*
+*/
+
+#ifndef SYNC_TIMING_H
+#define SYNC_TIMING_H
+
+#include <stdint.h>
+
+#define SYNC_TIMER_BASE_KHZ               16000UL  // TIMER base frequency in kHz
+
+#define SYNC_PRESCALER_16MHZ              0UL      // 62.5 ns ticks, 32-bit wrap after ~268 s
+#define SYNC_PRESCALER_1MHZ               4UL      // 1 us ticks, 32-bit wrap after ~71 min
+
+/**
+ * @brief Number of ticks in one ms.
+ */
+#define SYNC_TICKS_PER_MS(prescaler)      (SYNC_TIMER_BASE_KHZ >> (prescaler))
+
+/**
+ * @brief Conversion of a (possibly fractional) time in ms to ticks, rounded to the nearest tick.
+ */
+#define SYNC_MS_TO_TICKS(ms, prescaler)   ((uint32_t)((ms) * SYNC_TICKS_PER_MS(prescaler) + 0.5))
+
+/**
+ * @brief Same as SYNC_MS_TO_TICKS for times that can be negative (delays relative to an event).
+ */
+#define SYNC_MS_TO_TICKS_SIGNED(ms, prescaler) \
+    ((int32_t)((ms) * (int32_t)SYNC_TICKS_PER_MS(prescaler) + (((ms) < 0) ? -0.5 : 0.5)))
+
+/**
+ * @brief Conversion of a time in us known only at runtime (received from the transmitter) to ticks.
+ */
+#define SYNC_US_TO_TICKS(us, prescaler)   ((uint32_t)(((uint64_t)(us) * SYNC_TICKS_PER_MS(prescaler)) / 1000))
+
+/**
+ * @brief Conversion of ticks to ns, for reporting.
+ */
+#define SYNC_TICKS_TO_NS(ticks, prescaler) ((int32_t)(((int64_t)(ticks) * 1000000) / (int32_t)SYNC_TICKS_PER_MS(prescaler)))
+
+/**
+ * @brief Check that a whole number of ms fits in a 32-bit compare register.
+ * Meant to be used in #if, so ms must be an integer constant.
+ */
+#define SYNC_TICKS_FIT_32BIT(ms, prescaler) (((ms) * SYNC_TICKS_PER_MS(prescaler)) <= 0xFFFFFFFFUL)
+
+#define SYNC_RTC_BASE_HZ                  32768UL  // RTC (LFCLK) frequency with PRESCALER = 0
+#define SYNC_RTC_COUNTER_MASK             0xFFFFFFUL   // the RTC counter is 24 bits
+
+#define SYNC_RADIO_RAMPUP_DEFAULT_MS      0.140    // TXEN/RXEN to EVENTS_READY with MODECNF0.RU = Default
+#define SYNC_RADIO_RAMPUP_FAST_MS         0.040    // TXEN/RXEN to EVENTS_READY with MODECNF0.RU = Fast
+
+#endif // SYNC_TIMING_H
+
+/**
+ *@}
+ **/
@@ -0,0 +1,108 @@
+/** @file
+*
+* @defgroup nrf-sync_common_trigger_impl sync_trigger.c
+* @{
+* @ingroup nrf-sync_common
+* @brief Address trigger links and model implementation.
+*
+*/
+
+#include "sync_trigger.h"
+
+const sync_trigger_link_t sync_trigger_links[SYNC_TRIGGER_LINKS] = {
+    {  0, SYNC_TRIGGER_EVENT_ADDRESS,  SYNC_TRIGGER_TASK_START,        SYNC_TRIGGER_TASK_TRIGGER_EN },
+    {  1, SYNC_TRIGGER_EVENT_FALL,     SYNC_TRIGGER_TASK_CLR,          SYNC_TRIGGER_TASK_CANCEL_EN  },
+    {  5, SYNC_TRIGGER_EVENT_RISE,     SYNC_TRIGGER_TASK_SET,          SYNC_TRIGGER_TASK_PULSE_DIS  },
+    {  6, SYNC_TRIGGER_EVENT_CRCERROR, SYNC_TRIGGER_TASK_TRIGGER_DIS,  SYNC_TRIGGER_TASK_STOP       },
+    {  7, SYNC_TRIGGER_EVENT_CRCERROR, SYNC_TRIGGER_TASK_CLEAR,        SYNC_TRIGGER_TASK_CLR        },
+    {  9, SYNC_TRIGGER_EVENT_CRCERROR, SYNC_TRIGGER_TASK_PULSE_EN,     SYNC_TRIGGER_TASK_NONE       },
+    { 13, SYNC_TRIGGER_EVENT_CRCOK,    SYNC_TRIGGER_TASK_CANCEL_DIS,   SYNC_TRIGGER_TASK_NONE       },
+};
+
+/**
+ * @brief Function for applying one task to the model.
+ */
+static void task_apply(sync_trigger_t *trigger, sync_trigger_task_t task) {
+    switch (task) {
+        case SYNC_TRIGGER_TASK_START:
+            trigger->running = true;
+            break;
+        case SYNC_TRIGGER_TASK_STOP:
+            trigger->running = false;
+            break;
+        case SYNC_TRIGGER_TASK_CLEAR:
+            trigger->counter = 0;
+            break;
+        case SYNC_TRIGGER_TASK_SET:
+            trigger->pin = true;
+            break;
+        case SYNC_TRIGGER_TASK_CLR:
+            trigger->pin = false;
+            break;
+        case SYNC_TRIGGER_TASK_TRIGGER_EN:
+            trigger->chen |= SYNC_TRIGGER_GROUP_TRIGGER;
+            break;
+        case SYNC_TRIGGER_TASK_TRIGGER_DIS:
+            trigger->chen &= ~(uint32_t)SYNC_TRIGGER_GROUP_TRIGGER;
+            break;
+        case SYNC_TRIGGER_TASK_PULSE_EN:
+            trigger->chen |= SYNC_TRIGGER_GROUP_PULSE;
+            break;
+        case SYNC_TRIGGER_TASK_PULSE_DIS:
+            trigger->chen &= ~(uint32_t)SYNC_TRIGGER_GROUP_PULSE;
+            break;
+        case SYNC_TRIGGER_TASK_CANCEL_EN:
+            trigger->chen |= SYNC_TRIGGER_GROUP_CANCEL;
+            break;
+        case SYNC_TRIGGER_TASK_CANCEL_DIS:
+            trigger->chen &= ~(uint32_t)SYNC_TRIGGER_GROUP_CANCEL;
+            break;
+        case SYNC_TRIGGER_TASK_NONE:
+        default:
+            break;
+    }
+}
+
+void sync_trigger_init(sync_trigger_t *trigger, uint32_t rise, uint32_t fall) {
+    trigger->chen    = SYNC_TRIGGER_CHANNELS;
+    trigger->counter = 0;
+    trigger->rise    = rise;
+    trigger->fall    = fall;
+    trigger->running = false;
+    trigger->pin     = false;
+}
+
+void sync_trigger_event(sync_trigger_t *trigger, sync_trigger_event_t event) {
+    // every channel listening to the event fires, whatever the others do to the groups
+    uint32_t chen = trigger->chen;
+
+    for (uint32_t i = 0; i < SYNC_TRIGGER_LINKS; i++) {
+        const sync_trigger_link_t *link = &sync_trigger_links[i];
+
+        if (link->event == event && (chen & (1UL << link->channel))) {
+            task_apply(trigger, link->task);
+            task_apply(trigger, link->fork);
+        }
+    }
+}
+
+void sync_trigger_tick(sync_trigger_t *trigger, uint32_t ticks) {
+
+    for (uint32_t i = 0; i < ticks && trigger->running; i++) {
+        trigger->counter++;
+
+        if (trigger->counter == trigger->rise) {
+            sync_trigger_event(trigger, SYNC_TRIGGER_EVENT_RISE);
+        }
+        if (trigger->counter == trigger->fall) {
+            // shortcuts COMPARE0_CLEAR and COMPARE0_STOP
+            trigger->counter = 0;
+            trigger->running = false;
+            sync_trigger_event(trigger, SYNC_TRIGGER_EVENT_FALL);
+        }
+    }
+}
+
+/**
+ *@}
+ **/
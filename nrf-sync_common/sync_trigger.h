@@ -0,0 +1,110 @@
+/** @file
+*
+* @defgroup nrf-sync_common_trigger sync_trigger.h
+* @{
+* @ingroup nrf-sync_common
+* @brief PPI links of the receiver address trigger, with a model to check them.
+*
+* With the address trigger the receiver starts TIMER0 on EVENTS_ADDRESS. The
+* timer sets the pin after the trigger delay (COMPARE[1]) and clears it after
+* the pulse (COMPARE[0], which also clears and stops the timer by shortcut).
+* The rising edge comes before the CRC, so EVENTS_CRCERROR has to cancel the
+* pulse even if the pin is already high, while a later packet must neither
+* restart nor cut a pulse whose CRC was good. Three channel groups do this:
+*
+*     group    channels               disabled by      enabled by
+*     trigger  rising edge            cancel           address
+*     pulse    start                  rising edge      cancel
+*     cancel   start and cancel       CRCOK            falling edge
+*
+* The receiver writes sync_trigger_links into PPI as they are, with these
+* group masks. sync_trigger_event() and sync_trigger_tick() apply the same
+* links to a model of TIMER0, the pin and the enabled channels, so the arm and
+* cancel sequencing can be checked on a host.
+*
+* This module does not touch any peripheral so it can also be built on a host.
+*
+*/
+
+#ifndef SYNC_TRIGGER_H
+#define SYNC_TRIGGER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SYNC_TRIGGER_LINKS           7      // entries of sync_trigger_links
+
+#define SYNC_TRIGGER_GROUP_TRIGGER   (1UL << 5)
+#define SYNC_TRIGGER_GROUP_PULSE     (1UL << 0)
+#define SYNC_TRIGGER_GROUP_CANCEL    ((1UL << 0) | (1UL << 6) | (1UL << 7) | (1UL << 9))
+
+// channels enabled at startup: every link except the rising edge, which is armed by the address
+#define SYNC_TRIGGER_CHANNELS        ((1UL << 0) | (1UL << 1) | (1UL << 6) | (1UL << 7) | (1UL << 9) | (1UL << 13))
+
+typedef enum {
+    SYNC_TRIGGER_EVENT_ADDRESS,             // RADIO EVENTS_ADDRESS
+    SYNC_TRIGGER_EVENT_CRCOK,               // RADIO EVENTS_CRCOK
+    SYNC_TRIGGER_EVENT_CRCERROR,            // RADIO EVENTS_CRCERROR
+    SYNC_TRIGGER_EVENT_RISE,                // TIMER0 EVENTS_COMPARE[1]
+    SYNC_TRIGGER_EVENT_FALL                 // TIMER0 EVENTS_COMPARE[0]
+} sync_trigger_event_t;
+
+typedef enum {
+    SYNC_TRIGGER_TASK_NONE,                 // no fork
+    SYNC_TRIGGER_TASK_START,                // TIMER0 TASKS_START
+    SYNC_TRIGGER_TASK_STOP,                 // TIMER0 TASKS_STOP
+    SYNC_TRIGGER_TASK_CLEAR,                // TIMER0 TASKS_CLEAR
+    SYNC_TRIGGER_TASK_SET,                  // GPIOTE TASKS_SET
+    SYNC_TRIGGER_TASK_CLR,                  // GPIOTE TASKS_CLR
+    SYNC_TRIGGER_TASK_TRIGGER_EN,           // PPI TASKS_CHG[trigger].EN
+    SYNC_TRIGGER_TASK_TRIGGER_DIS,          // PPI TASKS_CHG[trigger].DIS
+    SYNC_TRIGGER_TASK_PULSE_EN,             // PPI TASKS_CHG[pulse].EN
+    SYNC_TRIGGER_TASK_PULSE_DIS,            // PPI TASKS_CHG[pulse].DIS
+    SYNC_TRIGGER_TASK_CANCEL_EN,            // PPI TASKS_CHG[cancel].EN
+    SYNC_TRIGGER_TASK_CANCEL_DIS            // PPI TASKS_CHG[cancel].DIS
+} sync_trigger_task_t;
+
+/**
+ * @brief One PPI channel: its event, task and fork task.
+ */
+typedef struct {
+    uint8_t              channel;
+    sync_trigger_event_t event;
+    sync_trigger_task_t  task;
+    sync_trigger_task_t  fork;
+} sync_trigger_link_t;
+
+/**
+ * @brief Model state, times in TIMER0 ticks.
+ */
+typedef struct {
+    uint32_t chen;              // enabled channels, bit n for PPI channel n
+    uint32_t counter;           // TIMER0 counter
+    uint32_t rise;              // TIMER0 CC[1], trigger delay
+    uint32_t fall;              // TIMER0 CC[0], trigger delay plus pulse width
+    bool     running;           // TIMER0 started
+    bool     pin;               // output level
+} sync_trigger_t;
+
+extern const sync_trigger_link_t sync_trigger_links[SYNC_TRIGGER_LINKS];
+
+/**
+ * @brief Function for resetting the model to the state ppi_setup() leaves: pin low, timer stopped.
+ */
+void sync_trigger_init(sync_trigger_t *trigger, uint32_t rise, uint32_t fall);
+
+/**
+ * @brief Function for signalling an event: the tasks of every enabled channel listening to it are applied.
+ */
+void sync_trigger_event(sync_trigger_t *trigger, sync_trigger_event_t event);
+
+/**
+ * @brief Function for letting ticks timer ticks elapse, signalling the compare events on the way.
+ */
+void sync_trigger_tick(sync_trigger_t *trigger, uint32_t ticks);
+
+#endif // SYNC_TRIGGER_H
+
+/**
+ *@}
+ **/
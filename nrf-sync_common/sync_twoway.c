@@ -0,0 +1,108 @@
+/** @file
+*
+* @defgroup nrf-sync_common_twoway_impl sync_twoway.c
+* @{
+* @ingroup nrf-sync_common
+* @brief Two-way time transfer implementation.
+*
+*/
+
+#include "sync_twoway.h"
+
+/**
+ * @brief Function for dividing a signed sum by a count, rounded to the nearest.
+ */
+static int64_t div_round(int64_t sum, uint32_t count) {
+    return (sum >= 0) ? (sum + count / 2) / count : (sum - (int64_t)(count / 2)) / count;
+}
+
+uint8_t sync_twoway_slot(uint32_t sequence, uint8_t nodes) {
+    return (uint8_t)(sequence % nodes);
+}
+
+void sync_twoway_pack_request(uint8_t *buffer, uint32_t length, uint8_t node, uint32_t sequence) {
+
+    for (uint32_t i = 0; i < length; i++) {
+        buffer[i] = 0;
+    }
+    buffer[0] = SYNC_TWOWAY_MAGIC;
+    buffer[1] = node;
+    buffer[4] = (uint8_t)(sequence);
+    buffer[5] = (uint8_t)(sequence >> 8);
+    buffer[6] = (uint8_t)(sequence >> 16);
+    buffer[7] = (uint8_t)(sequence >> 24);
+}
+
+bool sync_twoway_parse_request(const uint8_t *buffer, uint8_t *node, uint32_t *sequence) {
+
+    if (buffer[0] != SYNC_TWOWAY_MAGIC) {
+        return false;
+    }
+
+    *node     = buffer[1];
+    *sequence =  (uint32_t)buffer[4]        |
+                ((uint32_t)buffer[5] << 8)  |
+                ((uint32_t)buffer[6] << 16) |
+                ((uint32_t)buffer[7] << 24);
+
+    return true;
+}
+
+void sync_twoway_init(sync_twoway_t *twoway) {
+    twoway->delay_sum = 0;
+    twoway->delay_min = 0;
+    twoway->delay_max = 0;
+    twoway->samples   = 0;
+    twoway->rejected  = 0;
+}
+
+bool sync_twoway_add(sync_twoway_t *twoway, uint32_t reply, uint32_t turnaround, int32_t drift_ppb) {
+    // turnaround on the transmitter clock: a faster receiver clock counts too many ns
+    int64_t turnaround_tx = (int64_t)turnaround - ((int64_t)turnaround * drift_ppb) / 1000000000;
+    int64_t round_trip    = (int64_t)reply - turnaround_tx;
+
+    if (round_trip < 0) {
+        twoway->rejected++;
+        return false;
+    }
+
+    int32_t delay = (int32_t)(round_trip / 2);
+
+    if (twoway->samples == 0 || delay < twoway->delay_min) {
+        twoway->delay_min = delay;
+    }
+    if (twoway->samples == 0 || delay > twoway->delay_max) {
+        twoway->delay_max = delay;
+    }
+    twoway->delay_sum += delay;
+    twoway->samples++;
+
+    return true;
+}
+
+bool sync_twoway_delay(const sync_twoway_t *twoway, uint32_t min_samples, int32_t *delay) {
+
+    if (twoway->samples == 0 || twoway->samples < min_samples) {
+        return false;
+    }
+
+    *delay = (int32_t)div_round(twoway->delay_sum, twoway->samples);
+
+    return true;
+}
+
+bool sync_twoway_edge(int32_t delay, int32_t nominal, uint32_t headroom, uint32_t *edge) {
+    int64_t time = (int64_t)headroom + nominal - delay;
+
+    if (time < 0) {
+        *edge = 0;
+        return false;
+    }
+
+    *edge = (uint32_t)time;
+    return true;
+}
+
+/**
+ *@}
+ **/
@@ -0,0 +1,112 @@
+/** @file
+*
+* @defgroup nrf-sync_common_twoway sync_twoway.h
+* @{
+* @ingroup nrf-sync_common
+* @brief Two-way time transfer between the transmitter and each receiver.
+*
+* The offset of the transmitter assumes the same delay for every receiver.
+* Two-way exchanges measure it for each one, the way PTP measures the path
+* delay. Every beacon opens a slot for one node (receiver), in turn. That node
+* sends a request a fixed time after the beacon, and the next beacon carries
+* the response:
+*
+*     t1  transmitter: address of the beacon sent
+*     t2  receiver:    CRCOK of the beacon
+*     t3  receiver:    address of the request sent
+*     t4  transmitter: CRCOK of the request
+*
+* Both directions go from an address sent to a CRCOK received, with packets of
+* the same length, so the delay of one direction is half the round trip:
+*
+*     delay = ((t4 - t1) - (t3 - t2)) / 2
+*
+* t4 - t1 is measured on the transmitter clock (the reply time of the
+* response), t3 - t2 on the receiver clock (the turnaround), which is brought
+* to the transmitter clock with the crystal offset of the receiver. As with PTP,
+* a difference between the directions, such as two radios with different
+* receive chain delays, splits evenly between them.
+*
+* The transmitter delays its rising edge by a headroom. A receiver sets its
+* rising edge that headroom after the beacon, plus the nominal delay of the PHY
+* model minus the measured one. Nearer or faster receivers wait longer, and they
+* all go high with the transmitter.
+*
+* The request is a short frame, padded with zeros to the length of the beacon:
+*
+*     offset  size  field
+*     0       1     magic (SYNC_TWOWAY_MAGIC)
+*     1       1     node
+*     2       2     0
+*     4       4     sequence number of the beacon answered
+*
+* This module does not touch any peripheral so it can also be built on a host.
+*
+*/
+
+#ifndef SYNC_TWOWAY_H
+#define SYNC_TWOWAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SYNC_TWOWAY_MAGIC            43     // first byte of every request
+#define SYNC_TWOWAY_MAX_NODES        255    // node SYNC_BEACON_NO_REPLY is reserved
+
+/**
+ * @brief Delay measurement state, all values in ns on the transmitter clock.
+ */
+typedef struct {
+    int64_t  delay_sum;         // sum of the accepted one-way delays
+    int32_t  delay_min;
+    int32_t  delay_max;
+    uint32_t samples;           // number of accepted exchanges
+    uint32_t rejected;          // number of exchanges with a round trip below 0
+} sync_twoway_t;
+
+/**
+ * @brief Function for getting the node whose slot follows beacon number sequence.
+ */
+uint8_t sync_twoway_slot(uint32_t sequence, uint8_t nodes);
+
+/**
+ * @brief Function for writing a request in a radio buffer of length bytes.
+ */
+void sync_twoway_pack_request(uint8_t *buffer, uint32_t length, uint8_t node, uint32_t sequence);
+
+/**
+ * @brief Function for reading a request from a radio buffer.
+ * Returns false if the buffer does not hold a request.
+ */
+bool sync_twoway_parse_request(const uint8_t *buffer, uint8_t *node, uint32_t *sequence);
+
+/**
+ * @brief Function for clearing all the exchanges.
+ */
+void sync_twoway_init(sync_twoway_t *twoway);
+
+/**
+ * @brief Function for adding one exchange.
+ * reply is t4 - t1 in ns on the transmitter clock, turnaround t3 - t2 in ns on the receiver clock, and
+ * drift_ppb how much faster the receiver clock runs, in parts per billion.
+ */
+bool sync_twoway_add(sync_twoway_t *twoway, uint32_t reply, uint32_t turnaround, int32_t drift_ppb);
+
+/**
+ * @brief Function for getting the averaged one-way delay in ns.
+ * Returns false until at least min_samples exchanges were accepted.
+ */
+bool sync_twoway_delay(const sync_twoway_t *twoway, uint32_t min_samples, int32_t *delay);
+
+/**
+ * @brief Function for getting the time in ns from the beacon CRCOK to the rising edge of a receiver.
+ * nominal is the delay the transmitter offset assumes, headroom the time the transmitter adds to it.
+ * Returns false, with edge 0, if the measured delay is longer than both.
+ */
+bool sync_twoway_edge(int32_t delay, int32_t nominal, uint32_t headroom, uint32_t *edge);
+
+#endif // SYNC_TWOWAY_H
+
+/**
+ *@}
+ **/
@@ -0,0 +1,91 @@
+/** @file
+*
+* @defgroup nrf-sync_common_window_impl sync_window.c
+* @{
+* @ingroup nrf-sync_common
+* @brief Receive window implementation.
+*
+*/
+
+#include "sync_window.h"
+
+#define ONE     (1ULL << SYNC_WINDOW_FRAC_BITS)
+#define HALF    (ONE >> 1)
+
+void sync_window_init(sync_window_t *window, uint32_t nominal_period, uint32_t lead, uint32_t guard_min,
+                      uint32_t guard_max, uint32_t max_misses) {
+    window->period      = (uint64_t)nominal_period << SYNC_WINDOW_FRAC_BITS;
+    window->lead        = lead;
+    window->guard_min   = guard_min;
+    window->guard_max   = guard_max;
+    window->max_misses  = max_misses;
+    window->last_beacon = 0;
+    window->beacons     = 0;
+    window->misses      = 0;
+}
+
+void sync_window_beacon(sync_window_t *window, uint32_t timestamp) {
+
+    if (window->beacons > 0) {
+        uint32_t elapsed = timestamp - window->last_beacon;
+        uint32_t n       = window->misses + 1;
+
+        // a beacon only arrives inside a window, so it is the one n periods after the last
+        uint64_t measured = ((uint64_t)elapsed << SYNC_WINDOW_FRAC_BITS) / n;
+        if (window->beacons == 1) {
+            window->period = measured;
+        } else if (measured >= window->period) {
+            window->period += (measured - window->period) >> SYNC_WINDOW_PERIOD_SHIFT;
+        } else {
+            window->period -= (window->period - measured) >> SYNC_WINDOW_PERIOD_SHIFT;
+        }
+    }
+
+    window->beacons++;
+    window->last_beacon = timestamp;
+    window->misses      = 0;
+}
+
+void sync_window_missed(sync_window_t *window) {
+
+    window->misses++;
+
+    if (window->misses >= window->max_misses) {
+        // back to searching, the period is kept as the next first guess
+        window->beacons = 0;
+        window->misses  = 0;
+    }
+}
+
+uint32_t sync_window_guard(const sync_window_t *window) {
+    uint64_t guard = (uint64_t)window->guard_min * (window->misses + 1);
+
+    return (guard > window->guard_max) ? window->guard_max : (uint32_t)guard;
+}
+
+bool sync_window_next(const sync_window_t *window, uint32_t *open, uint32_t *close) {
+
+    if (window->beacons == 0) {
+        return false;
+    }
+
+    uint32_t period = (uint32_t)((window->period + HALF) >> SYNC_WINDOW_FRAC_BITS);
+    uint32_t guard  = sync_window_guard(window);
+
+    // a window this wide would overlap the next one, listen continuously instead
+    if ((uint64_t)window->lead + 2 * (uint64_t)guard >= period) {
+        return false;
+    }
+
+    uint32_t expected = window->last_beacon +
+                        (uint32_t)((window->period * (window->misses + 1) + HALF) >> SYNC_WINDOW_FRAC_BITS);
+
+    *open  = expected - window->lead - guard;
+    *close = expected + guard;
+
+    return true;
+}
+
+/**
+ *@}
+ **/
@@ -0,0 +1,81 @@
+/** @file
+*
+* @defgroup nrf-sync_common_window sync_window.h
+* @{
+* @ingroup nrf-sync_common
+* @brief Receive window prediction for the windowed receiver.
+*
+* Instead of listening for a whole period, the receiver only enables the radio
+* in a window around the time the next beacon is expected. From the timestamp
+* of the last beacon (EVENTS_CRCOK) and the period learned from consecutive
+* beacons, the window opens lead + guard ticks before the expected CRCOK
+* (lead covers the radio ramp-up and the frame airtime) and closes guard ticks
+* after it.
+*
+* Every missed beacon widens the guard by guard_min, since the prediction
+* error grows with the time since the last beacon, up to guard_max. After
+* max_misses in a row, or when the window would cover the whole period, the
+* window is given up and the receiver has to listen continuously until the
+* next beacon.
+*
+* All times are 32-bit timer values, differences are taken modulo 2^32.
+*
+* This module does not touch any peripheral so it can also be built on a host.
+*
+*/
+
+#ifndef SYNC_WINDOW_H
+#define SYNC_WINDOW_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SYNC_WINDOW_FRAC_BITS        8      // fractional bits of the learned period
+#define SYNC_WINDOW_PERIOD_SHIFT     3      // period filter gain is 1 / 2^SHIFT
+
+/**
+ * @brief Window state.
+ */
+typedef struct {
+    uint64_t period;            // learned period in 1 / 2^SYNC_WINDOW_FRAC_BITS ticks
+    uint32_t lead;              // ticks from the radio enable to the CRCOK of a beacon on time
+    uint32_t guard_min;         // guard after a beacon, and widening step per missed beacon
+    uint32_t guard_max;         // widest guard
+    uint32_t max_misses;        // missed beacons in a row before the window is given up
+    uint32_t last_beacon;       // timestamp of the last beacon
+    uint32_t beacons;           // beacons received in windows since the last search, 0 while searching
+    uint32_t misses;            // beacons missed since the last one
+} sync_window_t;
+
+/**
+ * @brief Function for initializing the window (search mode, no beacon yet).
+ */
+void sync_window_init(sync_window_t *window, uint32_t nominal_period, uint32_t lead, uint32_t guard_min,
+                      uint32_t guard_max, uint32_t max_misses);
+
+/**
+ * @brief Function for feeding the timestamp of a received beacon.
+ */
+void sync_window_beacon(sync_window_t *window, uint32_t timestamp);
+
+/**
+ * @brief Function for telling that a window closed without a beacon.
+ */
+void sync_window_missed(sync_window_t *window);
+
+/**
+ * @brief Function for getting the next window.
+ * Returns false if there is none and the receiver has to listen continuously.
+ */
+bool sync_window_next(const sync_window_t *window, uint32_t *open, uint32_t *close);
+
+/**
+ * @brief Function for getting the current guard in ticks.
+ */
+uint32_t sync_window_guard(const sync_window_t *window);
+
+#endif // SYNC_WINDOW_H
+
+/**
+ *@}
+ **/
@@ -0,0 +1,50 @@
+/** @file
+*
+* @defgroup nrf-sync_common_test test.h
+* @{
+* @ingroup nrf-sync_common
+* @brief Checks shared by the host tests of the common modules.
+*
+* Every test is a program of its own: it runs its checks, prints the failed
+* ones and returns non-zero if there was any (see the Makefile).
+*
+*/
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+static int test_failures;
+
+/**
+ * @brief Check of a condition, the test goes on if it fails.
+ */
+#define CHECK(cond)                                                               \
+    do {                                                                          \
+        if (!(cond)) {                                                            \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);       \
+            test_failures++;                                                      \
+        }                                                                         \
+    } while (0)
+
+/**
+ * @brief Result of the test, to return from main().
+ */
+#define TEST_RESULT()                                                             \
+    (printf("%s: %s\n", __FILE__, test_failures ? "FAILED" : "ok"), test_failures != 0)
+
+/**
+ * @brief Function for drawing a pseudo-random number from 0 to 32767, the same sequence on every host.
+ */
+static inline uint32_t test_rand(uint32_t *seed) {
+    *seed = *seed * 1103515245U + 12345U;
+    return (*seed >> 16) & 0x7FFFU;
+}
+
+#endif // TEST_H
+
+/**
+ *@}
+ **/
@@ -0,0 +1,240 @@
+/** @file
+*
+* @brief Host tests of sync_beacon.c: pack and parse round trips over random beacons, the byte layout of the
+* format, the rejected payloads and the announced switches across the sequence number wrap.
+*
+*/
+
+#include <string.h>
+
+#include "sync_beacon.h"
+#include "test.h"
+
+#define ROUNDS               100000
+
+static uint32_t rand32(uint32_t *seed) {
+    return (test_rand(seed) << 17) ^ (test_rand(seed) << 2) ^ test_rand(seed);
+}
+
+/**
+ * @brief Function for drawing a beacon parse accepts: usable schedules, copy below copies.
+ */
+static void random_beacon(sync_beacon_t *beacon, uint32_t *seed) {
+    beacon->sequence         = rand32(seed);
+    beacon->period_us        = rand32(seed) | 2;
+    beacon->width_us         = 1 + rand32(seed) % (beacon->period_us - 1);
+    beacon->timestamp        = rand32(seed);
+    beacon->prescaler        = (uint8_t)(test_rand(seed) % (SYNC_PRESCALER_1MHZ + 1));
+    beacon->copies           = (uint8_t)(1 + test_rand(seed) % 16);
+    beacon->copy             = (uint8_t)(test_rand(seed) % beacon->copies);
+    beacon->next_period_us   = rand32(seed) | 2;
+    beacon->next_width_us    = 1 + rand32(seed) % (beacon->next_period_us - 1);
+    beacon->switch_sequence  = rand32(seed);
+    beacon->channel_map      = rand32(seed);
+    beacon->next_channel_map = rand32(seed);
+    beacon->channel_switch   = rand32(seed);
+    beacon->reply_time       = rand32(seed) & SYNC_BEACON_REPLY_MAX;
+    beacon->reply_node       = (uint8_t)test_rand(seed);
+}
+
+static void check_equal(const sync_beacon_t *a, const sync_beacon_t *b) {
+    CHECK(a->sequence == b->sequence);
+    CHECK(a->period_us == b->period_us);
+    CHECK(a->width_us == b->width_us);
+    CHECK(a->timestamp == b->timestamp);
+    CHECK(a->prescaler == b->prescaler);
+    CHECK(a->copy == b->copy);
+    CHECK(a->copies == b->copies);
+    CHECK(a->next_period_us == b->next_period_us);
+    CHECK(a->next_width_us == b->next_width_us);
+    CHECK(a->switch_sequence == b->switch_sequence);
+    CHECK(a->channel_map == b->channel_map);
+    CHECK(a->next_channel_map == b->next_channel_map);
+    CHECK(a->channel_switch == b->channel_switch);
+    CHECK(a->reply_time == b->reply_time);
+    CHECK(a->reply_node == b->reply_node);
+}
+
+static void test_round_trip() {
+    uint8_t       buffer[SYNC_BEACON_LENGTH];
+    uint8_t       copy[SYNC_BEACON_LENGTH];
+    sync_beacon_t beacon;
+    sync_beacon_t parsed;
+    uint32_t      seed = 3;
+
+    for (uint32_t i = 0; i < ROUNDS; i++) {
+        random_beacon(&beacon, &seed);
+        sync_beacon_pack(buffer, &beacon);
+
+        CHECK(sync_beacon_parse(buffer, &parsed));
+        check_equal(&beacon, &parsed);
+
+        // a copy only differs by its index
+        uint8_t index = (uint8_t)(test_rand(&seed) % beacon.copies);
+        sync_beacon_copy(copy, buffer, index);
+        CHECK(sync_beacon_parse(copy, &parsed));
+        CHECK(parsed.copy == index);
+        parsed.copy = beacon.copy;
+        check_equal(&beacon, &parsed);
+    }
+}
+
+static void test_layout() {
+    uint8_t       buffer[SYNC_BEACON_LENGTH];
+    sync_beacon_t beacon = {
+        .sequence         = 0x04030201UL,
+        .period_us        = 0x08070605UL,
+        .width_us         = 0x00000A09UL,
+        .timestamp        = 0x100F0E0DUL,
+        .prescaler        = SYNC_PRESCALER_1MHZ,
+        .copy             = 2,
+        .copies           = 3,
+        .next_period_us   = 0x18171615UL,
+        .next_width_us    = 0x00001A19UL,
+        .switch_sequence  = 0x201F1E1DUL,
+        .channel_map      = 0x24232221UL,
+        .next_channel_map = 0x28272625UL,
+        .channel_switch   = 0x2C2B2A29UL,
+        .reply_time       = 0xFF2F2E2DUL,      // the top byte does not fit and is dropped
+        .reply_node       = 0x30,
+    };
+    const uint8_t expected[SYNC_BEACON_LENGTH] = {
+        SYNC_BEACON_MAGIC, SYNC_BEACON_VERSION, SYNC_PRESCALER_1MHZ, 0x22,
+        0x01, 0x02, 0x03, 0x04,  0x05, 0x06, 0x07, 0x08,  0x09, 0x0A, 0x00, 0x00,  0x0D, 0x0E, 0x0F, 0x10,
+        0x15, 0x16, 0x17, 0x18,  0x19, 0x1A, 0x00, 0x00,  0x1D, 0x1E, 0x1F, 0x20,  0x21, 0x22, 0x23, 0x24,
+        0x25, 0x26, 0x27, 0x28,  0x29, 0x2A, 0x2B, 0x2C,  0x2D, 0x2E, 0x2F, 0x30,
+    };
+
+    memset(buffer, 0xAA, sizeof(buffer));
+    sync_beacon_pack(buffer, &beacon);
+    CHECK(memcmp(buffer, expected, SYNC_BEACON_LENGTH) == 0);
+}
+
+static void test_reject() {
+    uint8_t       buffer[SYNC_BEACON_LENGTH];
+    sync_beacon_t beacon;
+    sync_beacon_t parsed;
+    uint32_t      seed = 5;
+
+    random_beacon(&beacon, &seed);
+    beacon.sequence        = 100;
+    beacon.switch_sequence = 100;           // no pending change
+    beacon.copy            = 0;
+    beacon.copies          = 1;
+    sync_beacon_pack(buffer, &beacon);
+    CHECK(sync_beacon_parse(buffer, &parsed));
+
+    // magic, version and prescaler
+    buffer[0]++;
+    CHECK(!sync_beacon_parse(buffer, &parsed));
+    buffer[0]--;
+    buffer[1]--;
+    CHECK(!sync_beacon_parse(buffer, &parsed));
+    buffer[1]++;
+    buffer[2] = SYNC_PRESCALER_1MHZ + 1;
+    CHECK(!sync_beacon_parse(buffer, &parsed));
+
+    // copy index beyond the burst
+    random_beacon(&beacon, &seed);
+    beacon.copies = 2;
+    beacon.copy   = 2;
+    sync_beacon_pack(buffer, &beacon);
+    CHECK(!sync_beacon_parse(buffer, &parsed));
+
+    // unusable schedules
+    random_beacon(&beacon, &seed);
+    beacon.width_us = 0;
+    sync_beacon_pack(buffer, &beacon);
+    CHECK(!sync_beacon_parse(buffer, &parsed));
+    beacon.width_us = beacon.period_us;
+    sync_beacon_pack(buffer, &beacon);
+    CHECK(!sync_beacon_parse(buffer, &parsed));
+
+    // the next schedule is only checked while it is pending
+    random_beacon(&beacon, &seed);
+    beacon.next_width_us   = 0;
+    beacon.switch_sequence = beacon.sequence + 1;
+    sync_beacon_pack(buffer, &beacon);
+    CHECK(!sync_beacon_parse(buffer, &parsed));
+    beacon.switch_sequence = beacon.sequence;
+    sync_beacon_pack(buffer, &beacon);
+    CHECK(sync_beacon_parse(buffer, &parsed));
+}
+
+static void test_switch_wrap() {
+    sync_beacon_t beacon;
+    uint32_t      seed = 9;
+    uint32_t      period;
+    uint32_t      width;
+
+    random_beacon(&beacon, &seed);
+    beacon.period_us       = 1000;
+    beacon.width_us        = 10;
+    beacon.next_period_us  = 2000;
+    beacon.next_width_us   = 20;
+    beacon.sequence        = 0xFFFFFFFEUL;
+    beacon.switch_sequence = 2;             // after the wrap
+    beacon.channel_map      = 0x1;
+    beacon.next_channel_map = 0x2;
+    beacon.channel_switch   = 1;
+
+    CHECK(sync_beacon_pending(&beacon));
+    sync_beacon_schedule(&beacon, 0xFFFFFFFFUL, &period, &width);
+    CHECK(period == 1000 && width == 10);
+    sync_beacon_schedule(&beacon, 1, &period, &width);
+    CHECK(period == 1000 && width == 10);
+    sync_beacon_schedule(&beacon, 2, &period, &width);
+    CHECK(period == 2000 && width == 20);
+    CHECK(sync_beacon_channel_map(&beacon, 0) == 0x1);
+    CHECK(sync_beacon_channel_map(&beacon, 1) == 0x2);
+
+    // a switch in the past is no longer pending
+    beacon.sequence = 3;
+    CHECK(!sync_beacon_pending(&beacon));
+    sync_beacon_schedule(&beacon, 3, &period, &width);
+    CHECK(period == 1000 && width == 10);
+    CHECK(sync_beacon_channel_map(&beacon, 4) == 0x1);
+}
+
+static void test_stats() {
+    sync_beacon_stats_t stats;
+    sync_beacon_t       beacon = { .prescaler = SYNC_PRESCALER_1MHZ };
+    uint32_t            rx_time = 0xFFFFF000UL;    // receiver timer wraps during the test
+    uint32_t            tx_time = 5000;
+
+    sync_beacon_stats_init(&stats);
+
+    // receiver 10 ppm slow: 999990 of its ticks per transmitter period
+    for (uint32_t seq = 10; seq < 20; seq++) {
+        beacon.sequence  = seq;
+        beacon.timestamp = tx_time - 1000000;       // address time of the beacon before
+        CHECK(sync_beacon_stats_add(&stats, &beacon, rx_time, SYNC_PRESCALER_1MHZ) == 0);
+        rx_time += 999990;
+        tx_time += 1000000;
+    }
+    CHECK(stats.received == 10);
+    CHECK(stats.intervals == 8);
+    CHECK(sync_beacon_stats_interval_mean(&stats) == -10000);
+    CHECK(stats.interval_min == -10000 && stats.interval_max == -10000);
+
+    // three beacons lost
+    beacon.sequence  = 23;
+    CHECK(sync_beacon_stats_add(&stats, &beacon, rx_time, SYNC_PRESCALER_1MHZ) == 3);
+    CHECK(stats.missed == 3);
+
+    // the transmitter restarted
+    beacon.sequence = 0;
+    CHECK(sync_beacon_stats_add(&stats, &beacon, rx_time, SYNC_PRESCALER_1MHZ) == 0);
+    CHECK(stats.restarts == 1);
+    CHECK(stats.intervals == 8);
+}
+
+int main(void) {
+    test_round_trip();
+    test_layout();
+    test_reject();
+    test_switch_wrap();
+    test_stats();
+
+    return TEST_RESULT();
+}
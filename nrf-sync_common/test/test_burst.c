@@ -0,0 +1,115 @@
+/** @file
+*
+* @brief Host tests of sync_burst.c: the delay of each copy, and a sweep of the number of copies through the
+* loss model, checked against a copy by copy simulation of the two-state channel.
+*
+*/
+
+#include <math.h>
+
+#include "sync_burst.h"
+#include "test.h"
+
+#define SPACING              500     // us
+#define MARGIN               100     // us
+#define FRAME                160     // us
+#define BURSTS               2000000UL
+#define SEED                 0xB0257UL
+
+static void test_delay() {
+    for (uint32_t copies = 1; copies <= SYNC_BURST_MAX_COPIES; copies++) {
+        uint32_t edge = sync_burst_delay(copies, SPACING, MARGIN, 0);
+
+        // copy i arrives i spacings after copy 0, the edge is at the same time for all of them
+        for (uint8_t copy = 0; copy < copies; copy++) {
+            CHECK(copy * SPACING + sync_burst_delay(copies, SPACING, MARGIN, copy) == edge);
+        }
+        CHECK(sync_burst_delay(copies, SPACING, MARGIN, (uint8_t)(copies - 1)) == MARGIN);
+    }
+}
+
+/**
+ * @brief Function for drawing true with a probability in parts per billion.
+ */
+static int draw(uint32_t *seed, uint32_t ppb) {
+    uint32_t r = (test_rand(seed) << 15) | test_rand(seed);    // 0 to 2^30 - 1
+
+    return (double)r < (double)ppb * 1073741824.0 / SYNC_BURST_PPB;
+}
+
+/**
+ * @brief Function for simulating bursts of copies copies over the channel, each starting from the steady state.
+ * Returns the fraction of bursts with every copy lost, in parts per billion.
+ */
+static double simulate(const sync_burst_channel_t *channel, uint32_t copies, uint32_t *seed) {
+    uint32_t steady_bad = (uint32_t)((uint64_t)channel->good_to_bad * SYNC_BURST_PPB /
+                                     (channel->good_to_bad + channel->bad_to_good));
+    uint32_t lost = 0;
+
+    for (uint32_t b = 0; b < BURSTS; b++) {
+        int bad      = draw(seed, steady_bad);
+        int all_lost = 1;
+
+        for (uint32_t i = 0; i < copies && all_lost; i++) {
+            if (i != 0) {
+                bad = bad ? !draw(seed, channel->bad_to_good) : draw(seed, channel->good_to_bad);
+            }
+            all_lost = draw(seed, bad ? channel->loss_bad : channel->loss_good);
+        }
+        lost += (uint32_t)all_lost;
+    }
+
+    return (double)lost * SYNC_BURST_PPB / BURSTS;
+}
+
+static void test_independent() {
+    sync_burst_channel_t channel = { .loss_good = 100000000UL, .loss_bad = 0, .good_to_bad = 0, .bad_to_good = 0 };
+    uint32_t             loss    = SYNC_BURST_PPB;
+
+    CHECK(sync_burst_loss(&channel, 0) == SYNC_BURST_PPB);
+
+    // never bad: independent losses of 10 %
+    for (uint32_t copies = 1; copies <= 9; copies++) {
+        loss /= 10;
+        CHECK(sync_burst_loss(&channel, copies) == loss);
+    }
+}
+
+static void test_sweep() {
+    sync_burst_channel_t channel;
+    sync_burst_report_t  report;
+    uint32_t             seed     = SEED;
+    uint32_t             previous = SYNC_BURST_PPB;
+    uint32_t             single;
+
+    sync_burst_default_channel(&channel);
+    single = sync_burst_loss(&channel, 1);
+
+    for (uint32_t copies = 1; copies <= SYNC_BURST_MAX_COPIES; copies++) {
+        sync_burst_evaluate(&channel, copies, SPACING, MARGIN, FRAME, &report);
+        printf("%2u copies: delay %5u us, airtime %5u us, loss %9u ppb\n", report.copies, report.delay,
+               report.airtime, report.loss);
+
+        CHECK(report.copies == copies);
+        CHECK(report.delay == sync_burst_delay(copies, SPACING, MARGIN, 0));
+        CHECK(report.airtime == copies * FRAME);
+
+        // every copy helps, but less than an independent one would: the bad state lasts several copies
+        CHECK(report.loss < previous);
+        CHECK(copies == 1 || report.loss > (uint32_t)(pow((double)single / SYNC_BURST_PPB, copies) * SYNC_BURST_PPB));
+        previous = report.loss;
+
+        // the model agrees with the simulation within 5 standard deviations, or 1 ppm below
+        double simulated = simulate(&channel, copies, &seed);
+        double deviation = sqrt((double)report.loss * SYNC_BURST_PPB / BURSTS);
+        CHECK(fabs(simulated - report.loss) < 5 * deviation + 1000);
+    }
+}
+
+int main(void) {
+    test_delay();
+    test_independent();
+    test_sweep();
+
+    return TEST_RESULT();
+}
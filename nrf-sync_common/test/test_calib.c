@@ -0,0 +1,139 @@
+/** @file
+*
+* @brief Host tests of sync_calib.c, fed with captures as the boards log them at 1 MHz (Ble_1Mbit, 1 byte payload,
+* receiver triggering on CRCOK) and with the corner cases the radio can produce.
+*
+*/
+
+#include "sync_calib.h"
+#include "test.h"
+
+// transmitter: TIMER1 CC[1] (ADDRESS) and CC[2] (END) after the radio start
+static const uint32_t tx_address[] = { 170, 171, 170, 170, 171, 170, 170, 170, 171, 170, 170, 170, 170, 171, 170, 170 };
+static const uint32_t tx_end[]     = { 242, 243, 242, 242, 243, 242, 242, 242, 243, 242, 242, 242, 242, 243, 242, 242 };
+
+// receiver: TIMER1 CC[0] (END) and CC[1] (CRCOK) of a free-running timer
+static const uint32_t rx_end[]     = { 1051877, 2051878, 3051877, 4051878, 5051877, 6051877, 7051878, 8051877 };
+static const uint32_t rx_trigger[] = { 1051877, 2051878, 3051878, 4051878, 5051877, 6051877, 7051878, 8051878 };
+
+#define COUNT(array)         (sizeof(array) / sizeof(array[0]))
+
+static void test_recorded() {
+    sync_calib_t calib;
+    uint32_t     offset;
+    int32_t      delay;
+
+    sync_calib_init(&calib);
+
+    for (uint32_t i = 0; i < COUNT(tx_end); i++) {
+        CHECK(!sync_calib_offset(&calib, COUNT(tx_end), 0, 0, &offset));
+        CHECK(sync_calib_add_tx(&calib, tx_address[i], tx_end[i]));
+    }
+    for (uint32_t i = 0; i < COUNT(rx_end); i++) {
+        CHECK(!sync_calib_rx_trigger_delay(&calib, COUNT(rx_end), &delay));
+        CHECK(sync_calib_add_rx(&calib, rx_end[i], rx_trigger[i]));
+    }
+
+    // 3876 / 16 = 242.25 and 2 / 8 = 0.25 both round down
+    CHECK(sync_calib_rx_trigger_delay(&calib, COUNT(rx_end), &delay));
+    CHECK(delay == 0);
+    CHECK(sync_calib_offset(&calib, COUNT(tx_end), 10, delay, &offset));
+    CHECK(offset == 252);
+    CHECK(calib.rejected == 0);
+
+    // min_samples of 0 still needs one sample
+    sync_calib_init(&calib);
+    CHECK(!sync_calib_offset(&calib, 0, 10, 0, &offset));
+    CHECK(!sync_calib_rx_trigger_delay(&calib, 0, &delay));
+}
+
+static void test_reject() {
+    sync_calib_t calib;
+
+    sync_calib_init(&calib);
+
+    // missed address, missed end (capture cleared to 0) and end before address
+    CHECK(!sync_calib_add_tx(&calib, 0, 242));
+    CHECK(!sync_calib_add_tx(&calib, 170, 0));
+    CHECK(!sync_calib_add_tx(&calib, 242, 170));
+    CHECK(!sync_calib_add_tx(&calib, 170, 170));
+
+    // CRC error on the receiver
+    CHECK(!sync_calib_add_rx(&calib, 1051877, 0));
+    CHECK(!sync_calib_add_rx(&calib, 0, 1051877));
+
+    CHECK(calib.rejected == 6);
+    CHECK(calib.tx_samples == 0);
+    CHECK(calib.rx_samples == 0);
+}
+
+static void test_wrap() {
+    sync_calib_t calib;
+    int32_t      delay;
+
+    sync_calib_init(&calib);
+
+    // the free-running receiver timer wraps between END and the trigger
+    CHECK(sync_calib_add_rx(&calib, 0xFFFFFFF0UL, 0x00000010UL));
+    CHECK(sync_calib_add_rx(&calib, 0xFFFFFFFFUL, 0x0000001FUL));
+    CHECK(sync_calib_rx_trigger_delay(&calib, 2, &delay));
+    CHECK(delay == 32);
+
+    // the address trigger fires before END, the delay is negative
+    sync_calib_init(&calib);
+    CHECK(sync_calib_add_rx(&calib, 0x00000010UL, 0xFFFFFFF0UL));
+    CHECK(sync_calib_add_rx(&calib, 1000, 970));
+    CHECK(sync_calib_add_rx(&calib, 2000, 1970));
+    CHECK(sync_calib_rx_trigger_delay(&calib, 3, &delay));
+    CHECK(delay == -31);      // -94 / 3 = -31.3
+}
+
+static void test_rounding() {
+    sync_calib_t calib;
+    uint32_t     offset;
+    int32_t      delay;
+
+    // halves round away from zero
+    sync_calib_init(&calib);
+    CHECK(sync_calib_add_tx(&calib, 1, 10));
+    CHECK(sync_calib_add_tx(&calib, 1, 11));
+    CHECK(sync_calib_offset(&calib, 2, 0, 0, &offset));
+    CHECK(offset == 11);
+
+    CHECK(sync_calib_add_rx(&calib, 100, 99));
+    CHECK(sync_calib_add_rx(&calib, 100, 98));
+    CHECK(sync_calib_rx_trigger_delay(&calib, 2, &delay));
+    CHECK(delay == -2);
+}
+
+static void test_offset_range() {
+    sync_calib_t calib;
+    uint32_t     offset = 1234;
+
+    sync_calib_init(&calib);
+    CHECK(sync_calib_add_tx(&calib, 170, 242));
+
+    // not positive
+    CHECK(!sync_calib_offset(&calib, 1, 0, -242, &offset));
+    CHECK(!sync_calib_offset(&calib, 1, -100, -200, &offset));
+    CHECK(offset == 1234);
+    CHECK(sync_calib_offset(&calib, 1, 0, -241, &offset));
+    CHECK(offset == 1);
+
+    // above the 32-bit timer
+    sync_calib_init(&calib);
+    CHECK(sync_calib_add_tx(&calib, 1, 0xFFFFFFFFUL));
+    CHECK(sync_calib_offset(&calib, 1, 0, 0, &offset));
+    CHECK(offset == 0xFFFFFFFFUL);
+    CHECK(!sync_calib_offset(&calib, 1, 1, 0, &offset));
+}
+
+int main(void) {
+    test_recorded();
+    test_reject();
+    test_wrap();
+    test_rounding();
+    test_offset_range();
+
+    return TEST_RESULT();
+}
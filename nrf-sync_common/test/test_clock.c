@@ -0,0 +1,99 @@
+/** @file
+*
+* @brief Host tests of sync_clock.c: the cycles of every grid period, and their PWM values played back tick by
+* tick the way PWM1 does in wave form mode, so each cycle rises on its start and the first one on the grid point.
+*
+*/
+
+#include "sync_clock.h"
+#include "test.h"
+
+#define CYCLES               100
+#define PERIODS              50
+#define SEED                 0xC10CUL
+
+/**
+ * @brief Function for getting the output of the PWM at tick t of a cycle playing values in wave form mode,
+ * as in the product specification: bit 15 of the compare set (FallingEdge) is high until the compare then low,
+ * clear (RisingEdge) is low until the compare then high. Literal values, so the module macros are checked too.
+ */
+static bool wave_level(const uint16_t *value, uint32_t t) {
+    uint32_t compare = value[0] & 0x7FFFU;
+
+    if (value[0] & 0x8000U) {
+        return t < compare;
+    }
+    return t >= compare;
+}
+
+/**
+ * @brief Function for playing the clock over PERIODS grid periods of about period ticks, the grid moving by
+ * up to jitter ticks every period, and checking every edge against the grid.
+ */
+static void check_clock(uint32_t period, uint32_t jitter) {
+    sync_clock_t clock;
+    uint32_t     seed  = SEED;
+    bool         level = false;     // idle low before the first grid point
+
+    sync_clock_init(&clock, CYCLES, period);
+
+    for (uint32_t p = 0; p < PERIODS; p++) {
+        uint32_t length = period + test_rand(&seed) % (2 * jitter + 1) - jitter;
+        uint32_t ticks  = 0;
+        uint32_t shortest = 0xFFFFFFFFUL;
+        uint32_t longest  = 0;
+
+        // the grid correction arrives with the first cycle of the period
+        sync_clock_period(&clock, length);
+
+        for (uint32_t c = 0; c < CYCLES; c++) {
+            uint16_t value[SYNC_CLOCK_WAVE_VALUES];
+            uint32_t cycle = sync_clock_next(&clock);
+            uint32_t rises = 0;
+
+            sync_clock_wave(value, cycle);
+            CHECK(value[3] == cycle);
+
+            for (uint32_t t = 0; t < cycle; t++) {
+                bool next = wave_level(value, t);
+
+                if (next && !level) {
+                    // the only rising edge of a cycle is on its start, on the grid point for the first one
+                    CHECK(t == 0);
+                    rises++;
+                }
+                level = next;
+            }
+            CHECK(rises == 1);
+            CHECK(!level);          // low at the end of every cycle
+
+            ticks   += cycle;
+            shortest = cycle < shortest ? cycle : shortest;
+            longest  = cycle > longest ? cycle : longest;
+        }
+
+        // the last cycle ends exactly on the next grid point, and the cycles are even
+        CHECK(ticks == length);
+        CHECK(longest - shortest <= 1);
+    }
+}
+
+static void test_wave() {
+    uint16_t value[SYNC_CLOCK_WAVE_VALUES];
+
+    // 10 ticks: high from 0 to 4, low from 5 to 9
+    sync_clock_wave(value, 10);
+    CHECK(value[0] == (0x8000U | 5));
+    CHECK(value[3] == 10);
+    CHECK(wave_level(value, 0) && wave_level(value, 4));
+    CHECK(!wave_level(value, 5) && !wave_level(value, 9));
+}
+
+int main(void) {
+    test_wave();
+    check_clock(16000, 0);
+    check_clock(16000, 40);
+    check_clock(SYNC_CLOCK_MIN_LENGTH * CYCLES + 7, 0);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,222 @@
+/** @file
+*
+* @brief Host tests of sync_command.c: the frame round trip, the CRC check and the resynchronization
+* of the parser, and the range checks of the schedule.
+*
+*/
+
+#include "sync_command.h"
+#include "test.h"
+
+#define MARGIN               20
+#define MAX                  1000000
+#define PERIOD               10000
+#define WIDTH                100
+#define OFFSET               500
+#define CHANNELS             0x0003
+
+static uint32_t rand32(uint32_t *seed) {
+    return (test_rand(seed) << 17) ^ (test_rand(seed) << 2) ^ test_rand(seed);
+}
+
+static sync_command_parse_t feed(sync_command_parser_t *parser, const uint8_t *buffer, uint8_t length,
+                                 sync_command_t *command) {
+    sync_command_parse_t result = SYNC_COMMAND_PARSE_NONE;
+
+    for (uint8_t i = 0; i < length; i++) {
+        result = sync_command_parse(parser, buffer[i], command);
+
+        // nothing before the last byte of a frame
+        if (i < length - 1) {
+            CHECK(result == SYNC_COMMAND_PARSE_NONE);
+        }
+    }
+
+    return result;
+}
+
+static void test_round_trip() {
+    sync_command_parser_t parser;
+    sync_command_t        command;
+    sync_command_t        parsed;
+    uint8_t               buffer[SYNC_COMMAND_LENGTH];
+    uint32_t              seed = 1;
+
+    sync_command_parser_init(&parser);
+
+    for (uint32_t i = 0; i < 1000; i++) {
+        command.id     = (uint8_t)test_rand(&seed);
+        command.status = (uint8_t)test_rand(&seed);
+        command.value  = rand32(&seed);
+        sync_command_pack(buffer, &command);
+
+        CHECK(buffer[0] == SYNC_COMMAND_SYNC);
+        CHECK(feed(&parser, buffer, SYNC_COMMAND_LENGTH, &parsed) == SYNC_COMMAND_PARSE_FRAME);
+        CHECK(parsed.id == command.id);
+        CHECK(parsed.status == command.status);
+        CHECK(parsed.value == command.value);
+    }
+
+    // little endian
+    command.id     = SYNC_COMMAND_PERIOD;
+    command.status = SYNC_COMMAND_OK;
+    command.value  = 0x12345678;
+    sync_command_pack(buffer, &command);
+    CHECK(buffer[3] == 0x78 && buffer[4] == 0x56 && buffer[5] == 0x34 && buffer[6] == 0x12);
+}
+
+static void test_checksum() {
+    sync_command_parser_t parser;
+    sync_command_t        command = {SYNC_COMMAND_WIDTH, SYNC_COMMAND_OK, WIDTH};
+    sync_command_t        parsed;
+    uint8_t               buffer[SYNC_COMMAND_LENGTH];
+
+    sync_command_parser_init(&parser);
+
+    // any single bit flipped after the sync byte is caught, the id is kept for the acknowledgement
+    for (uint8_t byte = 2; byte < SYNC_COMMAND_LENGTH; byte++) {
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            sync_command_pack(buffer, &command);
+            buffer[byte] ^= (uint8_t)(1 << bit);
+
+            if (buffer[byte] == SYNC_COMMAND_SYNC) {
+                continue;   // a sync byte inside the frame, see test_resync()
+            }
+            sync_command_parser_init(&parser);
+            CHECK(feed(&parser, buffer, SYNC_COMMAND_LENGTH, &parsed) == SYNC_COMMAND_PARSE_ERROR);
+            CHECK(parsed.id == SYNC_COMMAND_WIDTH);
+            CHECK(parsed.status == SYNC_COMMAND_CHECKSUM);
+        }
+    }
+
+    // the parser starts over after the error
+    sync_command_pack(buffer, &command);
+    CHECK(feed(&parser, buffer, SYNC_COMMAND_LENGTH, &parsed) == SYNC_COMMAND_PARSE_FRAME);
+    CHECK(parsed.value == WIDTH);
+}
+
+static void test_resync() {
+    sync_command_parser_t parser;
+    sync_command_t        command = {SYNC_COMMAND_OFFSET, SYNC_COMMAND_OK, OFFSET};
+    sync_command_t        parsed;
+    uint8_t               buffer[SYNC_COMMAND_LENGTH];
+    uint8_t               garbage[] = {0x00, 0xFF, 0x13, 0xA5};
+
+    sync_command_parser_init(&parser);
+    sync_command_pack(buffer, &command);
+
+    // bytes before the sync byte are skipped
+    CHECK(feed(&parser, garbage, sizeof(garbage), &parsed) == SYNC_COMMAND_PARSE_NONE);
+    CHECK(feed(&parser, buffer, SYNC_COMMAND_LENGTH, &parsed) == SYNC_COMMAND_PARSE_FRAME);
+    CHECK(parsed.id == SYNC_COMMAND_OFFSET);
+    CHECK(parsed.value == OFFSET);
+
+    // a false sync byte followed by the start of a frame: the error comes when 8 bytes are in, the frame
+    // started at the second sync byte completes with its remaining bytes
+    for (uint8_t lost = 1; lost < SYNC_COMMAND_LENGTH; lost++) {
+        sync_command_parser_init(&parser);
+        CHECK(sync_command_parse(&parser, SYNC_COMMAND_SYNC, &parsed) == SYNC_COMMAND_PARSE_NONE);
+        for (uint8_t i = 1; i < lost; i++) {
+            CHECK(sync_command_parse(&parser, 0x00, &parsed) == SYNC_COMMAND_PARSE_NONE);
+        }
+
+        uint8_t head = (uint8_t)(SYNC_COMMAND_LENGTH - lost);
+        CHECK(feed(&parser, buffer, head, &parsed) == SYNC_COMMAND_PARSE_ERROR);
+        CHECK(parsed.status == SYNC_COMMAND_CHECKSUM);
+        CHECK(feed(&parser, buffer + head, lost, &parsed) == SYNC_COMMAND_PARSE_FRAME);
+        CHECK(parsed.id == SYNC_COMMAND_OFFSET);
+        CHECK(parsed.value == OFFSET);
+    }
+
+    // a frame whose CRC holds the sync byte is not lost to the resynchronization
+    sync_command_parser_init(&parser);
+    for (uint32_t value = 0; ; value++) {
+        command.value = value;
+        sync_command_pack(buffer, &command);
+        if (buffer[SYNC_COMMAND_LENGTH - 1] == SYNC_COMMAND_SYNC) {
+            break;
+        }
+    }
+    CHECK(feed(&parser, buffer, SYNC_COMMAND_LENGTH, &parsed) == SYNC_COMMAND_PARSE_FRAME);
+    CHECK(parsed.value == command.value);
+}
+
+static void test_apply() {
+    sync_command_config_t config = {PERIOD, WIDTH, OFFSET, CHANNELS};
+    sync_command_t        command;
+
+    // accepted values
+    command = (sync_command_t){SYNC_COMMAND_PERIOD, SYNC_COMMAND_OK, 2 * PERIOD};
+    CHECK(sync_command_apply(&config, &command, MARGIN, MAX) == SYNC_COMMAND_OK);
+    CHECK(config.period == 2 * PERIOD);
+    command = (sync_command_t){SYNC_COMMAND_WIDTH, SYNC_COMMAND_OK, 2 * WIDTH};
+    CHECK(sync_command_apply(&config, &command, MARGIN, MAX) == SYNC_COMMAND_OK);
+    CHECK(config.width == 2 * WIDTH);
+    command = (sync_command_t){SYNC_COMMAND_OFFSET, SYNC_COMMAND_OK, MARGIN};
+    CHECK(sync_command_apply(&config, &command, MARGIN, MAX) == SYNC_COMMAND_OK);
+    CHECK(config.offset == MARGIN);
+    command = (sync_command_t){SYNC_COMMAND_CHANNELS, SYNC_COMMAND_OK, 0x00F0};
+    CHECK(sync_command_apply(&config, &command, MARGIN, MAX) == SYNC_COMMAND_OK);
+    CHECK(config.channels == 0x00F0);
+
+    // refused values leave the schedule as it is
+    config = (sync_command_config_t){PERIOD, WIDTH, OFFSET, CHANNELS};
+    sync_command_t refused[] = {
+        {SYNC_COMMAND_WIDTH,  SYNC_COMMAND_OK, 0},
+        {SYNC_COMMAND_WIDTH,  SYNC_COMMAND_OK, PERIOD - MARGIN},
+        {SYNC_COMMAND_WIDTH,  SYNC_COMMAND_OK, 0xFFFFFFFF},
+        {SYNC_COMMAND_OFFSET, SYNC_COMMAND_OK, MARGIN - 1},
+        {SYNC_COMMAND_OFFSET, SYNC_COMMAND_OK, PERIOD},
+        {SYNC_COMMAND_PERIOD, SYNC_COMMAND_OK, MAX + 1},
+        {SYNC_COMMAND_PERIOD, SYNC_COMMAND_OK, WIDTH + MARGIN},
+        {SYNC_COMMAND_PERIOD, SYNC_COMMAND_OK, OFFSET},
+    };
+    for (uint32_t i = 0; i < sizeof(refused) / sizeof(refused[0]); i++) {
+        CHECK(sync_command_apply(&config, &refused[i], MARGIN, MAX) == SYNC_COMMAND_RANGE);
+        CHECK(config.period == PERIOD && config.width == WIDTH && config.offset == OFFSET);
+        CHECK(config.channels == CHANNELS);
+    }
+
+    // the limits themselves
+    command = (sync_command_t){SYNC_COMMAND_WIDTH, SYNC_COMMAND_OK, PERIOD - MARGIN - 1};
+    CHECK(sync_command_apply(&config, &command, MARGIN, MAX) == SYNC_COMMAND_OK);
+    command = (sync_command_t){SYNC_COMMAND_OFFSET, SYNC_COMMAND_OK, PERIOD - 1};
+    CHECK(sync_command_apply(&config, &command, MARGIN, MAX) == SYNC_COMMAND_OK);
+    config = (sync_command_config_t){PERIOD, WIDTH, OFFSET, CHANNELS};
+    command = (sync_command_t){SYNC_COMMAND_PERIOD, SYNC_COMMAND_OK, MAX};
+    CHECK(sync_command_apply(&config, &command, MARGIN, MAX) == SYNC_COMMAND_OK);
+
+    // reads change nothing and return the value in use
+    config = (sync_command_config_t){PERIOD, WIDTH, OFFSET, CHANNELS};
+    uint32_t read[][2] = {
+        {SYNC_COMMAND_PERIOD,   PERIOD},
+        {SYNC_COMMAND_WIDTH,    WIDTH},
+        {SYNC_COMMAND_OFFSET,   OFFSET},
+        {SYNC_COMMAND_CHANNELS, CHANNELS},
+    };
+    for (uint32_t i = 0; i < sizeof(read) / sizeof(read[0]); i++) {
+        command = (sync_command_t){SYNC_COMMAND_READ, SYNC_COMMAND_OK, read[i][0]};
+        CHECK(sync_command_apply(&config, &command, MARGIN, MAX) == SYNC_COMMAND_OK);
+        CHECK(command.value == read[i][1]);
+    }
+    CHECK(config.period == PERIOD && config.width == WIDTH && config.offset == OFFSET);
+
+    // unknown ids, the loss report is left to the caller
+    command = (sync_command_t){SYNC_COMMAND_READ, SYNC_COMMAND_OK, SYNC_COMMAND_READ};
+    CHECK(sync_command_apply(&config, &command, MARGIN, MAX) == SYNC_COMMAND_UNKNOWN);
+    command = (sync_command_t){0x7F, SYNC_COMMAND_OK, PERIOD};
+    CHECK(sync_command_apply(&config, &command, MARGIN, MAX) == SYNC_COMMAND_UNKNOWN);
+    command = (sync_command_t){SYNC_COMMAND_LOSS, SYNC_COMMAND_OK, 100};
+    CHECK(sync_command_apply(&config, &command, MARGIN, MAX) == SYNC_COMMAND_UNKNOWN);
+    CHECK(config.period == PERIOD && config.width == WIDTH && config.offset == OFFSET);
+    CHECK(config.channels == CHANNELS);
+}
+
+int main(void) {
+    test_round_trip();
+    test_checksum();
+    test_resync();
+    test_apply();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,106 @@
+/** @file
+*
+* @brief Host tests of sync_energy.c: the continuous and duty-cycled timelines of one period, and the charge,
+* energy and average current of each, against values computed by hand from the default model.
+*
+*/
+
+#include "sync_energy.h"
+#include "test.h"
+
+/**
+ * @brief Function for checking one step of a timeline.
+ */
+static bool step_is(const sync_energy_timeline_t *timeline, uint32_t i, sync_energy_state_t state, uint32_t duration) {
+    return i < timeline->count && timeline->steps[i].state == state && timeline->steps[i].duration_us == duration;
+}
+
+// 1 s period, 1 ms wake lead, 0.4 ms HFXO startup, 40 us ramp-up, 200 us on air, 0.3 ms offset, 1 ms pulse
+static const sync_energy_timing_t timing = {
+    .period       = 1000000,
+    .wake_lead    = 1000,
+    .hfxo_startup = 400,
+    .rampup       = 40,
+    .airtime      = 200,
+    .offset       = 300,
+    .width        = 1000,
+};
+
+static void test_continuous() {
+    sync_energy_model_t    model;
+    sync_energy_timeline_t timeline;
+    sync_energy_report_t   report;
+
+    sync_energy_default_model(&model);
+    sync_energy_continuous_timeline(&timing, &timeline);
+
+    CHECK(timeline.count == 2);
+    CHECK(timeline.period_us == 1000000);
+    CHECK(step_is(&timeline, 0, SYNC_ENERGY_TX, 200));
+    CHECK(step_is(&timeline, 1, SYNC_ENERGY_RADIO_IDLE, 999800));
+
+    // 6.4 mA x 200 us + 1.5 mA x 999800 us = 1500980 nC, never asleep
+    CHECK(sync_energy_evaluate(&model, &timeline, &report));
+    CHECK(report.charge_nc == 1500980);
+    CHECK(report.energy_nj == 4502940);
+    CHECK(report.average_na == 1500980);
+}
+
+static void test_duty_cycled() {
+    sync_energy_model_t    model;
+    sync_energy_timeline_t timeline;
+    sync_energy_report_t   report;
+    sync_energy_timing_t   short_lead = timing;
+
+    sync_energy_default_model(&model);
+    sync_energy_duty_cycled_timeline(&timing, &timeline);
+
+    // TXIDLE for the rest of the lead, TIMER from the end of the frame to the end of the pulse
+    CHECK(timeline.count == 5);
+    CHECK(step_is(&timeline, 0, SYNC_ENERGY_HFXO, 400));
+    CHECK(step_is(&timeline, 1, SYNC_ENERGY_RAMPUP, 40));
+    CHECK(step_is(&timeline, 2, SYNC_ENERGY_RADIO_IDLE, 560));
+    CHECK(step_is(&timeline, 3, SYNC_ENERGY_TX, 200));
+    CHECK(step_is(&timeline, 4, SYNC_ENERGY_TIMER, 1100));
+
+    // 0.25 mA x 400 + 5 mA x 40 + 1.5 mA x 560 + 6.4 mA x 200 + 0.5 mA x 1100 + 3 uA x 997700 = 5963.1 nC
+    CHECK(sync_energy_evaluate(&model, &timeline, &report));
+    CHECK(report.charge_nc == 5963);
+    CHECK(report.energy_nj == 17889);
+    CHECK(report.average_na == 5963);
+
+    // a lead shorter than the startup leaves no TXIDLE step, steps of 0 us are skipped
+    short_lead.wake_lead = 300;
+    sync_energy_duty_cycled_timeline(&short_lead, &timeline);
+    CHECK(timeline.count == 4);
+    CHECK(step_is(&timeline, 2, SYNC_ENERGY_TX, 200));
+}
+
+static void test_reject() {
+    sync_energy_model_t    model;
+    sync_energy_timeline_t timeline;
+    sync_energy_report_t   report;
+    sync_energy_timing_t   crowded = timing;
+
+    sync_energy_default_model(&model);
+
+    // the steps do not fit in the period
+    crowded.period = 2000;
+    sync_energy_duty_cycled_timeline(&crowded, &timeline);
+    CHECK(!sync_energy_evaluate(&model, &timeline, &report));
+    crowded.period = 2300;
+    sync_energy_duty_cycled_timeline(&crowded, &timeline);
+    CHECK(sync_energy_evaluate(&model, &timeline, &report));
+
+    crowded.period = 0;
+    sync_energy_continuous_timeline(&crowded, &timeline);
+    CHECK(!sync_energy_evaluate(&model, &timeline, &report));
+}
+
+int main(void) {
+    test_continuous();
+    test_duty_cycled();
+    test_reject();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,213 @@
+/** @file
+*
+* @brief Host tests of sync_holdover.c: a transmitter with a crystal offset sends jittered beacons, some of them
+* lost at random or in bursts, and every holdover pulse is compared with the beacon it replaces.
+*
+*/
+
+#include <stdlib.h>
+
+#include "sync_holdover.h"
+#include "test.h"
+
+#define NOMINAL              1000000UL  // PULSE_PERIOD of 1 s at 1 MHz
+#define OFFSET_PPM           40         // transmitter crystal faster than the receiver one
+#define PERIOD               (NOMINAL + NOMINAL * OFFSET_PPM / 1000000UL)
+#define JITTER               1          // beacon timestamps are +-JITTER ticks off
+#define TOLERANCE            50
+#define GUARD                (TOLERANCE + 1)  // holdover pulses come this long after the prediction
+#define MAX_PERIODS          60
+#define BEACONS              20000
+
+/**
+ * @brief Loss patterns.
+ */
+typedef enum {
+    LOSS_NONE,
+    LOSS_RANDOM,            // every beacon lost with a probability of 1 / 3
+    LOSS_BURSTS,            // bursts of 1 to 20 beacons lost, every 30 beacons
+    LOSS_LONG               // bursts longer than MAX_PERIODS
+} loss_t;
+
+static bool lost(loss_t loss, uint32_t k, uint32_t *seed) {
+    switch (loss) {
+        case LOSS_RANDOM:
+            return test_rand(seed) % 3 == 0;
+        case LOSS_BURSTS:
+            return k % 30 >= 10 && k % 30 < 10 + 1 + (k / 30) % 20;
+        case LOSS_LONG:
+            return k % 200 >= 10 && k % 200 < 10 + MAX_PERIODS + 20;
+        case LOSS_NONE:
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Function for running BEACONS periods from start (a timer value), checking every pulse and report.
+ */
+static void run(loss_t loss, uint32_t start) {
+    sync_holdover_t        holdover;
+    sync_holdover_report_t report;
+    uint32_t               seed     = 1;
+    uint32_t               missed   = 0;
+    uint32_t               received = 0;
+    uint32_t               pulses   = 0;
+    uint32_t               ts;
+
+    sync_holdover_init(&holdover, NOMINAL, TOLERANCE, MAX_PERIODS);
+    CHECK(!sync_holdover_next(&holdover, &ts));
+
+    for (uint32_t k = 0; k < BEACONS; k++) {
+        int32_t  jitter = (int32_t)(test_rand(&seed) % (2 * JITTER + 1)) - JITTER;
+        uint32_t time   = start + (uint32_t)((uint64_t)k * PERIOD) + (uint32_t)jitter;
+
+        // the first two beacons are always received, holdover needs them to lock
+        if (k >= SYNC_HOLDOVER_LOCK_BEACONS && lost(loss, k, &seed)) {
+            // the pulse of a lost beacon comes from the prediction, if any
+            if (sync_holdover_next(&holdover, &ts)) {
+                uint32_t error = (uint32_t)abs((int32_t)(ts - GUARD - time));
+
+                CHECK(missed < MAX_PERIODS);
+                CHECK(error <= TOLERANCE);
+                sync_holdover_generated(&holdover);
+                pulses++;
+            } else {
+                CHECK(missed >= MAX_PERIODS);
+            }
+            missed++;
+            continue;
+        }
+
+        // a received beacon always comes before the holdover pulse armed for it
+        if (sync_holdover_next(&holdover, &ts)) {
+            CHECK((int32_t)(ts - time) > 0);
+        }
+
+        sync_holdover_beacon(&holdover, time, &report);
+        if (received > 0) {
+            CHECK(report.on_schedule);
+            CHECK(report.missed == missed);
+            CHECK((uint32_t)abs(report.phase_error) <= TOLERANCE);
+        }
+        received++;
+        missed = 0;
+    }
+
+    // the learned period is the transmitter one in receiver ticks, at the tick
+    CHECK(sync_holdover_period(&holdover) >= PERIOD - 1 && sync_holdover_period(&holdover) <= PERIOD + 1);
+    CHECK(loss == LOSS_NONE || pulses > 0);
+    CHECK(loss != LOSS_NONE || pulses == 0);
+}
+
+static void test_losses() {
+    run(LOSS_NONE, 0);
+    run(LOSS_RANDOM, 0);
+    run(LOSS_BURSTS, 0);
+    run(LOSS_LONG, 0);
+
+    // the timer wraps every 71 min at 1 MHz, a few periods after the start here
+    run(LOSS_BURSTS, 0xFFFFFFFFUL - 3 * PERIOD);
+    run(LOSS_RANDOM, 0xFFFFFFFFUL - 3 * PERIOD);
+}
+
+static void test_lock() {
+    sync_holdover_t        holdover;
+    sync_holdover_report_t report;
+    uint32_t               ts;
+
+    sync_holdover_init(&holdover, NOMINAL, TOLERANCE, MAX_PERIODS);
+
+    // the first interval is far from the nominal period but still accepted, it gives the first measurement
+    sync_holdover_beacon(&holdover, 1000, &report);
+    CHECK(!report.on_schedule);
+    CHECK(!sync_holdover_next(&holdover, &ts));
+    sync_holdover_beacon(&holdover, 1000 + NOMINAL + 1000, &report);
+    CHECK(report.on_schedule);
+    CHECK(report.missed == 0);
+    CHECK(sync_holdover_period(&holdover) == NOMINAL + 1000);
+    CHECK(sync_holdover_next(&holdover, &ts));
+    CHECK(ts == 1000 + 2 * (NOMINAL + 1000) + GUARD);
+
+    // a beacon off the prediction restarts the acquisition from it, keeping the period
+    sync_holdover_beacon(&holdover, ts - GUARD + 10 * TOLERANCE, &report);
+    CHECK(!report.on_schedule);
+    CHECK(report.phase_error == 10 * TOLERANCE);
+    CHECK(!sync_holdover_next(&holdover, &ts));
+    CHECK(sync_holdover_period(&holdover) == NOMINAL + 1000);
+
+    // two periods later, with one beacon lost in between: locked again, the loss is reported
+    uint32_t last = 1000 + 2 * (NOMINAL + 1000) + 10 * TOLERANCE;
+    sync_holdover_beacon(&holdover, last + 2 * (NOMINAL + 1000), &report);
+    CHECK(report.on_schedule);
+    CHECK(report.missed == 1);
+    CHECK(report.phase_error == 0);
+    CHECK(sync_holdover_next(&holdover, &ts));
+}
+
+static void test_max_periods() {
+    sync_holdover_t        holdover;
+    sync_holdover_report_t report;
+    uint32_t               ts;
+    uint32_t               last = 0;
+
+    sync_holdover_init(&holdover, NOMINAL, TOLERANCE, 3);
+    sync_holdover_beacon(&holdover, 0, &report);
+    sync_holdover_beacon(&holdover, NOMINAL, &report);
+
+    for (uint32_t i = 1; i <= 3; i++) {
+        CHECK(sync_holdover_next(&holdover, &ts));
+        CHECK(ts == NOMINAL + i * NOMINAL + GUARD);
+        CHECK(ts > last);
+        last = ts;
+        sync_holdover_generated(&holdover);
+    }
+    CHECK(!sync_holdover_next(&holdover, &ts));
+
+    // a beacon ends the holdover, predictions start again from it
+    sync_holdover_beacon(&holdover, 10 * NOMINAL, &report);
+    CHECK(report.missed == 8);
+    CHECK(sync_holdover_next(&holdover, &ts));
+    CHECK(ts == 11 * NOMINAL + GUARD);
+}
+
+static void test_late_beacon() {
+    sync_holdover_t        holdover;
+    sync_holdover_report_t report;
+    uint32_t               ts;
+
+    sync_holdover_init(&holdover, NOMINAL, TOLERANCE, MAX_PERIODS);
+    sync_holdover_beacon(&holdover, 0, &report);
+    sync_holdover_beacon(&holdover, NOMINAL, &report);
+
+    // the latest beacon on schedule still comes one tick before the holdover pulse, and is not lost
+    CHECK(sync_holdover_next(&holdover, &ts));
+    CHECK(ts == 2 * NOMINAL + TOLERANCE + 1);
+    sync_holdover_beacon(&holdover, ts - 1, &report);
+    CHECK(report.on_schedule);
+    CHECK(report.missed == 0);
+    CHECK(report.phase_error == TOLERANCE);
+
+    // same after a holdover pulse: the late beacon replaces the second one
+    CHECK(sync_holdover_next(&holdover, &ts));
+    sync_holdover_generated(&holdover);
+    CHECK(sync_holdover_next(&holdover, &ts));
+    sync_holdover_beacon(&holdover, ts - 1, &report);
+    CHECK(report.on_schedule);
+    CHECK(report.missed == 1);
+    CHECK(report.phase_error <= TOLERANCE);
+
+    // one tick later the holdover pulse has fired first, and the beacon is off schedule
+    CHECK(sync_holdover_next(&holdover, &ts));
+    sync_holdover_beacon(&holdover, ts, &report);
+    CHECK(!report.on_schedule);
+}
+
+int main(void) {
+    test_losses();
+    test_lock();
+    test_max_periods();
+    test_late_beacon();
+
+    return TEST_RESULT();
+}
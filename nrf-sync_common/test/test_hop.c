@@ -0,0 +1,197 @@
+/** @file
+*
+* @brief Host tests of sync_hop.c: spread and determinism of the hop sequence, a receiver following a transmitter
+* through losses and channel map changes, and the blacklist.
+*
+*/
+
+#include "sync_hop.h"
+#include "test.h"
+
+#define SEED                 0x5EED1234UL
+#define BEACONS              100000
+#define MAX_MISSES           4
+#define DWELL                3
+
+static void test_map_helpers() {
+    CHECK(sync_hop_count(0) == 0);
+    CHECK(sync_hop_count(0xFFFFFFFFUL) == 32);
+    CHECK(sync_hop_count(0x80000101UL) == 3);
+
+    CHECK(sync_hop_first(0) == SYNC_HOP_FIXED);
+    CHECK(sync_hop_first(0x80000000UL) == 31);
+    CHECK(sync_hop_first(0x00000110UL) == 4);
+
+    CHECK(sync_hop_following(0x80000011UL, 0) == 4);
+    CHECK(sync_hop_following(0x80000011UL, 4) == 31);
+    CHECK(sync_hop_following(0x80000011UL, 31) == 0);
+    CHECK(sync_hop_following(0x00000010UL, 4) == 4);
+    CHECK(sync_hop_following(0, 4) == SYNC_HOP_FIXED);
+}
+
+/**
+ * @brief Function for checking the sequence of a map: always one of its channels, spread evenly, and no channel
+ * used many times in a row.
+ */
+static void check_spread(uint32_t seed, uint32_t map) {
+    uint32_t counts[SYNC_HOP_MAX_CHANNELS] = { 0 };
+    uint32_t channels = sync_hop_count(map);
+    uint32_t run      = 0;
+    uint32_t longest  = 0;
+    uint8_t  last     = SYNC_HOP_FIXED;
+
+    for (uint32_t seq = 0xFFFFFFFFUL - BEACONS / 2; seq != BEACONS / 2; seq++) {
+        uint8_t index = sync_hop_index(seed, map, seq);
+
+        CHECK(index < SYNC_HOP_MAX_CHANNELS && (map & (1UL << index)));
+        CHECK(index == sync_hop_index(seed, map, seq));
+        counts[index]++;
+
+        run     = index == last ? run + 1 : 1;
+        longest = run > longest ? run : longest;
+        last    = index;
+    }
+
+    // within 5 % of the mean, about 8 standard deviations with 32 channels
+    for (uint8_t i = 0; i < SYNC_HOP_MAX_CHANNELS; i++) {
+        if (map & (1UL << i)) {
+            CHECK(counts[i] * channels * 100 > BEACONS * 95);
+            CHECK(counts[i] * channels * 100 < BEACONS * 105);
+        }
+    }
+    CHECK(channels == 1 || longest < 40);
+}
+
+static void test_sequence() {
+    uint32_t same = 0;
+
+    CHECK(sync_hop_index(SEED, 0, 12) == SYNC_HOP_FIXED);
+
+    check_spread(SEED, 0x1UL);
+    check_spread(SEED, 0x7UL);
+    check_spread(SEED, 0x80010203UL);
+    check_spread(SEED, 0xFFFFFFFFUL);
+    check_spread(1, 0x000FF000UL);
+
+    // another seed gives another sequence: the same channel about once every count beacons
+    for (uint32_t seq = 0; seq < BEACONS; seq++) {
+        same += sync_hop_index(SEED, 0xFFFFFFFFUL, seq) == sync_hop_index(SEED + 1, 0xFFFFFFFFUL, seq);
+    }
+    CHECK(same < BEACONS / 16);
+}
+
+static void test_follow() {
+    sync_hop_rx_t rx;
+    uint32_t      seed      = 21;
+    uint32_t      map       = 0x0000FF00UL;
+    uint32_t      next_map  = map;
+    uint32_t      switch_at = 0;
+    uint32_t      heard     = 0;
+    uint8_t       listen;
+
+    sync_hop_rx_init(&rx, SEED, map, 0xFFFFFFFFUL, MAX_MISSES, DWELL);
+    listen = sync_hop_first(map);
+
+    for (uint32_t seq = 0; seq < BEACONS; seq++) {
+        // every 1000 beacons the transmitter announces a new map 10 beacons ahead
+        if (seq % 1000 == 0) {
+            map       = (int32_t)(seq - switch_at) >= 0 ? next_map : map;
+            next_map  = (test_rand(&seed) << 17) ^ test_rand(&seed) ^ (test_rand(&seed) << 2);
+            next_map |= 1UL << (seq / 1000 % 32);
+            switch_at = seq + 10;
+        }
+        uint32_t current = (int32_t)(seq - switch_at) >= 0 ? next_map : map;
+        uint8_t  channel = sync_hop_index(SEED, current, seq);
+
+        // a third of the beacons are lost, sometimes eight in a row
+        bool lost = test_rand(&seed) % 3 == 0 || seq % 500 < 8;
+
+        if (listen == channel && !lost) {
+            listen = sync_hop_rx_beacon(&rx, seq, current, next_map, switch_at);
+            CHECK(rx.synced);
+            heard++;
+            continue;
+        }
+
+        // until max_misses in a row, the receiver still listens where the next beacon will be
+        bool synced = rx.synced;
+        listen = sync_hop_rx_missed(&rx);
+        if (synced && rx.synced) {
+            uint32_t after = (int32_t)(seq + 1 - switch_at) >= 0 ? next_map : map;
+            CHECK(listen == sync_hop_index(SEED, after, seq + 1));
+        }
+        if (synced && !rx.synced) {
+            CHECK(listen == sync_hop_first(sync_hop_rx_map(&rx, rx.expected)));
+        }
+    }
+
+    // two thirds get through, a few are missed while searching after the long losses
+    CHECK(heard > BEACONS * 4 / 10);
+}
+
+static void test_search() {
+    sync_hop_rx_t rx;
+    uint8_t       listen = 0;
+
+    sync_hop_rx_init(&rx, SEED, 0x00000030UL, 0x00000031UL, MAX_MISSES, DWELL);
+    CHECK(sync_hop_rx_beacon(&rx, 100, 0x00000030UL, 0x00000030UL, 0) == sync_hop_index(SEED, 0x30UL, 101));
+
+    for (uint32_t i = 0; i < MAX_MISSES; i++) {
+        listen = sync_hop_rx_missed(&rx);
+    }
+    CHECK(!rx.synced);
+    CHECK(listen == 4);
+
+    // DWELL periods on each channel of the table, in order, wrapping around
+    const uint8_t walk[] = { 5, 0, 4, 5 };
+    for (uint32_t w = 0; w < sizeof(walk); w++) {
+        for (uint32_t i = 0; i < DWELL; i++) {
+            listen = sync_hop_rx_missed(&rx);
+        }
+        CHECK(listen == walk[w]);
+    }
+
+    // a beacon heard on a search channel syncs again
+    CHECK(sync_hop_rx_beacon(&rx, 130, 0x00000030UL, 0x00000030UL, 0) == sync_hop_index(SEED, 0x30UL, 131));
+    CHECK(rx.synced);
+}
+
+static void test_blacklist() {
+    sync_hop_stats_t stats;
+
+    sync_hop_stats_init(&stats);
+    CHECK(sync_hop_stats_loss(&stats, 3) == 0);
+
+    // channels 0 to 5: losses of 0, 10, 50, 400, 600 and 900 per mille over 1000 beacons
+    const uint32_t loss[] = { 0, 10, 50, 400, 600, 900 };
+    for (uint8_t i = 0; i < 6; i++) {
+        for (uint32_t b = 0; b < 1000; b++) {
+            sync_hop_stats_add(&stats, i, b >= loss[i]);
+        }
+        CHECK(sync_hop_stats_loss(&stats, i) == loss[i]);
+    }
+    sync_hop_stats_add(&stats, SYNC_HOP_FIXED, false);
+
+    // above 100 per mille
+    CHECK(sync_hop_blacklist(&stats, 0x3FUL, 100, 100) == 0x07UL);
+    // channels outside the map are not counted
+    CHECK(sync_hop_blacklist(&stats, 0x29UL, 100, 100) == 0x01UL + 0x08UL);
+    // worst first, SYNC_HOP_MIN_CHANNELS always left
+    CHECK(sync_hop_blacklist(&stats, 0x38UL, 100, 100) == 0x18UL);
+    CHECK(sync_hop_blacklist(&stats, 0x30UL, 100, 0) == 0x30UL);
+    CHECK(sync_hop_blacklist(&stats, 0x3FUL, 100, 0) == 0x03UL);
+    // not enough beacons to judge
+    CHECK(sync_hop_blacklist(&stats, 0x3FUL, 1001, 100) == 0x3FUL);
+    // a channel without beacons is kept
+    CHECK(sync_hop_blacklist(&stats, 0xC0000000UL | 0x3FUL, 0, 100) == (0xC0000000UL | 0x07UL));
+}
+
+int main(void) {
+    test_map_helpers();
+    test_sequence();
+    test_follow();
+    test_search();
+    test_blacklist();
+
+    return TEST_RESULT();
+}
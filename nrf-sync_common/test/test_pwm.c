@@ -0,0 +1,186 @@
+/** @file
+*
+* @brief Host tests of sync_pwm.c: compiled sequences are played back tick by tick the way PWM0 does in up mode
+* and compared with the pattern, over random patterns with zero-duration segments and several edges per slot.
+*
+*/
+
+#include "sync_pwm.h"
+#include "test.h"
+
+#define SEQUENCE_MAX         512
+#define SEGMENTS_MAX         24
+#define ROUNDS               20000
+
+/**
+ * @brief Function for getting the level of a pattern at tick t; zero-duration segments are skipped and the
+ * last level holds after the end.
+ */
+static bool pattern_level(const sync_pwm_segment_t *segments, uint16_t count, uint64_t t) {
+    uint64_t end   = 0;
+    bool     level = false;
+
+    for (uint16_t j = 0; j < count; j++) {
+        if (segments[j].duration == 0) {
+            continue;
+        }
+        level = segments[j].level;
+        end  += segments[j].duration;
+        if (t < end) {
+            break;
+        }
+    }
+
+    return level;
+}
+
+/**
+ * @brief Function for getting the output of PWM0 at tick t of a slot playing value, as in the product
+ * specification: bit 15 set (FallingEdge) is high until the compare then low, bit 15 clear (RisingEdge) is
+ * low until the compare then high. Literal values, so the polarity macros of the module are checked too.
+ */
+static bool pwm_level(uint16_t value, uint32_t t) {
+    uint32_t compare = value & 0x7FFFU;
+
+    if (value & 0x8000U) {
+        return t < compare;
+    }
+    return t >= compare;
+}
+
+/**
+ * @brief Function for knowing if some slot of the pattern holds more than one edge.
+ */
+static bool crowded(const sync_pwm_segment_t *segments, uint16_t count, uint16_t countertop, uint64_t total) {
+    for (uint64_t start = 0; start < total; start += countertop) {
+        uint32_t edges = 0;
+
+        for (uint64_t t = start + 1; t < start + countertop; t++) {
+            if (pattern_level(segments, count, t) != pattern_level(segments, count, t - 1)) {
+                edges++;
+            }
+        }
+        if (edges > 1) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Function for compiling a pattern and, if it compiles, checking the playback tick by tick.
+ * Returns the sequence length.
+ */
+static uint16_t check_pattern(const sync_pwm_segment_t *segments, uint16_t count, uint16_t countertop) {
+    uint16_t sequence[SEQUENCE_MAX];
+    uint64_t total = 0;
+
+    for (uint16_t j = 0; j < count; j++) {
+        total += segments[j].duration;
+    }
+
+    uint16_t length = sync_pwm_compile(segments, count, countertop, sequence, SEQUENCE_MAX);
+    uint64_t slots  = (total + countertop - 1) / countertop;
+
+    if (slots == 0 || slots > SEQUENCE_MAX || crowded(segments, count, countertop, total)) {
+        CHECK(length == 0);
+        return length;
+    }
+
+    CHECK(length == slots);
+    for (uint16_t s = 0; s < length; s++) {
+        for (uint32_t t = 0; t < countertop; t++) {
+            CHECK(pwm_level(sequence[s], t) == pattern_level(segments, count, (uint64_t)s * countertop + t));
+        }
+    }
+
+    return length;
+}
+
+static void test_fixed() {
+    // 1 ms high, 2 ms low, 1 ms high with 100 us slots at 1 MHz
+    const sync_pwm_segment_t simple[]   = { { true, 1000 }, { false, 2000 }, { true, 1000 } };
+    // edges inside slots, a zero-duration segment and a repeated level in between
+    const sync_pwm_segment_t inside[]   = { { true, 150 }, { false, 0 }, { true, 100 }, { false, 30 }, { false, 300 } };
+    // a zero-duration low segment between two highs is no edge at all
+    const sync_pwm_segment_t glitch[]   = { { true, 50 }, { false, 0 }, { true, 50 } };
+    // a zero-duration segment at the start and at the end
+    const sync_pwm_segment_t ends[]     = { { false, 0 }, { true, 120 }, { false, 80 }, { true, 0 } };
+    uint16_t                 sequence[SEQUENCE_MAX];
+
+    CHECK(check_pattern(simple, 3, 100) == 40);
+    CHECK(check_pattern(inside, 5, 100) == 6);
+    CHECK(check_pattern(glitch, 3, 100) == 1);
+    CHECK(check_pattern(ends, 4, 100) == 2);
+
+    // slot 0 starts high and falls at 50, slot 1 stays low
+    const sync_pwm_segment_t one[] = { { true, 50 }, { false, 150 } };
+    CHECK(sync_pwm_compile(one, 2, 100, sequence, SEQUENCE_MAX) == 2);
+    CHECK(sequence[0] == (0x8000U | 50));     // high first
+    CHECK(sequence[1] == (0x0000U | 100));    // low first, no edge
+}
+
+static void test_reject() {
+    const sync_pwm_segment_t two[]   = { { true, 30 }, { false, 30 }, { true, 140 } };   // two edges in slot 0
+    const sync_pwm_segment_t late[]  = { { true, 1020 }, { false, 50 }, { true, 10 } };  // two edges in slot 10
+    const sync_pwm_segment_t zero[]  = { { true, 0 }, { false, 0 } };
+    const sync_pwm_segment_t ok[]    = { { true, 250 } };
+    uint16_t                 sequence[SEQUENCE_MAX];
+
+    CHECK(sync_pwm_compile(two, 3, 100, sequence, SEQUENCE_MAX) == 0);
+    CHECK(sync_pwm_compile(late, 3, 100, sequence, SEQUENCE_MAX) == 0);
+
+    // the same edges with wider slots fit once apart
+    CHECK(sync_pwm_compile(two, 3, 30, sequence, SEQUENCE_MAX) == 7);
+
+    // nothing to play
+    CHECK(sync_pwm_compile(zero, 2, 100, sequence, SEQUENCE_MAX) == 0);
+    CHECK(sync_pwm_compile(ok, 0, 100, sequence, SEQUENCE_MAX) == 0);
+
+    // countertop out of range, sequence too short
+    CHECK(sync_pwm_compile(ok, 1, 0, sequence, SEQUENCE_MAX) == 0);
+    CHECK(sync_pwm_compile(ok, 1, SYNC_PWM_COUNTERTOP_MAX + 1, sequence, SEQUENCE_MAX) == 0);
+    CHECK(sync_pwm_compile(ok, 1, SYNC_PWM_COUNTERTOP_MAX, sequence, SEQUENCE_MAX) == 1);
+    CHECK(sync_pwm_compile(ok, 1, 100, sequence, 2) == 0);
+    CHECK(sync_pwm_compile(ok, 1, 100, sequence, 3) == 3);
+}
+
+static void test_random() {
+    sync_pwm_segment_t segments[SEGMENTS_MAX];
+    uint32_t           seed      = 11;
+    uint32_t           compiled  = 0;
+    uint32_t           rejected  = 0;
+
+    for (uint32_t r = 0; r < ROUNDS; r++) {
+        uint16_t countertop = (uint16_t)(8 + test_rand(&seed) % 32);
+        uint16_t count      = (uint16_t)(1 + test_rand(&seed) % SEGMENTS_MAX);
+
+        for (uint16_t j = 0; j < count; j++) {
+            uint32_t kind = test_rand(&seed) % 8;
+
+            segments[j].level = test_rand(&seed) % 2;
+            // mostly one edge per slot at most, sometimes shorter or empty segments
+            segments[j].duration = kind == 0 ? 0 :
+                                   kind == 1 ? test_rand(&seed) % countertop :
+                                               countertop + test_rand(&seed) % (3U * countertop);
+        }
+
+        if (check_pattern(segments, count, countertop)) {
+            compiled++;
+        } else {
+            rejected++;
+        }
+    }
+
+    // both outcomes are exercised
+    CHECK(compiled > ROUNDS / 10);
+    CHECK(rejected > ROUNDS / 10);
+}
+
+int main(void) {
+    test_fixed();
+    test_reject();
+    test_random();
+
+    return TEST_RESULT();
+}
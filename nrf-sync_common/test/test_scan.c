@@ -0,0 +1,126 @@
+/** @file
+*
+* @brief Host tests of sync_scan.c: the scan order and its rounds, the noise floor filter and the loss penalty,
+* and the choice of the next map with its hysteresis.
+*
+*/
+
+#include "sync_scan.h"
+#include "test.h"
+
+#define CHANNELS             5
+#define ROUNDS               3
+
+static void test_init() {
+    sync_scan_t scan;
+    uint8_t     index;
+
+    // an empty table would make sync_scan_next() divide by zero
+    CHECK(!sync_scan_init(&scan, 0));
+
+    CHECK(sync_scan_init(&scan, 1));
+    CHECK(sync_scan_next(&scan, &index));
+    CHECK(index == 0);
+    CHECK(sync_scan_next(&scan, &index));
+    CHECK(index == 0);
+
+    // a table longer than the channel map is cut to it
+    CHECK(sync_scan_init(&scan, 40));
+    CHECK(scan.channels == SYNC_HOP_MAX_CHANNELS);
+}
+
+static void test_next() {
+    sync_scan_t scan;
+    uint8_t     index;
+
+    CHECK(sync_scan_init(&scan, CHANNELS));
+
+    // every channel in turn, the round ends on the last one of the table
+    for (uint32_t round = 0; round < ROUNDS; round++) {
+        for (uint8_t i = 0; i < CHANNELS; i++) {
+            bool last = sync_scan_next(&scan, &index);
+
+            CHECK(index == i);
+            CHECK(last == (i == CHANNELS - 1));
+        }
+    }
+}
+
+static void test_score() {
+    sync_scan_t scan;
+
+    CHECK(sync_scan_init(&scan, CHANNELS));
+    CHECK(scan.scanned == 0);
+
+    // the first sample is taken as is: -80 dBm is -1280/16
+    sync_scan_add(&scan, 2, 80);
+    CHECK(scan.scanned == (1UL << 2));
+    CHECK(sync_scan_score(&scan, 2) == -1280);
+
+    // the next ones move it by a quarter of the difference: (-960 + 1280) / 4 = 80
+    sync_scan_add(&scan, 2, 60);
+    CHECK(sync_scan_score(&scan, 2) == -1200);
+    sync_scan_add(&scan, 2, 60);
+    CHECK(sync_scan_score(&scan, 2) == -1140);
+
+    // 10 per mille of loss weigh as much as 1 dB, the loss is capped at 1000 per mille
+    sync_scan_loss(&scan, 2, 100);
+    CHECK(sync_scan_score(&scan, 2) == -1140 + 160);
+    sync_scan_loss(&scan, 2, 2000);
+    CHECK(sync_scan_score(&scan, 2) == -1140 + 1600);
+
+    // channels out of the table are ignored
+    sync_scan_add(&scan, CHANNELS, 90);
+    sync_scan_loss(&scan, CHANNELS, 500);
+    CHECK(scan.scanned == (1UL << 2));
+}
+
+static void test_best() {
+    sync_scan_t scan;
+
+    CHECK(sync_scan_init(&scan, CHANNELS));
+
+    // nothing to choose from until count channels are scanned
+    CHECK(sync_scan_best(&scan, 1, 0x02, 3) == 0x02);
+    sync_scan_add(&scan, 0, 90);    // -1440
+    CHECK(sync_scan_best(&scan, 2, 0x02, 3) == 0x02);
+    sync_scan_add(&scan, 1, 50);    // -800
+    sync_scan_add(&scan, 2, 85);    // -1360
+    sync_scan_add(&scan, 3, 40);    // -640
+    CHECK(sync_scan_best(&scan, 0, 0x02, 3) == 0x02);
+
+    // the quietest channels, whatever the map in use
+    CHECK(sync_scan_best(&scan, 1, 0x02, 3) == 0x01);
+    CHECK(sync_scan_best(&scan, 2, 0x02, 3) == 0x05);
+    CHECK(sync_scan_best(&scan, 1, 0x01, 3) == 0x01);
+
+    // channel 0 is 5 dB better than channel 2: a hysteresis of 5 dB moves, 6 dB does not
+    CHECK(sync_scan_best(&scan, 1, 0x04, 5) == 0x01);
+    CHECK(sync_scan_best(&scan, 1, 0x04, 6) == 0x04);
+
+    // the mean of the map is compared: channels 1 and 2 average -1080, 22.5 dB worse than channel 0
+    CHECK(sync_scan_best(&scan, 1, 0x06, 22) == 0x01);
+    CHECK(sync_scan_best(&scan, 1, 0x06, 23) == 0x06);
+
+    // a map with no scanned channel is always replaced
+    CHECK(sync_scan_best(&scan, 1, 0x10, 100) == 0x01);
+
+    // the loss reported on channel 0 makes it worse than channel 2
+    sync_scan_loss(&scan, 0, 200);  // -1440 + 320
+    CHECK(sync_scan_best(&scan, 1, 0x02, 3) == 0x04);
+
+    // on a tie, the lowest index
+    sync_scan_loss(&scan, 0, 0);
+    sync_scan_add(&scan, 4, 90);    // -1440, as channel 0
+    CHECK(sync_scan_best(&scan, 1, 0x02, 3) == 0x01);
+    CHECK(sync_scan_best(&scan, 2, 0x02, 3) == 0x11);
+}
+
+int main(void) {
+    test_init();
+    test_next();
+    test_score();
+    test_best();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,113 @@
+/** @file
+*
+* @brief Host tests of sync_schedule.c: the compare values of the free-running schedule, checked against a
+* tick by tick model of the timer over many periods.
+*
+*/
+
+#include "sync_schedule.h"
+#include "test.h"
+
+#define PERIODS              100000UL
+
+/**
+ * @brief Model of TIMER0 running freely: one step per tick, cleared by the period compare. Every edge time
+ * is compared with sync_schedule_edge_time(), and every period with the configured one.
+ */
+static void check_timeline(const sync_schedule_t *schedule, uint32_t periods) {
+    sync_schedule_cc_t cc;
+    uint32_t           counter = 0;
+    uint64_t           time    = 0;
+    uint32_t           period  = 0;
+    uint64_t           last_start = 0;
+    uint32_t           rises   = 0;
+    uint32_t           falls   = 0;
+
+    CHECK(sync_schedule_compute(schedule, &cc));
+
+    while (period < periods) {
+        time++;
+        counter++;
+
+        if (counter == cc.rise) {
+            CHECK(time == sync_schedule_edge_time(&cc, period, SYNC_SCHEDULE_EDGE_RISE));
+            rises++;
+        }
+        if (counter == cc.fall) {
+            CHECK(time == sync_schedule_edge_time(&cc, period, SYNC_SCHEDULE_EDGE_FALL));
+            falls++;
+        }
+        if (counter == cc.period) {
+            // the radio starts with the clear, the next period begins
+            counter = 0;
+            period++;
+            CHECK(time == sync_schedule_edge_time(&cc, period, SYNC_SCHEDULE_EDGE_RADIO_START));
+            CHECK(time - last_start == schedule->period);
+            last_start = time;
+        }
+    }
+
+    CHECK(rises == periods);
+    CHECK(falls == periods);
+    CHECK(time == (uint64_t)periods * schedule->period);
+}
+
+static void test_compute() {
+    sync_schedule_cc_t cc;
+    sync_schedule_t    schedule = { .period = 1000, .offset = 82, .width = 10 };
+
+    CHECK(sync_schedule_compute(&schedule, &cc));
+    CHECK(cc.rise == 82);
+    CHECK(cc.fall == 92);
+    CHECK(cc.period == 1000);
+
+    // a compare at 0 never fires after a clear
+    schedule.offset = 0;
+    CHECK(!sync_schedule_compute(&schedule, &cc));
+    schedule.offset = 82;
+    schedule.width  = 0;
+    CHECK(!sync_schedule_compute(&schedule, &cc));
+
+    // the falling edge must come strictly before the period end
+    schedule.width = 1000 - 82;
+    CHECK(!sync_schedule_compute(&schedule, &cc));
+    schedule.width = 1000 - 82 - 1;
+    CHECK(sync_schedule_compute(&schedule, &cc));
+
+    // no overflow of offset + width
+    schedule.period = 0xFFFFFFFFUL;
+    schedule.offset = 0x80000000UL;
+    schedule.width  = 0x80000000UL;
+    CHECK(!sync_schedule_compute(&schedule, &cc));
+}
+
+static void test_timeline() {
+    sync_schedule_t short_schedule = { .period = 20,   .offset = 1,  .width = 18 };
+    sync_schedule_t long_schedule  = { .period = 1000, .offset = 82, .width = 10 };
+
+    check_timeline(&short_schedule, PERIODS);
+    check_timeline(&long_schedule, PERIODS / 10);
+}
+
+static void test_no_drift() {
+    sync_schedule_cc_t cc;
+    sync_schedule_t    schedule = { .period = 16000000UL, .offset = 1312, .width = 160000 };   // 1 s at 16 MHz
+
+    CHECK(sync_schedule_compute(&schedule, &cc));
+
+    // the last period before the sequence number wraps is still exactly period_index periods away
+    CHECK(sync_schedule_edge_time(&cc, 0xFFFFFFFFUL, SYNC_SCHEDULE_EDGE_RISE) ==
+          (uint64_t)0xFFFFFFFFUL * 16000000UL + 1312);
+    for (uint32_t i = 1; i < PERIODS; i++) {
+        CHECK(sync_schedule_edge_time(&cc, i, SYNC_SCHEDULE_EDGE_RISE) -
+              sync_schedule_edge_time(&cc, i - 1, SYNC_SCHEDULE_EDGE_RISE) == schedule.period);
+    }
+}
+
+int main(void) {
+    test_compute();
+    test_timeline();
+    test_no_drift();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,189 @@
+/** @file
+*
+* @brief Host tests of sync_servo.c: the receiver pulse grid driven like the firmware does (a compare always
+* programmed, replaced on a restart) by beacons from a transmitter whose crystal drifts, checked pulse by pulse.
+*
+*/
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "sync_servo.h"
+#include "test.h"
+
+#define NOMINAL              1000000U  // PULSE_PERIOD of 1 s at 1 MHz
+#define TOLERANCE            50         // SERVO_TOLERANCE of 0.05 ms
+#define KP_SHIFT             1
+#define KI_SHIFT             3
+#define BEACONS              5000
+#define SETTLE               50         // beacons before the grid is expected to be locked
+
+/**
+ * @brief Receiver side: the servo, its programmed compare and the pulses it generated.
+ */
+typedef struct {
+    sync_servo_t servo;
+    uint32_t     compare;       // TIMER2 CC[1]
+    uint32_t     pulses;
+    uint32_t     resets;
+} receiver_t;
+
+/**
+ * @brief Drift trace: crystal offset of the transmitter in ppm at beacon k, a temperature swing around 20 ppm.
+ */
+static double drift_ppm(uint32_t k, double swing) {
+    return 20.0 + swing * sin(2.0 * 3.14159265358979 * k / 1000.0);
+}
+
+/**
+ * @brief Function for generating the pulses due before time, checking each one against its transmitter period.
+ */
+static void pulses_until(receiver_t *rx, uint32_t time, uint32_t start, const double *grid, uint32_t bound, bool check) {
+    while ((int32_t)(rx->compare - time) < 0) {
+        // one pulse per period from the first beacon, at grid[0]; the timeline is longer than the timer wrap
+        double error = (double)(int32_t)(rx->compare - start - (uint32_t)llround(grid[rx->pulses + 1]));
+
+        if (check) {
+            CHECK(fabs(error) <= bound);
+        }
+        rx->pulses++;
+        rx->compare = sync_servo_advance(&rx->servo);
+    }
+}
+
+static void beacon(receiver_t *rx, uint32_t time) {
+    sync_servo_report_t report;
+
+    sync_servo_beacon(&rx->servo, time, &report);
+    if (report.reset) {
+        rx->compare = sync_servo_advance(&rx->servo);
+        rx->resets++;
+    }
+}
+
+/**
+ * @brief Function for running a drift trace from start (a timer value), with one beacon received every interval
+ * periods and jitter ticks of noise, and checking the pulses stay within bound ticks of the transmitter grid.
+ */
+static void run(uint32_t start, double swing, uint32_t interval, uint32_t jitter, uint32_t bound) {
+    static double grid[BEACONS + 2];
+    receiver_t    rx;
+    uint32_t      seed = 7;
+
+    // transmitter period starts, relative to start, in receiver ticks
+    grid[0] = 0;
+    for (uint32_t k = 1; k < BEACONS + 2; k++) {
+        grid[k] = grid[k - 1] + NOMINAL * (1.0 + drift_ppm(k, swing) / 1e6);
+    }
+
+    sync_servo_init(&rx.servo, NOMINAL, TOLERANCE, KP_SHIFT, KI_SHIFT);
+    rx.pulses = 0;
+    rx.resets = 0;
+
+    for (uint32_t k = 0; k < BEACONS; k += interval) {
+        int32_t  noise = jitter ? (int32_t)(test_rand(&seed) % (2 * jitter + 1)) - (int32_t)jitter : 0;
+        uint32_t time  = start + (uint32_t)llround(grid[k]) + (uint32_t)noise;
+
+        if (k > 0) {
+            pulses_until(&rx, time, start, grid, bound, k > SETTLE * interval);
+        }
+        beacon(&rx, time);
+
+        if (k > SETTLE * interval) {
+            double ppb = ((double)rx.servo.period / (double)(1ULL << SYNC_SERVO_FRAC_BITS) - NOMINAL) * 1e9 / NOMINAL;
+            CHECK(fabs(ppb - drift_ppm(k, swing) * 1000.0) < 2000.0);
+        }
+    }
+
+    // a single start on the first beacon, then one pulse per period up to the last beacon
+    CHECK(rx.resets == 1);
+    CHECK(rx.pulses + 2 * interval >= BEACONS);
+}
+
+static void test_drift() {
+    run(0, 0, 1, 0, 1);
+    run(0, 5, 1, 1, 3);
+    run(0, 5, 4, 1, 6);
+
+    // the 32-bit timer wraps every 71 min at 1 MHz: once in every run, and a few periods after the start here
+    run(0xFFFFFFFFU - 3 * NOMINAL, 5, 1, 1, 3);
+    run(0xFFFFFFFFU - 3 * NOMINAL, 5, 4, 1, 6);
+}
+
+static void test_first_interval() {
+    sync_servo_t        servo;
+    sync_servo_report_t report;
+
+    sync_servo_init(&servo, NOMINAL, TOLERANCE, KP_SHIFT, KI_SHIFT);
+    CHECK(!sync_servo_running(&servo));
+
+    sync_servo_beacon(&servo, 0xFFFFFF00U, &report);
+    CHECK(report.reset);
+    CHECK(sync_servo_running(&servo));
+    CHECK(sync_servo_advance(&servo) == 0xFFFFFF00U + NOMINAL);
+
+    // the first interval sets the period, even across the timer wrap and far from the nominal one
+    sync_servo_beacon(&servo, 0xFFFFFF00U + 2 * (NOMINAL + 100), &report);
+    CHECK(!report.reset);
+    CHECK(report.phase_error == 200);
+    CHECK(servo.period == (uint64_t)(NOMINAL + 100) << SYNC_SERVO_FRAC_BITS);
+    CHECK(report.freq_offset_ppb == 100000);
+
+    // the pulse already programmed is kept, the next one follows the measured grid
+    CHECK(sync_servo_advance(&servo) == 0xFFFFFF00U + 3 * (NOMINAL + 100));
+
+    // a duplicate beacon changes nothing
+    uint64_t next = servo.next;
+    sync_servo_beacon(&servo, 0xFFFFFF00U + 2 * (NOMINAL + 100) + 3, &report);
+    CHECK(!report.reset);
+    CHECK(servo.next == next);
+}
+
+static void test_restart_spacing() {
+    sync_servo_t        servo;
+    sync_servo_report_t report;
+
+    for (uint32_t start = 0; start < 2; start++) {
+        uint32_t base = start ? 0xFFFFFFFFU - NOMINAL : 1000;
+
+        // pulses may be programmed ahead of the beacons, up to a few periods
+        for (uint32_t ahead = 1; ahead <= 3; ahead++) {
+            for (int32_t shift = -(int32_t)NOMINAL / 2 + 1; shift < (int32_t)NOMINAL / 2; shift += (int32_t)NOMINAL / 20) {
+                uint32_t pending = 0;
+
+                if (abs(shift) <= TOLERANCE) {
+                    continue;
+                }
+
+                sync_servo_init(&servo, NOMINAL, TOLERANCE, KP_SHIFT, KI_SHIFT);
+                sync_servo_beacon(&servo, base, &report);
+                sync_servo_beacon(&servo, base + NOMINAL, &report);
+                for (uint32_t i = 0; i < ahead; i++) {
+                    pending = sync_servo_advance(&servo);
+                }
+                CHECK(pending == base + (1 + ahead) * NOMINAL);
+
+                // the transmitter jumps by shift
+                uint32_t time = base + 2 * NOMINAL + (uint32_t)shift;
+                sync_servo_beacon(&servo, time, &report);
+                CHECK(report.reset);
+                CHECK(report.phase_error == shift);
+
+                // the restarted grid follows the beacon, at least half a period after the programmed pulse
+                uint32_t next = sync_servo_advance(&servo);
+                CHECK((next - time) % NOMINAL == 0);
+                CHECK((int32_t)(next - time) > 0);
+                CHECK((int32_t)(next - pending) >= (int32_t)(NOMINAL / 2));
+                CHECK((int32_t)(next - pending) < (int32_t)(NOMINAL + NOMINAL / 2));
+            }
+        }
+    }
+}
+
+int main(void) {
+    test_drift();
+    test_first_interval();
+    test_restart_spacing();
+
+    return TEST_RESULT();
+}
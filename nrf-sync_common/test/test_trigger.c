@@ -0,0 +1,171 @@
+/** @file
+*
+* @brief Host tests of sync_trigger.c: the address trigger links, driven through packets that are good,
+* corrupted before or after the rising edge, or received while a pulse is high.
+*
+*/
+
+#include "sync_trigger.h"
+#include "test.h"
+
+#define RISE                 1          // TRIGGER_DELAY of 1 us at 1 MHz
+#define CRC_END              400        // address to CRC of the 48 byte beacon at 1 Mbit
+#define WIDTH                10000      // PULSE_DURATION of 10 ms
+#define PERIOD               20000
+
+/**
+ * @brief Function for letting time elapse one tick at a time, counting the ticks with the pin high.
+ */
+static uint32_t run(sync_trigger_t *trigger, uint32_t ticks) {
+    uint32_t high = 0;
+
+    for (uint32_t i = 0; i < ticks; i++) {
+        sync_trigger_tick(trigger, 1);
+        if (trigger->pin) {
+            high++;
+        }
+    }
+
+    return high;
+}
+
+/**
+ * @brief Function for receiving one packet, returns the ticks with the pin high until its CRC.
+ */
+static uint32_t packet(sync_trigger_t *trigger, bool good, uint32_t crc_end) {
+    uint32_t high;
+
+    sync_trigger_event(trigger, SYNC_TRIGGER_EVENT_ADDRESS);
+    high = run(trigger, crc_end);
+    sync_trigger_event(trigger, good ? SYNC_TRIGGER_EVENT_CRCOK : SYNC_TRIGGER_EVENT_CRCERROR);
+
+    return high;
+}
+
+static void test_links() {
+    uint32_t channels = 0;
+
+    // one link per channel, none of them on the clock channel 2
+    for (uint32_t i = 0; i < SYNC_TRIGGER_LINKS; i++) {
+        CHECK(!(channels & (1UL << sync_trigger_links[i].channel)));
+        channels |= 1UL << sync_trigger_links[i].channel;
+    }
+    CHECK(!(channels & (1UL << 2)));
+    CHECK((SYNC_TRIGGER_CHANNELS | SYNC_TRIGGER_GROUP_TRIGGER) == channels);
+
+    // the rising edge must not disarm the cancel links
+    CHECK(!(SYNC_TRIGGER_GROUP_PULSE & ~(1UL << 0)));
+    CHECK(!(SYNC_TRIGGER_GROUP_TRIGGER & SYNC_TRIGGER_CHANNELS));
+}
+
+static void test_good() {
+    sync_trigger_t trigger;
+    uint32_t       high;
+
+    sync_trigger_init(&trigger, RISE, RISE + WIDTH);
+
+    for (uint32_t i = 0; i < 3; i++) {
+        high  = packet(&trigger, true, CRC_END);
+        CHECK(trigger.pin);
+        CHECK(!(trigger.chen & SYNC_TRIGGER_GROUP_CANCEL));
+        high += run(&trigger, PERIOD - CRC_END);
+
+        CHECK(high == WIDTH);
+        CHECK(!trigger.pin);
+        CHECK(!trigger.running);
+        CHECK((trigger.chen & SYNC_TRIGGER_CHANNELS) == SYNC_TRIGGER_CHANNELS);
+    }
+}
+
+static void test_cancel_after_rise() {
+    sync_trigger_t trigger;
+    uint32_t       high;
+
+    sync_trigger_init(&trigger, RISE, RISE + WIDTH);
+
+    // the pin went high before the CRC, the error pulls it low at once
+    high = packet(&trigger, false, CRC_END);
+    CHECK(high == CRC_END - RISE + 1);
+    CHECK(!trigger.pin);
+    CHECK(!trigger.running);
+    CHECK(trigger.counter == 0);
+    CHECK(run(&trigger, PERIOD) == 0);
+
+    // the falling edge never came, the cancel rearmed the start link
+    CHECK((trigger.chen & SYNC_TRIGGER_CHANNELS) == SYNC_TRIGGER_CHANNELS);
+    high  = packet(&trigger, true, CRC_END);
+    high += run(&trigger, PERIOD);
+    CHECK(high == WIDTH);
+}
+
+static void test_cancel_before_rise() {
+    sync_trigger_t trigger;
+
+    // a trigger delay past the CRC never lets a corrupted packet through
+    sync_trigger_init(&trigger, CRC_END + 10, CRC_END + 10 + WIDTH);
+
+    CHECK(packet(&trigger, false, CRC_END) == 0);
+    CHECK(run(&trigger, PERIOD) == 0);
+    CHECK(!(trigger.chen & SYNC_TRIGGER_GROUP_TRIGGER));
+
+    CHECK(packet(&trigger, true, CRC_END) == 0);
+    CHECK(run(&trigger, PERIOD) == WIDTH);
+}
+
+static void test_packet_while_high() {
+    sync_trigger_t trigger;
+    uint32_t       high;
+
+    sync_trigger_init(&trigger, RISE, RISE + WIDTH);
+
+    // neither a corrupted nor a good packet changes a pulse whose CRC was good
+    high  = packet(&trigger, true, CRC_END);
+    high += run(&trigger, 1000);
+    high += packet(&trigger, false, CRC_END);
+    CHECK(trigger.pin);
+    high += run(&trigger, 1000);
+    high += packet(&trigger, true, CRC_END);
+    CHECK(trigger.pin);
+    high += run(&trigger, PERIOD);
+
+    CHECK(high == WIDTH);
+    CHECK((trigger.chen & SYNC_TRIGGER_CHANNELS) == SYNC_TRIGGER_CHANNELS);
+}
+
+static void test_random() {
+    sync_trigger_t trigger;
+    uint32_t       seed = 12345;
+
+    sync_trigger_init(&trigger, RISE, RISE + WIDTH);
+
+    // every good beacon gives a full pulse, every corrupted one at most a pulse cut at its CRC
+    for (uint32_t i = 0; i < 10000; i++) {
+        bool good = test_rand(&seed) % 4 != 0;
+        bool echo = good && test_rand(&seed) % 8 == 0;
+
+        uint32_t high = packet(&trigger, good, CRC_END);
+        if (echo) {
+            // a duplicate while the pin is high, with a CRC error half of the time
+            high += run(&trigger, 2000);
+            high += packet(&trigger, test_rand(&seed) % 2 == 0, CRC_END);
+            high += run(&trigger, PERIOD - 2000 - 2 * CRC_END);
+        } else {
+            high += run(&trigger, PERIOD - CRC_END);
+        }
+
+        CHECK(high == (good ? WIDTH : CRC_END - RISE + 1));
+        CHECK(!trigger.pin);
+        CHECK(!trigger.running);
+    }
+}
+
+int main(void) {
+    test_links();
+    test_good();
+    test_cancel_after_rise();
+    test_cancel_before_rise();
+    test_packet_while_high();
+    test_random();
+
+    return TEST_RESULT();
+}
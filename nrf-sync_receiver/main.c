@@ -15,6 +15,24 @@
 #include "nrf52840_bitfields.h"
 #include "nrf52840.h"
 #include "nrf52840_peripherals.h"
+#include "app_error.h"
+#include "nrf_log.h"
+#include "nrf_log_ctrl.h"
+#include "nrf_log_default_backends.h"
+#include "sync_timing.h"
+#include "sync_phy.h"
+#include "sync_calib.h"
+#include "sync_trigger.h"
+#include "sync_holdover.h"
+#include "sync_servo.h"
+#include "sync_beacon.h"
+#include "sync_window.h"
+#include "sync_outputs.h"
+#include "sync_pwm.h"
+#include "sync_clock.h"
+#include "sync_hop.h"
+#include "sync_burst.h"
+#include "sync_twoway.h"
 
 //GPIOTE stuff
 #define OUTPUT_PIN_NUMBER    10UL      // output pin number
@@ -22,35 +40,452 @@
 
 #define GPIOTE_CH            0
 
+#define PPI_GROUP_PULSE      1         // channel group holding the pulse start links, disabled while the pin is high
+
 //TIMER stuff
-#define PULSE_DURATION       10        // time in ms
+#define PULSE_DURATION       10        // time in ms, until the first beacon announces the width
+#define PULSE_PERIOD         1000      // time in ms, expected beacon period until the first beacon announces it
+                                       // (first guess of the holdover and servo)
+
+//Resolution stuff
+#define TIMER_HIGH_RESOLUTION 0        // 1: timers run at 16 MHz (62.5 ns ticks), periods up to ~268 s
+                                       // 0: timers run at 1 MHz (1 us ticks), periods up to ~71 min
+
+#if TIMER_HIGH_RESOLUTION
+#define TIMER_PRESCALER      SYNC_PRESCALER_16MHZ
+#else
+#define TIMER_PRESCALER      SYNC_PRESCALER_1MHZ
+#endif
+
+#define MS_TO_TICKS(ms)      SYNC_MS_TO_TICKS(ms, TIMER_PRESCALER)
+
+#if !SYNC_TICKS_FIT_32BIT(PULSE_DURATION, TIMER_PRESCALER)
+#error "PULSE_DURATION overflows the 32-bit timer at this resolution"
+#endif
+
+// TIMER0 only times the pulse width from the beacon, so the period itself can be longer than the timer
+// (transmitter DUTY_CYCLE_MODE); only the modes predicting beacons on TIMER2 need it in ticks
+#if SYNC_TICKS_FIT_32BIT(PULSE_PERIOD, TIMER_PRESCALER)
+#define PULSE_PERIOD_TICKS   MS_TO_TICKS(PULSE_PERIOD)
+#else
+#define PULSE_PERIOD_TICKS   0
+#endif
+
+//Trigger stuff
+#define TRIGGER_ON_ADDRESS   0         // 1: the pulse is armed on EVENTS_ADDRESS and cancelled on EVENTS_CRCERROR
+                                       // 0: the pulse starts on EVENTS_CRCOK
+#define TRIGGER_DELAY        0.001     // time in ms from EVENTS_ADDRESS to the rising edge (TRIGGER_ON_ADDRESS only), same
+                                       // as the transmitter. Below the payload + CRC airtime the edge comes before the CRC
+                                       // and a corrupted packet gives a pulse cut short at the CRC error; above it, no
+                                       // pulse at all but no time saved
+
+#define PPI_GROUP_TRIGGER    0         // channel group holding the rising edge link (TRIGGER_ON_ADDRESS only)
+#define PPI_GROUP_CANCEL     2         // channel group holding the cancel links, disabled once the CRC is good
+                                       // (TRIGGER_ON_ADDRESS only, free since HOLDOVER_MODE is excluded)
+
+//Holdover stuff
+#define HOLDOVER_MODE        0         // 1: when a beacon is missing, pulse anyway at the time predicted by TIMER2
+#define HOLDOVER_TOLERANCE   0.05      // time in ms, max distance to the prediction for a beacon to be on schedule,
+                                       // also the delay of a holdover pulse so that a late beacon still comes first
+#define HOLDOVER_MAX_PERIODS 60        // stop pulsing after this many missed beacons in a row
+
+#define PPI_GROUP_HOLDOVER   2         // channel group holding the holdover pulse links (HOLDOVER_MODE only)
+
+#if HOLDOVER_MODE && TRIGGER_ON_ADDRESS
+#error "HOLDOVER_MODE only supports the CRCOK trigger, disable TRIGGER_ON_ADDRESS"
+#endif
+
+#if HOLDOVER_MODE && !SYNC_TICKS_FIT_32BIT(PULSE_PERIOD, TIMER_PRESCALER)
+#error "HOLDOVER_MODE needs PULSE_PERIOD to fit in the 32-bit timer at this resolution"
+#endif
+
+//Servo stuff
+#define SERVO_MODE           0         // 1: every pulse is generated by TIMER2 on a grid disciplined by the beacons
+                                       //    (phase and crystal frequency offset), beacons no longer start pulses
+#define SERVO_TOLERANCE      0.05      // time in ms, a beacon further than this from the grid restarts it
+#define SERVO_KP_SHIFT       1         // phase gain is 1 / 2^SERVO_KP_SHIFT
+#define SERVO_KI_SHIFT       3         // frequency gain is 1 / 2^SERVO_KI_SHIFT
+#define SERVO_LOG_BEACONS    16        // log the servo state every this many beacons
+
+#if SERVO_MODE && (HOLDOVER_MODE || TRIGGER_ON_ADDRESS)
+#error "SERVO_MODE replaces HOLDOVER_MODE and only supports the CRCOK trigger"
+#endif
+
+#if SERVO_MODE && !SYNC_TICKS_FIT_32BIT(PULSE_PERIOD, TIMER_PRESCALER)
+#error "SERVO_MODE needs PULSE_PERIOD to fit in the 32-bit timer at this resolution"
+#endif
+
+//Clock stuff
+#define CLOCK_MODE           0         // 1: PWM1 outputs a square wave of CLOCK_FREQUENCY phase-locked to the servo grid
+#define CLOCK_FREQUENCY      1000      // frequency in Hz, CLOCK_CYCLES cycles per period
+#define CLOCK_PIN_NUMBER     14UL      // clock output pin number
+#define CLOCK_PIN_PORT       1UL       // clock output pin port
+#define CLOCK_PWM_PRESCALER  SYNC_PRESCALER_16MHZ  // PWM clock, same encoding as the TIMER prescaler
+#define CLOCK_BUFFER_CYCLES  32        // cycles per half buffer, a half is refilled while the other one plays
+
+#define CLOCK_CYCLES         (CLOCK_FREQUENCY * PULSE_PERIOD / 1000)
+#define CLOCK_TICK_SHIFT     (TIMER_PRESCALER - CLOCK_PWM_PRESCALER)   // TIMER ticks to PWM ticks
+
+#define PPI_GROUP_CLOCK      3         // channel group holding the clock start link, disabled once the clock runs
+
+#if CLOCK_MODE && !SERVO_MODE
+#error "CLOCK_MODE follows the grid of SERVO_MODE"
+#endif
+
+#if CLOCK_MODE && (CLOCK_PWM_PRESCALER > TIMER_PRESCALER)
+#error "CLOCK_PWM_PRESCALER must be at least as fast as the TIMER"
+#endif
+
+#if CLOCK_MODE && (2 * CLOCK_BUFFER_CYCLES >= CLOCK_CYCLES)
+#error "CLOCK_FREQUENCY is too low for the buffers, lower CLOCK_BUFFER_CYCLES"
+#endif
+
+//Beacon stuff
+#define BEACON_LOG_MODE      0         // 1: log the missed beacons, the schedule changes and the beacon statistics
+                                       //    (also logged with any mode that logs)
+#define BEACON_LOG_BEACONS   64        // log the beacon statistics every this many beacons
+
+//Window stuff
+#define RX_WINDOW_MODE       0         // 1: once a beacon is received, the radio only listens in a window around
+                                       //    the next one (TIMER2 enables and disables it through PPI)
+#define RX_WINDOW_GUARD      0.1       // time in ms, margin on each side of the expected beacon, widened by this
+                                       // much for every missed beacon
+#define RX_WINDOW_GUARD_MAX  5         // time in ms, widest margin
+#define RX_WINDOW_MAX_MISSES 10        // listen continuously again after this many missed beacons in a row
+#define RX_WINDOW_LEAD       (RADIO_RAMPUP + SYNC_PHY_AIRTIME_MS(RADIO_PHY, PACKET_BALEN + 1, PACKET_LENGTH, PACKET_CRC_LENGTH) + \
+                              SYNC_PHY_RX_CHAIN_DELAY_MS(RADIO_PHY))   // time in ms from RXEN to the CRCOK of a beacon
+
+#if RX_WINDOW_MODE && !SYNC_TICKS_FIT_32BIT(PULSE_PERIOD, TIMER_PRESCALER)
+#error "RX_WINDOW_MODE needs PULSE_PERIOD to fit in the 32-bit timer at this resolution"
+#endif
+
+//Outputs stuff
+#define OUTPUTS_MODE         0         // 1: also drive the outputs of OUTPUT_TABLE, each with its own delay after the
+                                       //    rising edge of the pulse and its own width (TIMER3 and TIMER4)
+#define OUTPUT_TABLE         { OUTPUT(1UL, 11UL, 1, 2),     \
+                               OUTPUT(1UL, 12UL, 5, 0.5) }  // (port, pin, delay in ms, width in ms), same as the transmitter
+#define OUTPUT_GPIOTE_FIRST  1         // GPIOTE channel of the first output, then one per output
+#define OUTPUT_PPI_FIRST     15        // PPI channel starting the output timers, then two per output
+#define OUTPUT_LATENCY       1         // ticks from the rising edge to the start of the output timers (TIMER0 COMPARE[2])
+
+#define OUTPUT(port, pin, delay, width) { (port), (pin), MS_TO_TICKS(delay), MS_TO_TICKS(width) }
+
+#define OUTPUT_MAX_GPIOTE    (GPIOTE_CH_NUM - OUTPUT_GPIOTE_FIRST)
+#define OUTPUT_MAX_PPI       ((PPI_CH_NUM - OUTPUT_PPI_FIRST - 1) / 2)
+#define OUTPUT_MAX_TIMER     (2 * (TIMER3_CC_NUM / 2))
+
+//PWM stuff
+#define PWM_SEQUENCE_MODE    0         // 1: the rising edge also starts PWM0, which plays PWM_PATTERN on its own pin
+                                       //    from RAM through EasyDMA (bursts, trains, encoded IDs), with no CPU
+#define PWM_PIN_NUMBER       13UL      // PWM output pin number
+#define PWM_PIN_PORT         1UL       // PWM output pin port
+#define PWM_PATTERN          { PWM_SEGMENT(1, 0.1), PWM_SEGMENT(0, 0.1), PWM_SEGMENT(1, 0.1), \
+                               PWM_SEGMENT(0, 0.3), PWM_SEGMENT(1, 0.5) }   // (level, time in ms) from the rising
+                                                                            // edge, same as the transmitter
+#define PWM_SLOT             0.1       // time in ms of one PWM period, holding at most one edge of the pattern
+#define PWM_PRESCALER        SYNC_PRESCALER_16MHZ  // PWM clock, same encoding as the TIMER prescaler
+#define PWM_SEQUENCE_MAX     64        // longest sequence in slots
+#define PWM_PPI_CH           14        // PPI channel starting the sequence
+
+#define PWM_MS_TO_TICKS(ms)  SYNC_MS_TO_TICKS(ms, PWM_PRESCALER)
+#define PWM_SEGMENT(level, time) { (level), PWM_MS_TO_TICKS(time) }
+
+#if PWM_SEQUENCE_MODE && (TRIGGER_ON_ADDRESS || HOLDOVER_MODE || SERVO_MODE)
+#error "PWM_SEQUENCE_MODE is started by EVENTS_CRCOK, which is only the rising edge with the plain CRCOK trigger"
+#endif
+
+//Group stuff
+#define GROUP_ADDRESS        0         // logical address (0 to 7) of the transmitter followed on OUTPUT_PIN, see its GROUP_ADDRESS
+#define GROUP_MODE           0         // 1: also follow the transmitters of GROUP_TABLE on the same frequency, each on
+                                       //    its own pin (TIMER3 and TIMER4), a beacon only pulses the pin of its group
+#define GROUP_TABLE          { GROUP(1, 1UL, 11UL), GROUP(2, 1UL, 12UL) }
+#define GROUP_GPIOTE_FIRST   1         // GPIOTE channel of the first group of GROUP_TABLE, then one per group
+#define GROUP_PPI_FIRST      14        // PPI channel of the first group of GROUP_TABLE, then three per group
+#define GROUP_PPI_GROUP_FIRST 4        // PPI channel group of the first group of GROUP_TABLE, then one per group
+#define GROUP_ROUTE_LATENCY  0.1       // time in ms, bound on the ADDRESS interrupt latency plus the routing: the
+                                       // interrupt entry, and the longest handler of the same priority it may wait
+                                       // for (the CRCOK of another group, TIMER0, TIMER2 or PWM1, tens of us at most)
+
+#define GROUP(address, port, pin) { (address), (port), (pin) }
+
+#define GROUP_MAX_TIMER      2         // one timer per group, TIMER3 and TIMER4
+
+#if GROUP_ADDRESS > 7
+#error "GROUP_ADDRESS must be a logical address from 0 to 7"
+#endif
+
+#if GROUP_MODE && (TRIGGER_ON_ADDRESS || RX_WINDOW_MODE)
+#error "GROUP_MODE routes the beacon links on EVENTS_ADDRESS, which needs the plain CRCOK trigger and the radio always listening"
+#endif
+
+#if GROUP_MODE && (OUTPUTS_MODE || PWM_SEQUENCE_MODE)
+#error "GROUP_MODE uses TIMER3, TIMER4 and PPI channels 14 to 19, like OUTPUTS_MODE and PWM_SEQUENCE_MODE"
+#endif
+
+//Hop stuff
+#define HOP_MODE             0         // 1: follow the channel of every beacon (sync_hop.h), retuning right after it, and
+                                       //    count the beacons lost on every channel
+#define HOP_TABLE            { 4, 9, 14, 19, 24, 29, 34, 39, 44, 49, 54, 59, 64, 69, 74, 79 }   // FREQUENCY values
+                                       // (2400 + n MHz), same as the transmitter
+#define HOP_MAP              0xFFFFUL  // channel map until the first beacon, its first channel is searched
+#define HOP_SEED             GROUP_ADDRESS   // key of the hop sequence, same as the transmitter
+#define HOP_MAX_MISSES       4         // missed beacons in a row before searching on the first channel of the map
+#define HOP_SEARCH_DWELL     16        // missed periods on a channel before searching on the next one of HOP_TABLE
+#define HOP_LOG_BEACONS      256       // log the suggested channel map every this many beacons, then restart the counts
+#define HOP_BLACKLIST_BEACONS 8        // beacons on a channel before its loss is trusted
+#define HOP_BLACKLIST_LOSS   200       // loss in per mille above which a channel is left out of the suggested map,
+                                       // the loss of such a channel is also logged to be reported to the transmitter
+
+#if HOP_MODE && !SYNC_TICKS_FIT_32BIT(PULSE_PERIOD, TIMER_PRESCALER)
+#error "HOP_MODE follows the missed beacons on TIMER2, PULSE_PERIOD must fit in it"
+#endif
+
+#if HOP_MODE && GROUP_MODE
+#error "HOP_MODE follows the channel of one transmitter, GROUP_MODE needs all groups on the same channel"
+#endif
+
+//Calibration stuff
+#define CALIBRATION_MODE     0         // 1: measure the delay between END and the pulse trigger and log it, so it can
+                                       //    be set as CALIB_RX_TRIGGER_DELAY on the transmitter
+#define CALIB_SAMPLES        16        // number of packets averaged for each report
+
+//Burst stuff
+#define BURST_MODE           0         // 1: the beacons come in bursts of BURST_COPIES copies (sync_burst.h), the first copy
+                                       //    received starts TIMER0 and the rising edge waits for the delay of its copy
+                                       //    index, so every copy gives the same edge
+#define BURST_COPIES         3         // copies per beacon, same as the transmitter
+#define BURST_SPACING        600       // time in us between the starts of two copies, same as the transmitter
+#define BURST_MARGIN         50        // time in us from the last copy to the rising edge, same as the transmitter:
+                                       // a bound on the CRCOK interrupt latency
+#define BURST_PPI_CH         5         // PPI channel of the rising edge (free without TRIGGER_ON_ADDRESS)
+
+#if BURST_MODE && (BURST_COPIES < 2 || BURST_COPIES > SYNC_BURST_MAX_COPIES)
+#error "BURST_COPIES must be from 2 to SYNC_BURST_MAX_COPIES"
+#endif
+
+#if BURST_MODE && TRIGGER_ON_ADDRESS
+#error "BURST_MODE sets the rising edge with TIMER0 CC[1] and PPI channel 5, like TRIGGER_ON_ADDRESS"
+#endif
+
+#if BURST_MODE && (HOLDOVER_MODE || SERVO_MODE || RX_WINDOW_MODE)
+#error "HOLDOVER_MODE, SERVO_MODE and RX_WINDOW_MODE predict the beacons on TIMER2 without the delay of BURST_MODE"
+#endif
+
+#if BURST_MODE && (GROUP_MODE || OUTPUTS_MODE || PWM_SEQUENCE_MODE || CALIBRATION_MODE)
+#error "GROUP_MODE, OUTPUTS_MODE, PWM_SEQUENCE_MODE and CALIBRATION_MODE start from the beacon, not from the delayed edge of BURST_MODE"
+#endif
+
+//Two-way stuff
+#define TWO_WAY_MODE         0         // 1: send a two-way request after the beacons of the slot of TWO_WAY_NODE (sync_twoway.h)
+                                       //    and set the rising edge from the measured delay, TIMER0 CC[1] after the beacon
+#define TWO_WAY_NODE         0         // slot of this receiver, from 0 to TWO_WAY_NODES - 1, one receiver per slot
+#define TWO_WAY_NODES        4         // receivers taking turns, same as the transmitter
+#define TWO_WAY_ADDRESS      7         // logical address of the requests, same as the transmitter
+#define TWO_WAY_REPLY_DELAY  500       // time in us from the beacon CRCOK to the request start, same as the transmitter
+#define TWO_WAY_HEADROOM     0.05      // time in ms the transmitter adds to its offset, same as the transmitter
+#define TWO_WAY_SAMPLES      8         // exchanges averaged for each correction
+#define TWO_WAY_PPI_FIRST    5         // PPI channel of the rising edge, then of the request start and of its timestamp
+                                       // (free without TRIGGER_ON_ADDRESS)
+#define TWO_WAY_NOMINAL      (SYNC_PHY_ADDRESS_TO_END_MS(RADIO_PHY, PACKET_LENGTH, PACKET_CRC_LENGTH) + \
+                              SYNC_PHY_RX_CHAIN_DELAY_MS(RADIO_PHY))   // time in ms from the transmitter address to the
+                                                                       // CRCOK, as assumed by the transmitter offset
+
+#if TWO_WAY_MODE && (TWO_WAY_NODES < 1 || TWO_WAY_NODES > SYNC_TWOWAY_MAX_NODES || TWO_WAY_NODE >= TWO_WAY_NODES)
+#error "TWO_WAY_NODE must be from 0 to TWO_WAY_NODES - 1, TWO_WAY_NODES at most SYNC_TWOWAY_MAX_NODES"
+#endif
+
+#if TWO_WAY_MODE && (TWO_WAY_ADDRESS > 7 || TWO_WAY_ADDRESS == GROUP_ADDRESS)
+#error "TWO_WAY_ADDRESS must be a logical address (0 to 7) other than GROUP_ADDRESS"
+#endif
+
+#if TWO_WAY_MODE && (TRIGGER_ON_ADDRESS || HOLDOVER_MODE || SERVO_MODE || RX_WINDOW_MODE)
+#error "TWO_WAY_MODE sets the rising edge with TIMER0 CC[1] after the CRCOK, the other triggers do not follow it"
+#endif
+
+#if TWO_WAY_MODE && (BURST_MODE || GROUP_MODE || OUTPUTS_MODE || PWM_SEQUENCE_MODE || CALIBRATION_MODE)
+#error "BURST_MODE, GROUP_MODE, OUTPUTS_MODE, PWM_SEQUENCE_MODE and CALIBRATION_MODE start from the beacon, not from the edge of TWO_WAY_MODE"
+#endif
+
+//Log stuff
+#define LOG_MODE             (BEACON_LOG_MODE || HOLDOVER_MODE || SERVO_MODE || CLOCK_MODE || RX_WINDOW_MODE || \
+                              OUTPUTS_MODE || PWM_SEQUENCE_MODE || GROUP_MODE || HOP_MODE || CALIBRATION_MODE || \
+                              BURST_MODE || TWO_WAY_MODE)    // the modes that log, the logger is only built for them
 
 //Radio stuff
-static uint8_t packet;                 // packet will be stored here 
+#define RADIO_PHY            SYNC_PHY_NRF_1MBIT    // one of SYNC_PHY_NRF_1MBIT, SYNC_PHY_NRF_2MBIT, SYNC_PHY_BLE_1MBIT,
+                                                   // SYNC_PHY_BLE_2MBIT, SYNC_PHY_BLE_LR125KBIT or SYNC_PHY_BLE_LR500KBIT
+                                                   // (long range), must be the same on both boards
+#define PACKET_BALEN         SYNC_PHY_BALEN(RADIO_PHY)   // base address length in bytes (plus 1 prefix byte)
+#define PACKET_LENGTH        SYNC_BEACON_LENGTH    // payload length in bytes (see sync_beacon.h)
+#define PACKET_CRC_LENGTH    2UL       // CRC length in bytes
+#define RADIO_FAST_RAMPUP    0         // 1: MODECNF0.RU = Fast, TXEN/RXEN to READY in ~40 us instead of ~140 us
+
+#if RADIO_FAST_RAMPUP
+#define RADIO_RAMPUP         SYNC_RADIO_RAMPUP_FAST_MS     // time in ms
+#define RADIO_RU             RADIO_MODECNF0_RU_Fast
+#else
+#define RADIO_RAMPUP         SYNC_RADIO_RAMPUP_DEFAULT_MS  // time in ms
+#define RADIO_RU             RADIO_MODECNF0_RU_Default
+#endif
+
+static uint8_t packet[PACKET_LENGTH];  // packet will be stored here, parsed in place
+
+static sync_beacon_stats_t beacon_stats;
+static uint32_t            beacon_period;      // period in ticks, as announced by the last beacon
+static uint32_t            beacon_width;       // pulse width in ticks, written into TIMER0 at the end of the next pulse
+static uint32_t            beacon_switch;      // switch sequence of the last schedule change logged
+
+#if PWM_SEQUENCE_MODE
+static const sync_pwm_segment_t pwm_pattern[] = PWM_PATTERN;
+static uint16_t                 pwm_sequence[PWM_SEQUENCE_MAX];   // read by PWM0 through EasyDMA
+
+#define PWM_SEGMENTS         (sizeof(pwm_pattern) / sizeof(pwm_pattern[0]))
+
+_Static_assert(PWM_MS_TO_TICKS(PWM_SLOT) <= SYNC_PWM_COUNTERTOP_MAX, "PWM_SLOT is longer than a PWM period can be at this PWM_PRESCALER");
+#endif
+
+#if GROUP_MODE
+typedef struct {
+    uint32_t address;   // logical address of the transmitter of the group
+    uint32_t port;
+    uint32_t pin;
+} group_t;
+
+static const group_t         groups[]     = GROUP_TABLE;
+static NRF_TIMER_Type *const group_timers[GROUP_MAX_TIMER] = { NRF_TIMER3, NRF_TIMER4 };
+static sync_beacon_stats_t   group_stats[sizeof(groups) / sizeof(groups[0])];
+static uint32_t              group_width[sizeof(groups) / sizeof(groups[0])];  // pulse width in ticks, as beacon_width
+static volatile uint8_t      group_route;  // chain of the beacon being received: 0 for GROUP_ADDRESS, 1 + i for groups[i]
+#define GROUP_COUNT          (sizeof(groups) / sizeof(groups[0]))
+
+_Static_assert(GROUP_COUNT <= GROUP_MAX_TIMER, "GROUP_TABLE has more groups than timers");
+_Static_assert(GROUP_GPIOTE_FIRST + GROUP_COUNT <= GPIOTE_CH_NUM, "GROUP_TABLE needs more GPIOTE channels than available");
+_Static_assert(GROUP_PPI_FIRST + 3 * GROUP_COUNT <= PPI_CH_NUM, "GROUP_TABLE needs more PPI channels than available");
+_Static_assert(GROUP_PPI_GROUP_FIRST + GROUP_COUNT <= PPI_GROUP_NUM, "GROUP_TABLE needs more PPI channel groups than available");
+_Static_assert(GROUP_ROUTE_LATENCY < SYNC_PHY_ADDRESS_TO_END_MS(RADIO_PHY, PACKET_LENGTH, PACKET_CRC_LENGTH) +
+                                     SYNC_PHY_RX_CHAIN_DELAY_MS(RADIO_PHY),
+               "the beacon is too short at this RADIO_PHY for the ADDRESS interrupt to route it before its CRCOK");
+#endif
+
+#if HOP_MODE
+static const uint8_t    hop_table[] = HOP_TABLE;
+static sync_hop_rx_t    hop;
+static sync_hop_stats_t hop_stats;
+static uint8_t          hop_index;             // entry of hop_table the radio is tuned to
+
+#define HOP_CHANNELS         (sizeof(hop_table) / sizeof(hop_table[0]))
+
+_Static_assert(HOP_CHANNELS <= SYNC_HOP_MAX_CHANNELS, "HOP_TABLE has more channels than the channel map");
+_Static_assert(HOP_MAP != 0 && ((uint64_t)HOP_MAP >> HOP_CHANNELS) == 0, "HOP_MAP must select channels of HOP_TABLE");
+#endif
+
+#if BURST_MODE
+static uint32_t burst_cc[BURST_COPIES];        // TIMER0 CC[1] for every copy index, in ticks
+static uint32_t burst_first[BURST_COPIES];     // beacons by the first copy received, since the last log
+static uint32_t burst_sequence;                // sequence number of the last beacon handled
+static bool     burst_has_sequence;
+#endif
+
+#if TWO_WAY_MODE
+static uint8_t       twoway_packet[PACKET_LENGTH];   // request, sent after the beacons of the slot
+static sync_twoway_t twoway;
+static uint32_t      twoway_edge;              // TIMER0 CC[1], written once TIMER0 stops
+static uint32_t      twoway_beacon;            // CRCOK time of the beacon answered (t2)
+static uint32_t      twoway_turnaround;        // from the CRCOK of the beacon to the address of the request (t3 - t2)
+static uint32_t      twoway_sequence;          // sequence number of the beacon answered
+static uint32_t      twoway_lost;              // requests the transmitter did not answer, since the last report
+static uint32_t      twoway_start;             // TIMER2 time the request is due at
+static uint32_t      twoway_next;              // sequence number of the beacon the pending request answers
+static bool          twoway_requesting;        // the request is sent once the radio is disabled
+static volatile bool twoway_sending;           // the request is on air, cleared at its END
+static bool          twoway_sent;              // the request after beacon twoway_sequence was sent
+
+_Static_assert(TWO_WAY_REPLY_DELAY > 2000 * RADIO_RAMPUP, "TWO_WAY_REPLY_DELAY must cover the radio turnaround of both boards");
+#endif
+
+#if CALIBRATION_MODE
+static sync_calib_t calib;
+#endif
+
+#if HOLDOVER_MODE
+static sync_holdover_t holdover;
+#endif
+
+#if SERVO_MODE
+static sync_servo_t servo;
+#endif
+
+#if CLOCK_MODE
+static sync_clock_t clock_synth;
+static uint16_t     clock_buffer[2][CLOCK_BUFFER_CYCLES * SYNC_CLOCK_WAVE_VALUES];   // read by PWM1 through EasyDMA
+#endif
+
+#if RX_WINDOW_MODE
+static sync_window_t window;
+#endif
+
+#if HOP_MODE || TWO_WAY_MODE || RX_WINDOW_MODE
+static bool radio_relisten;                    // listen again once the radio is disabled, see radio_disabled()
+#endif
+
+#if OUTPUTS_MODE
+static const sync_output_t outputs[] = OUTPUT_TABLE;
+
+#define OUTPUT_COUNT         (sizeof(outputs) / sizeof(outputs[0]))
+
+_Static_assert(OUTPUT_COUNT <= OUTPUT_MAX_GPIOTE, "OUTPUT_TABLE needs more GPIOTE channels than available");
+_Static_assert(OUTPUT_COUNT <= OUTPUT_MAX_PPI,    "OUTPUT_TABLE needs more PPI channels than available");
+_Static_assert(OUTPUT_COUNT <= OUTPUT_MAX_TIMER,  "OUTPUT_TABLE needs more TIMER3/TIMER4 compares than available");
+#endif
 
 
 /**
  * @brief Function for initializing output pin with GPIOTE. 
- * It will be set in Task mode with action on pin configured 
- * to toggle. Pin is set to begin low. 
+ * It will be set in Task mode, edges are driven with TASKS_SET and TASKS_CLR 
+ * so a repeated or lost event can never invert the pin. Pin is set to begin low. 
  */
 void gpiote_setup() {
     NRF_GPIOTE->CONFIG[GPIOTE_CH] = (GPIOTE_CONFIG_MODE_Task       << GPIOTE_CONFIG_MODE_Pos)     |
                                     (OUTPUT_PIN_NUMBER             << GPIOTE_CONFIG_PSEL_Pos)     |
                                     (OUTPUT_PIN_PORT               << GPIOTE_CONFIG_PORT_Pos)     |
-                                    (GPIOTE_CONFIG_POLARITY_Toggle << GPIOTE_CONFIG_POLARITY_Pos) |
+                                    (GPIOTE_CONFIG_POLARITY_None   << GPIOTE_CONFIG_POLARITY_Pos) |
                                     (GPIOTE_CONFIG_OUTINIT_Low     << GPIOTE_CONFIG_OUTINIT_Pos);
 }
 
+#if TRIGGER_ON_ADDRESS
+
+/**
+ * @brief Function for initializing TIMER0 for the address trigger.
+ * This Timer will be in charge of managing the trigger delay and the pulse duration.
+ * PRESCALER = TIMER_PRESCALER, MODE = Timer
+ */
+void timer0_setup() {
+    NRF_TIMER0->BITMODE   = TIMER_BITMODE_BITMODE_32Bit;
+    NRF_TIMER0->PRESCALER = TIMER_PRESCALER;
+
+    NRF_TIMER0->CC[1]   = MS_TO_TICKS(TRIGGER_DELAY);
+    NRF_TIMER0->CC[0]   = MS_TO_TICKS(TRIGGER_DELAY) + MS_TO_TICKS(PULSE_DURATION);
+
+    // event when CC[1] will be connected via PPI to the GPIOTE task (only while the trigger is armed)
+    // event when CC[0] will be connected via PPI to the GPIOTE task and shortcutted to clear timer
+    // task and to stop timer.
+
+    NRF_TIMER0->SHORTS  = (TIMER_SHORTS_COMPARE0_CLEAR_Enabled << TIMER_SHORTS_COMPARE0_CLEAR_Pos) |
+                          (TIMER_SHORTS_COMPARE0_STOP_Enabled  << TIMER_SHORTS_COMPARE0_STOP_Pos);
+}
+
+#else
+
 /**
  * @brief Function for initializing TIMER0. 
  * This Timer will be in charge of managing the pulse duration and frequency.
- * Default values: PRESCALER = 4, MODE = Timer
+ * PRESCALER = TIMER_PRESCALER, MODE = Timer
  */
 void timer0_setup() {
-    NRF_TIMER0->BITMODE = TIMER_BITMODE_BITMODE_32Bit;
+    NRF_TIMER0->BITMODE   = TIMER_BITMODE_BITMODE_32Bit;
+    NRF_TIMER0->PRESCALER = TIMER_PRESCALER;
 
-    NRF_TIMER0->CC[0]   = PULSE_DURATION * 1000;
+    NRF_TIMER0->CC[0]   = MS_TO_TICKS(PULSE_DURATION);
 
     // event when CC[0] will be connected via PPI to the GPIOTE task and shortcutted to clear timer 
     // task and to stop timer.
@@ -59,9 +494,13 @@ void timer0_setup() {
                           (TIMER_SHORTS_COMPARE0_STOP_Enabled  << TIMER_SHORTS_COMPARE0_STOP_Pos);
 }
 
+#endif // TRIGGER_ON_ADDRESS
+
 void radio_setup() {
     NRF_RADIO->FREQUENCY     = 7UL; // frequency bin 7, 2407MHz
-    NRF_RADIO->MODE          = (RADIO_MODE_MODE_Nrf_1Mbit << RADIO_MODE_MODE_Pos);
+    NRF_RADIO->MODE          = (SYNC_PHY_MODE(RADIO_PHY) << RADIO_MODE_MODE_Pos);
+    NRF_RADIO->MODECNF0      = (RADIO_RU                   << RADIO_MODECNF0_RU_Pos) |   // ramp-up time
+                               (RADIO_MODECNF0_DTX_Center  << RADIO_MODECNF0_DTX_Pos);   // default TX value (reset value)
 
     // address configuration (just random numbers I chose)
     NRF_RADIO->PREFIX0       = (0xF3UL << RADIO_PREFIX0_AP3_Pos) |   // prefix byte of address 3
@@ -78,14 +517,14 @@ void radio_setup() {
 
     NRF_RADIO->BASE1         = 0x16081931UL;     // base address for prefix 1-7
 
-    NRF_RADIO->RXADDRESSES   = (RADIO_RXADDRESSES_ADDR0_Enabled << RADIO_RXADDRESSES_ADDR0_Pos);   // receive from address 0
+    NRF_RADIO->RXADDRESSES   = (1UL << GROUP_ADDRESS);   // receive from the followed transmitter (GROUP_MODE adds its groups)
 
     // packet configuration
-    NRF_RADIO->PCNF0    = 0UL; //not really interested in these
+    NRF_RADIO->PCNF0    = SYNC_PHY_PCNF0(RADIO_PHY); // preamble length (and coded PHY fields), the rest is not used
 
-    NRF_RADIO->PCNF1    = (1UL                          << RADIO_PCNF1_MAXLEN_Pos)  |    // only sending a 1 byte number
-                          (1UL                          << RADIO_PCNF1_STATLEN_Pos) |    // since the LENGHT field is not set, this specifies the lenght of the payload
-                          (4UL                          << RADIO_PCNF1_BALEN_Pos)   |
+    NRF_RADIO->PCNF1    = (PACKET_LENGTH                << RADIO_PCNF1_MAXLEN_Pos)  |    // only receiving the beacon
+                          (PACKET_LENGTH                << RADIO_PCNF1_STATLEN_Pos) |    // since the LENGHT field is not set, this specifies the lenght of the payload
+                          (PACKET_BALEN                 << RADIO_PCNF1_BALEN_Pos)   |
                           (RADIO_PCNF1_ENDIAN_Little    << RADIO_PCNF1_ENDIAN_Pos)  | 
                           (RADIO_PCNF1_WHITEEN_Disabled << RADIO_PCNF1_WHITEEN_Pos);
 
@@ -101,58 +540,1605 @@ void radio_setup() {
     NRF_RADIO->CRCPOLY  = 0x11021UL;                                      // CRC poly: x^16 + x^12^x^5 + 1
 
     // pointer to packet payload
-    NRF_RADIO->PACKETPTR = (uint32_t)&packet;
+    NRF_RADIO->PACKETPTR = (uint32_t)packet;
+}
+
+#if HOP_MODE || TWO_WAY_MODE || RX_WINDOW_MODE
+
+/**
+ * @brief Function for listening for the beacons continuously again, the radio being disabled.
+ */
+static void radio_listen() {
+
+    NRF_RADIO->SHORTS    = (RADIO_SHORTS_READY_START_Enabled << RADIO_SHORTS_READY_START_Pos) |
+                           (RADIO_SHORTS_END_START_Enabled   << RADIO_SHORTS_END_START_Pos);
+    NRF_RADIO->PACKETPTR = (uint32_t)packet;
+#if HOP_MODE
+    NRF_RADIO->FREQUENCY = hop_table[hop_index];
+#endif
+    NRF_RADIO->TASKS_RXEN = 1;
+}
+
+/**
+ * @brief Function for going on from the RADIO interrupt once the radio is disabled, instead of waiting
+ * for the ramp-down in the caller: the DISABLED interrupt runs radio_disabled(), which does what the
+ * callers flagged. If the radio got there before the event was cleared, the interrupt is pended by hand.
+ */
+static void radio_disabled_next() {
+
+    NRF_RADIO->EVENTS_DISABLED = 0;
+    NRF_RADIO->INTENSET        = (RADIO_INTENSET_DISABLED_Enabled << RADIO_INTENSET_DISABLED_Pos);
+    if (NRF_RADIO->STATE == RADIO_STATE_STATE_Disabled) {
+        NVIC_SetPendingIRQ(RADIO_IRQn);
+    }
+}
+
+#endif // HOP_MODE || TWO_WAY_MODE || RX_WINDOW_MODE
+
+#if TRIGGER_ON_ADDRESS
+
+/**
+ * @brief Function for getting the address of an event of the address trigger links.
+ */
+static uint32_t trigger_event_addr(sync_trigger_event_t event) {
+    switch (event) {
+        case SYNC_TRIGGER_EVENT_ADDRESS:    return (uint32_t)&NRF_RADIO->EVENTS_ADDRESS;
+        case SYNC_TRIGGER_EVENT_CRCOK:      return (uint32_t)&NRF_RADIO->EVENTS_CRCOK;
+        case SYNC_TRIGGER_EVENT_CRCERROR:   return (uint32_t)&NRF_RADIO->EVENTS_CRCERROR;
+        case SYNC_TRIGGER_EVENT_RISE:       return (uint32_t)&NRF_TIMER0->EVENTS_COMPARE[1];
+        case SYNC_TRIGGER_EVENT_FALL:
+        default:                            return (uint32_t)&NRF_TIMER0->EVENTS_COMPARE[0];
+    }
+}
+
+/**
+ * @brief Function for getting the address of a task of the address trigger links, 0 for no task.
+ */
+static uint32_t trigger_task_addr(sync_trigger_task_t task) {
+    switch (task) {
+        case SYNC_TRIGGER_TASK_START:       return (uint32_t)&NRF_TIMER0->TASKS_START;
+        case SYNC_TRIGGER_TASK_STOP:        return (uint32_t)&NRF_TIMER0->TASKS_STOP;
+        case SYNC_TRIGGER_TASK_CLEAR:       return (uint32_t)&NRF_TIMER0->TASKS_CLEAR;
+        case SYNC_TRIGGER_TASK_SET:         return (uint32_t)&NRF_GPIOTE->TASKS_SET[GPIOTE_CH];
+        case SYNC_TRIGGER_TASK_CLR:         return (uint32_t)&NRF_GPIOTE->TASKS_CLR[GPIOTE_CH];
+        case SYNC_TRIGGER_TASK_TRIGGER_EN:  return (uint32_t)&NRF_PPI->TASKS_CHG[PPI_GROUP_TRIGGER].EN;
+        case SYNC_TRIGGER_TASK_TRIGGER_DIS: return (uint32_t)&NRF_PPI->TASKS_CHG[PPI_GROUP_TRIGGER].DIS;
+        case SYNC_TRIGGER_TASK_PULSE_EN:    return (uint32_t)&NRF_PPI->TASKS_CHG[PPI_GROUP_PULSE].EN;
+        case SYNC_TRIGGER_TASK_PULSE_DIS:   return (uint32_t)&NRF_PPI->TASKS_CHG[PPI_GROUP_PULSE].DIS;
+        case SYNC_TRIGGER_TASK_CANCEL_EN:   return (uint32_t)&NRF_PPI->TASKS_CHG[PPI_GROUP_CANCEL].EN;
+        case SYNC_TRIGGER_TASK_CANCEL_DIS:  return (uint32_t)&NRF_PPI->TASKS_CHG[PPI_GROUP_CANCEL].DIS;
+        case SYNC_TRIGGER_TASK_NONE:
+        default:                            return 0;
+    }
+}
+
+/**
+ * @brief Function for initializing PPI for the address trigger.
+ * The links are the ones of sync_trigger_links, which sync_trigger.c also runs through a model on a host.
+ * The rising edge link is the only member of channel group PPI_GROUP_TRIGGER: the address arms it,
+ * a CRC error disarms it, stops the pulse timer and forces the pin low, so a corrupted packet
+ * never produces a full pulse, even if the pin already went high. The start link is the only member
+ * of channel group PPI_GROUP_PULSE, disabled by the rising edge, so a packet received while the pin is
+ * high cannot restart the pulse; a cancel enables it again since the falling edge will not come.
+ * The cancel links are in channel group PPI_GROUP_CANCEL, disabled once the CRC of the packet is good
+ * and enabled again, with the start link, at the falling edge, so a later corrupted packet cannot
+ * cut a good pulse.
+ * Connections to be made: - Start Timer 0 when the address is received: EVENTS_ADDRESS from RADIO with TASKS_START from TIMER0 -> PPI channel 0, in pulse and cancel groups
+ *                         - Arm the rising edge: EVENTS_ADDRESS from RADIO with TASKS_CHG[PPI_GROUP_TRIGGER].EN -> PPI channel 0 FORK[0].TEP
+ *                         - Set pin low after pulse time: EVENTS_COMPARE[0] with TASKS_CLR[GPIOTE_CH] -> PPI channel 1
+ *                         - Rearm the start and cancel links: EVENTS_COMPARE[0] with TASKS_CHG[PPI_GROUP_CANCEL].EN -> PPI channel 1 FORK[1].TEP
+ *                         - EVENTS_HFCLKSTARTED from CLOCK to TASKS_RXEN from RADIO -> PPI channel 2
+ *                         - Set pin high after the trigger delay: EVENTS_COMPARE[1] with TASKS_SET[GPIOTE_CH] -> PPI channel 5, in trigger group
+ *                         - Disarm the start link: EVENTS_COMPARE[1] with TASKS_CHG[PPI_GROUP_PULSE].DIS -> PPI channel 5 FORK[5].TEP
+ *                         - Cancel: EVENTS_CRCERROR from RADIO with TASKS_CHG[PPI_GROUP_TRIGGER].DIS -> PPI channel 6, in cancel group
+ *                         - Cancel: EVENTS_CRCERROR from RADIO with TASKS_STOP from TIMER0 -> PPI channel 6 FORK[6].TEP
+ *                         - Cancel: EVENTS_CRCERROR from RADIO with TASKS_CLEAR from TIMER0 -> PPI channel 7, in cancel group
+ *                         - Cancel: EVENTS_CRCERROR from RADIO with TASKS_CLR[GPIOTE_CH] (pin low if it already went high) -> PPI channel 7 FORK[7].TEP
+ *                         - Cancel: EVENTS_CRCERROR from RADIO with TASKS_CHG[PPI_GROUP_PULSE].EN -> PPI channel 9, in cancel group
+ *                         - Disarm the cancel links: EVENTS_CRCOK from RADIO with TASKS_CHG[PPI_GROUP_CANCEL].DIS -> PPI channel 13
+ */
+void ppi_setup() {
+
+    for (uint32_t i = 0; i < SYNC_TRIGGER_LINKS; i++) {
+        const sync_trigger_link_t *link = &sync_trigger_links[i];
+
+        NRF_PPI->CH[link->channel].EEP   = trigger_event_addr(link->event);
+        NRF_PPI->CH[link->channel].TEP   = trigger_task_addr(link->task);
+        NRF_PPI->FORK[link->channel].TEP = trigger_task_addr(link->fork);
+    }
+
+    NRF_PPI->CH[2].EEP       = (uint32_t)&NRF_CLOCK->EVENTS_HFCLKSTARTED;
+    NRF_PPI->CH[2].TEP       = (uint32_t)&NRF_RADIO->TASKS_RXEN;
+
+    NRF_PPI->CHG[PPI_GROUP_TRIGGER] = SYNC_TRIGGER_GROUP_TRIGGER;
+    NRF_PPI->CHG[PPI_GROUP_PULSE]   = SYNC_TRIGGER_GROUP_PULSE;
+    NRF_PPI->CHG[PPI_GROUP_CANCEL]  = SYNC_TRIGGER_GROUP_CANCEL;
+
+    // the rising edge link is only enabled through its group
+    NRF_PPI->CHENSET = SYNC_TRIGGER_CHANNELS | (PPI_CHENSET_CH2_Enabled << PPI_CHENSET_CH2_Pos);
 }
 
+#else
+
 /**
  * @brief Function for initializing PPI. 
- * Connections to be made: - Toggle pin high when Radio packet is received correctly: EVENTS_CRCOK from RADIO to TASKS_OUT[GPIOTE_CH] (will set pin high) -> PPI channel 0
+ * The beacon link is the only member of channel group PPI_GROUP_PULSE, disabled by the packet that
+ * starts a pulse and enabled again at its falling edge, so a second packet while the pin is high
+ * cannot retrigger it.
+ * Connections to be made: - Set pin high when Radio packet is received correctly: EVENTS_CRCOK from RADIO to TASKS_SET[GPIOTE_CH] -> PPI channel 0, in pulse group
  *                         - Start Timer 0 that manages pulse duration: EVENTS_CRCOK from RADIO with TASKS_START from TIMER0 -> PPI channel 0 FORK[0].TEP (same event triggers 2 tasks)
- *                         - Toggle pin low after pulse time: EVENTS_COMPARE[0] with TASKS_OUT[GPIOTE_CH] (will set pin low) -> PPI channel 1
+ *                         - Set pin low after pulse time: EVENTS_COMPARE[0] with TASKS_CLR[GPIOTE_CH] -> PPI channel 1
+ *                         - Rearm the beacon link: EVENTS_COMPARE[0] with TASKS_CHG[PPI_GROUP_PULSE].EN -> PPI channel 1 FORK[1].TEP
  *                         - EVENTS_HFCLKSTARTED from CLOCK to TASKS_RXEN from RADIO -> PPI channel 2
+ *                         - Disarm the beacon link: EVENTS_CRCOK from RADIO with TASKS_CHG[PPI_GROUP_PULSE].DIS -> PPI channel 13
  */
 void ppi_setup() {
     // get endpoint addresses
-    uint32_t gpiote_task_addr               = (uint32_t)&NRF_GPIOTE->TASKS_OUT[GPIOTE_CH];
+    uint32_t gpiote_task_set_addr           = (uint32_t)&NRF_GPIOTE->TASKS_SET[GPIOTE_CH];
+    uint32_t gpiote_task_clr_addr           = (uint32_t)&NRF_GPIOTE->TASKS_CLR[GPIOTE_CH];
     uint32_t timer0_task_start_addr         = (uint32_t)&NRF_TIMER0->TASKS_START;
     uint32_t radio_tasks_rxen_addr          = (uint32_t)&NRF_RADIO->TASKS_RXEN;
+    uint32_t ppi_group_pulse_en_addr        = (uint32_t)&NRF_PPI->TASKS_CHG[PPI_GROUP_PULSE].EN;
+    uint32_t ppi_group_pulse_dis_addr       = (uint32_t)&NRF_PPI->TASKS_CHG[PPI_GROUP_PULSE].DIS;
     uint32_t timer0_events_compare_0_addr   = (uint32_t)&NRF_TIMER0->EVENTS_COMPARE[0];
     uint32_t clock_events_hfclkstart_addr   = (uint32_t)&NRF_CLOCK->EVENTS_HFCLKSTARTED;
     uint32_t radio_events_crcok_addr        = (uint32_t)&NRF_RADIO->EVENTS_CRCOK;
 
     // set endpoints
     NRF_PPI->CH[0].EEP       = radio_events_crcok_addr;
-    NRF_PPI->CH[0].TEP       = gpiote_task_addr;
+    NRF_PPI->CH[0].TEP       = gpiote_task_set_addr;
     NRF_PPI->FORK[0].TEP     = timer0_task_start_addr;
 
     NRF_PPI->CH[1].EEP       = timer0_events_compare_0_addr;
-    NRF_PPI->CH[1].TEP       = gpiote_task_addr;
+    NRF_PPI->CH[1].TEP       = gpiote_task_clr_addr;
+    NRF_PPI->FORK[1].TEP     = ppi_group_pulse_en_addr;
 
     NRF_PPI->CH[2].EEP       = clock_events_hfclkstart_addr;
     NRF_PPI->CH[2].TEP       = radio_tasks_rxen_addr;
 
+    NRF_PPI->CH[13].EEP      = radio_events_crcok_addr;
+    NRF_PPI->CH[13].TEP      = ppi_group_pulse_dis_addr;
+
+    // beacon link is disarmed while the pin is high
+    NRF_PPI->CHG[PPI_GROUP_PULSE] = (PPI_CHG_CH0_Included << PPI_CHG_CH0_Pos);
+
     // enable channels
-    NRF_PPI->CHENSET = (PPI_CHENSET_CH0_Enabled << PPI_CHENSET_CH0_Pos) | 
-                       (PPI_CHENSET_CH1_Enabled << PPI_CHENSET_CH1_Pos) |
-                       (PPI_CHENSET_CH2_Enabled << PPI_CHENSET_CH2_Pos);
+    NRF_PPI->CHENSET = (PPI_CHENSET_CH0_Enabled  << PPI_CHENSET_CH0_Pos)  | 
+                       (PPI_CHENSET_CH1_Enabled  << PPI_CHENSET_CH1_Pos)  |
+                       (PPI_CHENSET_CH2_Enabled  << PPI_CHENSET_CH2_Pos)  |
+                       (PPI_CHENSET_CH13_Enabled << PPI_CHENSET_CH13_Pos);
 }
 
+#endif // TRIGGER_ON_ADDRESS
+
+#if OUTPUTS_MODE
+
+/**
+ * @brief Function for initializing the extra outputs.
+ * Every output gets a GPIOTE channel and two compares on TIMER3, then TIMER4 (see sync_outputs.h).
+ * TIMER0 CC[2] fires OUTPUT_LATENCY tick after the rising edge of every pulse, whatever started it
+ * (beacon, holdover or servo), so the outputs follow the same arming rules as the pulse itself.
+ * Connections to be made:
+ *     - Start the output timers: EVENTS_COMPARE[2] from TIMER0 with TASKS_START from TIMER3 -> PPI channel OUTPUT_PPI_FIRST
+ *     - Start the output timers: EVENTS_COMPARE[2] from TIMER0 with TASKS_START from TIMER4 -> PPI channel OUTPUT_PPI_FIRST FORK.TEP
+ *     - Set output i high: EVENTS_COMPARE[rise] from its timer with TASKS_SET[OUTPUT_GPIOTE_FIRST + i] -> PPI channel OUTPUT_PPI_FIRST + 1 + 2 * i
+ *     - Set output i low: EVENTS_COMPARE[fall] from its timer with TASKS_CLR[OUTPUT_GPIOTE_FIRST + i] -> PPI channel OUTPUT_PPI_FIRST + 2 + 2 * i
+ */
+void outputs_setup() {
+    NRF_TIMER_Type      *timers[] = { NRF_TIMER3, NRF_TIMER4 };
+    sync_outputs_plan_t  plan;
+    uint32_t             chen     = (1UL << OUTPUT_PPI_FIRST);
+
+    if (!sync_outputs_plan(outputs, OUTPUT_COUNT, TIMER3_CC_NUM, OUTPUT_LATENCY, PULSE_PERIOD_TICKS, &plan)) {
+        NRF_LOG_ERROR("outputs: OUTPUT_TABLE does not fit in the period, outputs disabled");
+        return;
+    }
+
+    for (uint8_t t = 0; t < plan.timers; t++) {
+        timers[t]->BITMODE   = TIMER_BITMODE_BITMODE_32Bit;
+        timers[t]->PRESCALER = TIMER_PRESCALER;
+
+        // the latest falling edge clears and stops the timer until the next pulse
+        timers[t]->SHORTS    = (TIMER_SHORTS_COMPARE0_CLEAR_Enabled << (TIMER_SHORTS_COMPARE0_CLEAR_Pos + plan.stop_cc[t])) |
+                               (TIMER_SHORTS_COMPARE0_STOP_Enabled  << (TIMER_SHORTS_COMPARE0_STOP_Pos  + plan.stop_cc[t]));
+    }
+
+    for (uint8_t i = 0; i < plan.count; i++) {
+        const sync_output_cc_t *cc      = &plan.outputs[i];
+        NRF_TIMER_Type         *timer   = timers[cc->timer];
+        uint32_t                gpiote  = OUTPUT_GPIOTE_FIRST + i;
+        uint32_t                ppi     = OUTPUT_PPI_FIRST + 1 + 2 * i;
+
+        NRF_GPIOTE->CONFIG[gpiote] = (GPIOTE_CONFIG_MODE_Task       << GPIOTE_CONFIG_MODE_Pos)     |
+                                     (outputs[i].pin                << GPIOTE_CONFIG_PSEL_Pos)     |
+                                     (outputs[i].port               << GPIOTE_CONFIG_PORT_Pos)     |
+                                     (GPIOTE_CONFIG_POLARITY_None   << GPIOTE_CONFIG_POLARITY_Pos) |
+                                     (GPIOTE_CONFIG_OUTINIT_Low     << GPIOTE_CONFIG_OUTINIT_Pos);
+
+        timer->CC[cc->cc_rise]   = cc->rise;
+        timer->CC[cc->cc_fall]   = cc->fall;
+
+        NRF_PPI->CH[ppi].EEP     = (uint32_t)&timer->EVENTS_COMPARE[cc->cc_rise];
+        NRF_PPI->CH[ppi].TEP     = (uint32_t)&NRF_GPIOTE->TASKS_SET[gpiote];
+
+        NRF_PPI->CH[ppi + 1].EEP = (uint32_t)&timer->EVENTS_COMPARE[cc->cc_fall];
+        NRF_PPI->CH[ppi + 1].TEP = (uint32_t)&NRF_GPIOTE->TASKS_CLR[gpiote];
+
+        chen |= (1UL << ppi) | (1UL << (ppi + 1));
+    }
+
+#if TRIGGER_ON_ADDRESS
+    NRF_TIMER0->CC[2] = NRF_TIMER0->CC[1] + OUTPUT_LATENCY;
+#else
+    NRF_TIMER0->CC[2] = OUTPUT_LATENCY;
+#endif
+
+    NRF_PPI->CH[OUTPUT_PPI_FIRST].EEP      = (uint32_t)&NRF_TIMER0->EVENTS_COMPARE[2];
+    NRF_PPI->CH[OUTPUT_PPI_FIRST].TEP      = (uint32_t)&NRF_TIMER3->TASKS_START;
+    if (plan.timers > 1) {
+        NRF_PPI->FORK[OUTPUT_PPI_FIRST].TEP = (uint32_t)&NRF_TIMER4->TASKS_START;
+    }
+
+    NRF_PPI->CHENSET = chen;
+}
+
+#endif // OUTPUTS_MODE
+
+#if PWM_SEQUENCE_MODE
+
+/**
+ * @brief Function for initializing the PWM sequence.
+ * PWM_PATTERN is compiled into pwm_sequence once (see sync_pwm.h), then every beacon starts PWM0, which
+ * plays it through EasyDMA and stops at the end of the sequence. The link is in the pulse group, so a
+ * beacon received while the pin is high does not restart the pattern. While PWM0 is stopped its pin
+ * is driven low by the GPIO configuration. The SEQSTART to first period latency is the same on both boards.
+ * Connections to be made:
+ *     - Play the pattern: EVENTS_CRCOK from RADIO with TASKS_SEQSTART[0] from PWM0 -> PPI channel PWM_PPI_CH, in pulse group
+ */
+void pwm_setup() {
+    NRF_GPIO_Type *port       = (PWM_PIN_PORT == 1) ? NRF_P1 : NRF_P0;
+    uint16_t       countertop = PWM_MS_TO_TICKS(PWM_SLOT);
+    uint16_t       length;
+
+    length = sync_pwm_compile(pwm_pattern, PWM_SEGMENTS, countertop, pwm_sequence, PWM_SEQUENCE_MAX);
+    if (length == 0 || (uint64_t)length * countertop >= (uint64_t)PULSE_PERIOD * SYNC_TICKS_PER_MS(PWM_PRESCALER)) {
+        NRF_LOG_ERROR("pwm: PWM_PATTERN does not fit in PWM_SEQUENCE_MAX slots or in the period, sequence disabled");
+        return;
+    }
+
+    port->OUTCLR                  = (1UL << PWM_PIN_NUMBER);
+    port->PIN_CNF[PWM_PIN_NUMBER] = (GPIO_PIN_CNF_DIR_Output << GPIO_PIN_CNF_DIR_Pos);
+
+    NRF_PWM0->PSEL.OUT[0]     = (PWM_PIN_NUMBER                 << PWM_PSEL_OUT_PIN_Pos)  |
+                                (PWM_PIN_PORT                   << PWM_PSEL_OUT_PORT_Pos) |
+                                (PWM_PSEL_OUT_CONNECT_Connected << PWM_PSEL_OUT_CONNECT_Pos);
+    NRF_PWM0->MODE            = (PWM_MODE_UPDOWN_Up << PWM_MODE_UPDOWN_Pos);
+    NRF_PWM0->PRESCALER       = (PWM_PRESCALER      << PWM_PRESCALER_PRESCALER_Pos);
+    NRF_PWM0->COUNTERTOP      = (countertop         << PWM_COUNTERTOP_COUNTERTOP_Pos);
+    NRF_PWM0->LOOP            = (PWM_LOOP_CNT_Disabled << PWM_LOOP_CNT_Pos);
+    NRF_PWM0->DECODER         = (PWM_DECODER_LOAD_Common       << PWM_DECODER_LOAD_Pos) |   // one value per period
+                                (PWM_DECODER_MODE_RefreshCount << PWM_DECODER_MODE_Pos);
+    NRF_PWM0->SEQ[0].PTR      = (uint32_t)pwm_sequence;
+    NRF_PWM0->SEQ[0].CNT      = length;
+    NRF_PWM0->SEQ[0].REFRESH  = 0;      // every value lasts one period
+    NRF_PWM0->SEQ[0].ENDDELAY = 0;
+
+    // the output goes back to the GPIO level at the end of the sequence
+    NRF_PWM0->SHORTS          = (PWM_SHORTS_SEQEND0_STOP_Enabled << PWM_SHORTS_SEQEND0_STOP_Pos);
+    NRF_PWM0->ENABLE          = (PWM_ENABLE_ENABLE_Enabled << PWM_ENABLE_ENABLE_Pos);
+
+    NRF_PPI->CH[PWM_PPI_CH].EEP    = (uint32_t)&NRF_RADIO->EVENTS_CRCOK;
+    NRF_PPI->CH[PWM_PPI_CH].TEP    = (uint32_t)&NRF_PWM0->TASKS_SEQSTART[0];
+
+    NRF_PPI->CHG[PPI_GROUP_PULSE] |= (1UL << PWM_PPI_CH);
+
+    NRF_PPI->CHENSET = (1UL << PWM_PPI_CH);
+
+    NRF_LOG_INFO("pwm: %u slots of %u ticks", length, countertop);
+}
+
+#endif // PWM_SEQUENCE_MODE
+
+#if CALIBRATION_MODE
+
+/**
+ * @brief Function for initializing the trigger delay measurement.
+ * TIMER1 runs freely and is only used to timestamp radio events.
+ * Connections to be made:
+ *     - Timestamp the end of the packet: EVENTS_END from RADIO with TASKS_CAPTURE[0] from TIMER1 -> PPI channel 3
+ *     - Timestamp the pulse trigger: EVENTS_CRCOK (or EVENTS_ADDRESS) from RADIO with TASKS_CAPTURE[1] from TIMER1 -> PPI channel 4
+ * The END interrupt collects the captures and reports every CALIB_SAMPLES packets. With the address trigger
+ * the reported delay includes TRIGGER_DELAY, since that is when the pulse actually starts.
+ */
+void calibration_setup() {
+
+    sync_calib_init(&calib);
+
+    NRF_TIMER1->BITMODE   = TIMER_BITMODE_BITMODE_32Bit;
+    NRF_TIMER1->PRESCALER = TIMER_PRESCALER;
+
+    NRF_PPI->CH[3].EEP       = (uint32_t)&NRF_RADIO->EVENTS_END;
+    NRF_PPI->CH[3].TEP       = (uint32_t)&NRF_TIMER1->TASKS_CAPTURE[0];
+
+#if TRIGGER_ON_ADDRESS
+    NRF_PPI->CH[4].EEP       = (uint32_t)&NRF_RADIO->EVENTS_ADDRESS;
+#else
+    NRF_PPI->CH[4].EEP       = (uint32_t)&NRF_RADIO->EVENTS_CRCOK;
+#endif
+    NRF_PPI->CH[4].TEP       = (uint32_t)&NRF_TIMER1->TASKS_CAPTURE[1];
+
+    NRF_PPI->CHENSET = (PPI_CHENSET_CH3_Enabled << PPI_CHENSET_CH3_Pos) |
+                       (PPI_CHENSET_CH4_Enabled << PPI_CHENSET_CH4_Pos);
+
+    NRF_RADIO->EVENTS_END = 0;
+    NRF_RADIO->INTENSET   = (RADIO_INTENSET_END_Enabled << RADIO_INTENSET_END_Pos);
+    NVIC_EnableIRQ(RADIO_IRQn);
+
+    NRF_TIMER1->TASKS_START = TIMER_TASKS_START_TASKS_START_Trigger;
+}
+
+/**
+ * @brief Function for handling the RADIO END event while calibrating.
+ */
+static void calibration_radio_end() {
+
+    sync_calib_add_rx(&calib, NRF_TIMER1->CC[0], NRF_TIMER1->CC[1]);
+
+    // clear the captures so a packet with a CRC error is rejected
+    NRF_TIMER1->CC[0] = 0;
+    NRF_TIMER1->CC[1] = 0;
+
+    int32_t delay;
+    if (sync_calib_rx_trigger_delay(&calib, CALIB_SAMPLES, &delay)) {
+#if TRIGGER_ON_ADDRESS
+        delay += MS_TO_TICKS(TRIGGER_DELAY);
+#endif
+        NRF_LOG_INFO("trigger delay: %d ns (%u samples, %u rejected)", SYNC_TICKS_TO_NS(delay, TIMER_PRESCALER),
+                     calib.rx_samples, calib.rejected);
+        sync_calib_init(&calib);
+    }
+}
+
+#endif // CALIBRATION_MODE
+
+#if HOP_MODE
+
+/**
+ * @brief Function for initializing the frequency hopping.
+ * The radio searches on the first channel of HOP_MAP until a beacon announces the map in use. Every
+ * beacon then gives the channel of the next one. Without RX_WINDOW_MODE, TIMER2 CC[3] marks the time a
+ * period and a half after the last beacon: if no beacon arrived, its interrupt retunes to the channel
+ * of the beacon after (with RX_WINDOW_MODE, the window closing does the same). While searching, it
+ * moves on to the next channel of HOP_TABLE every HOP_SEARCH_DWELL periods, as long as it fires: with
+ * RX_WINDOW_MODE, the radio stays on the same channel once the window gives up.
+ */
+void hop_setup() {
+
+    sync_hop_rx_init(&hop, HOP_SEED, HOP_MAP, (uint32_t)((1ULL << HOP_CHANNELS) - 1), HOP_MAX_MISSES, HOP_SEARCH_DWELL);
+    sync_hop_stats_init(&hop_stats);
+
+    hop_index            = sync_hop_first(HOP_MAP);
+    NRF_RADIO->FREQUENCY = hop_table[hop_index];
+
+#if !RX_WINDOW_MODE
+    NRF_TIMER2->TASKS_CAPTURE[3]  = 1;
+    NRF_TIMER2->CC[3]            += beacon_period;
+    NRF_TIMER2->EVENTS_COMPARE[3] = 0;
+    NRF_TIMER2->INTENSET          = (TIMER_INTENSET_COMPARE3_Enabled << TIMER_INTENSET_COMPARE3_Pos);
+    NVIC_EnableIRQ(TIMER2_IRQn);
+#endif
+}
+
+/**
+ * @brief Function for tuning the radio to an entry of hop_table.
+ * When the radio listens continuously (END to START shortcut) it is disabled and enabled again,
+ * otherwise it is disabled between two windows and the next one opens on the new channel. The
+ * channel is written once the radio is disabled (see radio_disabled()).
+ */
+static void hop_tune(uint8_t index) {
+
+    if (index == SYNC_HOP_FIXED || index == hop_index) {
+        return;
+    }
+    hop_index = index;
+
+#if TWO_WAY_MODE
+    if (twoway_requesting || twoway_sending) {
+        // the request goes out on the channel of the beacon, radio_listen() tunes to hop_index after it
+        return;
+    }
+#endif
+
+    if (NRF_RADIO->SHORTS & RADIO_SHORTS_END_START_Msk) {
+        NRF_RADIO->TASKS_DISABLE = 1;
+        radio_relisten           = true;
+    }
+    radio_disabled_next();
+}
+
+/**
+ * @brief Function for handling a valid beacon: count it and retune to the channel of the next one.
+ * The beacons missed before it are counted on the channels they were due on, with the maps of the
+ * beacon before (the last 64 at most).
+ */
+static void hop_beacon(const sync_beacon_t *beacon, uint32_t missed) {
+    uint32_t next_map = sync_beacon_channel_map(beacon, beacon->channel_switch);
+
+    for (uint32_t i = (missed > 64 ? 64 : missed); i > 0; i--) {
+        uint32_t sequence = beacon->sequence - i;
+
+        sync_hop_stats_add(&hop_stats, sync_hop_index(HOP_SEED, sync_hop_rx_map(&hop, sequence), sequence), false);
+    }
+    sync_hop_stats_add(&hop_stats, hop_index, true);
+
+    if (beacon->channel_map != hop.map) {
+        NRF_LOG_INFO("beacon %u: channel map 0x%08x", beacon->sequence, beacon->channel_map);
+    }
+    if (next_map != beacon->channel_map && (next_map != hop.next_map || beacon->channel_switch != hop.switch_sequence)) {
+        NRF_LOG_INFO("beacon %u: channel map 0x%08x from beacon %u", beacon->sequence, next_map, beacon->channel_switch);
+    }
+    hop_tune(sync_hop_rx_beacon(&hop, beacon->sequence, beacon->channel_map, next_map, beacon->channel_switch));
+
+#if !RX_WINDOW_MODE
+    NRF_TIMER2->CC[3]             = NRF_TIMER2->CC[0] + beacon_period + beacon_period / 2;
+    NRF_TIMER2->EVENTS_COMPARE[3] = 0;
+#endif
+
+    if (beacon_stats.received % HOP_LOG_BEACONS == 0) {
+        NRF_LOG_INFO("hop: map 0x%08x, suggested map 0x%08x", hop.map,
+                     sync_hop_blacklist(&hop_stats, hop.map, HOP_BLACKLIST_BEACONS, HOP_BLACKLIST_LOSS));
+        for (uint8_t i = 0; i < HOP_CHANNELS; i++) {
+            if (hop_stats.received[i] + hop_stats.missed[i] >= HOP_BLACKLIST_BEACONS &&
+                sync_hop_stats_loss(&hop_stats, i) > HOP_BLACKLIST_LOSS) {
+                NRF_LOG_INFO("hop: channel %u loss %u per mille", i, sync_hop_stats_loss(&hop_stats, i));
+            }
+        }
+        sync_hop_stats_init(&hop_stats);
+    }
+}
+
+/**
+ * @brief Function for handling a missed beacon: retune to the channel of the beacon after, or search.
+ */
+static void hop_missed() {
+    bool synced = hop.synced;
+
+    hop_tune(sync_hop_rx_missed(&hop));
+
+#if !RX_WINDOW_MODE
+    NRF_TIMER2->CC[3] += beacon_period;
+#endif
+    if (synced && !hop.synced) {
+        NRF_LOG_INFO("hop: searching");
+    }
+}
+
+#endif // HOP_MODE
+
+#if BURST_MODE
+
+/**
+ * @brief Function for initializing the burst reception.
+ * The beacon link no longer sets the pin, it only starts TIMER0: CC[1] sets it after the delay of the
+ * copy received, written by the CRCOK interrupt before the timer gets there (BURST_MARGIN for the last
+ * copy), and CC[0] ends the pulse the width after it. The pulse group still disarms the beacon link
+ * until the falling edge, so the later copies cannot restart TIMER0.
+ * Connections to be made:
+ *     - Start Timer 0 on the first copy received: EVENTS_CRCOK from RADIO with TASKS_START from TIMER0 -> PPI channel 0, in pulse group
+ *     - Set pin high after the delay of the copy: EVENTS_COMPARE[1] from TIMER0 with TASKS_SET[GPIOTE_CH] -> PPI channel BURST_PPI_CH
+ */
+void burst_setup() {
+
+    for (uint8_t copy = 0; copy < BURST_COPIES; copy++) {
+        burst_cc[copy]    = SYNC_US_TO_TICKS(sync_burst_delay(BURST_COPIES, BURST_SPACING, BURST_MARGIN, copy), TIMER_PRESCALER);
+        burst_first[copy] = 0;
+    }
+    burst_has_sequence = false;
+
+    NRF_TIMER0->CC[1] = burst_cc[0];
+    NRF_TIMER0->CC[0] = burst_cc[0] + beacon_width;
+
+    NRF_PPI->CH[0].TEP   = (uint32_t)&NRF_TIMER0->TASKS_START;
+    NRF_PPI->FORK[0].TEP = 0;
+
+    NRF_PPI->CH[BURST_PPI_CH].EEP = (uint32_t)&NRF_TIMER0->EVENTS_COMPARE[1];
+    NRF_PPI->CH[BURST_PPI_CH].TEP = (uint32_t)&NRF_GPIOTE->TASKS_SET[GPIOTE_CH];
+
+    NRF_PPI->CHENSET = (1UL << BURST_PPI_CH);
+}
+
+/**
+ * @brief Function for dropping the pulse the packet just received has started, if it did.
+ * A copy arriving during the pulse of its beacon finds TIMER0 running for at least a spacing. A count
+ * below that means the packet restarted it after the falling edge: it is stopped before the rising
+ * edge (BURST_MARGIN away at least) and the beacon link is armed again.
+ */
+static void burst_drop() {
+
+    NRF_TIMER0->TASKS_CAPTURE[2] = 1;
+    if (NRF_TIMER0->CC[2] < SYNC_US_TO_TICKS(BURST_SPACING, TIMER_PRESCALER)) {
+        NRF_TIMER0->TASKS_STOP                 = 1;
+        NRF_TIMER0->TASKS_CLEAR                = 1;
+        NRF_PPI->TASKS_CHG[PPI_GROUP_PULSE].EN = 1;
+    }
+}
+
+/**
+ * @brief Function for handling a valid beacon: set the rising edge for its copy index, if it is the
+ * first copy received. TIMER2 CC[0] is moved back to the time of copy 0, so the statistics and the
+ * hopping see the same time whichever copy arrived.
+ * Returns false for the later copies, and for a burst of another length.
+ */
+static bool burst_radio_crcok(const sync_beacon_t *beacon) {
+
+    if (burst_has_sequence && beacon->sequence == burst_sequence) {
+        burst_drop();
+        return false;
+    }
+
+    if (beacon->copies != BURST_COPIES) {
+        burst_drop();
+        beacon_stats.invalid++;
+        NRF_LOG_WARNING("beacon %u: %u copies per burst, expected %u", beacon->sequence, beacon->copies, BURST_COPIES);
+        return false;
+    }
+
+    NRF_TIMER0->CC[1]  = burst_cc[beacon->copy];
+    NRF_TIMER0->CC[0]  = burst_cc[beacon->copy] + beacon_width;
+    NRF_TIMER2->CC[0] -= beacon->copy * SYNC_US_TO_TICKS(BURST_SPACING, TIMER_PRESCALER);
+
+    burst_sequence     = beacon->sequence;
+    burst_has_sequence = true;
+    burst_first[beacon->copy]++;
+
+    return true;
+}
+
+#endif // BURST_MODE
+
+#if TWO_WAY_MODE
+
+/**
+ * @brief Function for initializing the two-way exchanges.
+ * The beacon link no longer sets the pin, it only starts TIMER0: CC[1] sets it twoway_edge later, and CC[0]
+ * ends the pulse the width after it. Until the first correction, the edge assumes the nominal delay.
+ * The request is started by TIMER2 CC[2], TWO_WAY_REPLY_DELAY after the CRCOK of the beacon captured on
+ * CC[0], and its address is captured on CC[1]; both links are only enabled while the request is on air.
+ * Connections to be made:
+ *     - Start Timer 0 on the beacon: EVENTS_CRCOK from RADIO with TASKS_START from TIMER0 -> PPI channel 0, in pulse group
+ *     - Set pin high after the edge time: EVENTS_COMPARE[1] from TIMER0 with TASKS_SET[GPIOTE_CH] -> PPI channel TWO_WAY_PPI_FIRST
+ *     - Send the request: EVENTS_COMPARE[2] from TIMER2 with TASKS_START from RADIO -> PPI channel TWO_WAY_PPI_FIRST + 1
+ *     - Timestamp the request: EVENTS_ADDRESS from RADIO with TASKS_CAPTURE[1] from TIMER2 -> PPI channel TWO_WAY_PPI_FIRST + 2
+ */
+void twoway_setup() {
+
+    sync_twoway_init(&twoway);
+    twoway_edge    = MS_TO_TICKS(TWO_WAY_HEADROOM);
+    twoway_lost    = 0;
+    twoway_requesting = false;
+    twoway_sending    = false;
+    twoway_sent       = false;
+
+    NRF_TIMER0->CC[1] = twoway_edge;
+    NRF_TIMER0->CC[0] = twoway_edge + beacon_width;
+
+    NRF_PPI->CH[0].TEP   = (uint32_t)&NRF_TIMER0->TASKS_START;
+    NRF_PPI->FORK[0].TEP = 0;
+
+    NRF_PPI->CH[TWO_WAY_PPI_FIRST].EEP     = (uint32_t)&NRF_TIMER0->EVENTS_COMPARE[1];
+    NRF_PPI->CH[TWO_WAY_PPI_FIRST].TEP     = (uint32_t)&NRF_GPIOTE->TASKS_SET[GPIOTE_CH];
+
+    NRF_PPI->CH[TWO_WAY_PPI_FIRST + 1].EEP = (uint32_t)&NRF_TIMER2->EVENTS_COMPARE[2];
+    NRF_PPI->CH[TWO_WAY_PPI_FIRST + 1].TEP = (uint32_t)&NRF_RADIO->TASKS_START;
+
+    NRF_PPI->CH[TWO_WAY_PPI_FIRST + 2].EEP = (uint32_t)&NRF_RADIO->EVENTS_ADDRESS;
+    NRF_PPI->CH[TWO_WAY_PPI_FIRST + 2].TEP = (uint32_t)&NRF_TIMER2->TASKS_CAPTURE[1];
+
+    NRF_PPI->CHENSET = (1UL << TWO_WAY_PPI_FIRST);
+}
+
+/**
+ * @brief Function for sending the request answering a beacon.
+ * The radio stops listening, and once it is disabled twoway_radio_disabled() switches it to TX.
+ */
+static void twoway_request(const sync_beacon_t *beacon) {
+
+    sync_twoway_pack_request(twoway_packet, PACKET_LENGTH, TWO_WAY_NODE, beacon->sequence);
+
+    twoway_start      = NRF_TIMER2->CC[0] + SYNC_US_TO_TICKS(TWO_WAY_REPLY_DELAY, TIMER_PRESCALER);
+    twoway_next       = beacon->sequence;
+    twoway_requesting = true;
+
+    NRF_RADIO->SHORTS        = (RADIO_SHORTS_END_DISABLE_Enabled << RADIO_SHORTS_END_DISABLE_Pos);
+    NRF_RADIO->TASKS_DISABLE = 1;
+    radio_disabled_next();
+}
+
+/**
+ * @brief Function for switching the radio to TX for the request, the radio being disabled.
+ * It goes out on the channel of the beacon: the radio waits in TXIDLE for TIMER2 CC[2]. If the
+ * interrupts came too late for the ramp-up, there is no request this time.
+ */
+static void twoway_radio_disabled() {
+
+    twoway_requesting = false;
+
+    NRF_TIMER2->TASKS_CAPTURE[1] = 1;
+    if ((int32_t)(twoway_start - NRF_TIMER2->CC[1]) <= (int32_t)MS_TO_TICKS(RADIO_RAMPUP)) {
+        NRF_LOG_WARNING("two-way: CRCOK interrupt too late for the request after beacon %u", twoway_next);
+        radio_listen();
+        return;
+    }
+
+    NRF_TIMER2->CC[2]     = twoway_start;
+    NRF_RADIO->TXADDRESS  = TWO_WAY_ADDRESS;
+    NRF_RADIO->PACKETPTR  = (uint32_t)twoway_packet;
+    NRF_RADIO->TASKS_TXEN = 1;
+
+    twoway_beacon   = NRF_TIMER2->CC[0];
+    twoway_sequence = twoway_next;
+    twoway_sending  = true;
+
+    NRF_RADIO->EVENTS_END = 0;
+    NRF_RADIO->INTENSET   = (RADIO_INTENSET_END_Enabled << RADIO_INTENSET_END_Pos);
+    NRF_PPI->CHENSET      = (1UL << (TWO_WAY_PPI_FIRST + 1)) | (1UL << (TWO_WAY_PPI_FIRST + 2));
+}
+
+/**
+ * @brief Function for handling the RADIO END event of the request: take the turnaround and listen again
+ * once the END to DISABLE shortcut has disabled the radio.
+ */
+static void twoway_radio_end() {
+
+    NRF_RADIO->INTENCLR = (RADIO_INTENCLR_END_Clear << RADIO_INTENCLR_END_Pos);
+    NRF_PPI->CHENCLR    = (1UL << (TWO_WAY_PPI_FIRST + 1)) | (1UL << (TWO_WAY_PPI_FIRST + 2));
+
+    twoway_turnaround = NRF_TIMER2->CC[1] - twoway_beacon;
+    twoway_sending    = false;
+    twoway_sent       = true;
+
+    radio_relisten = true;
+    radio_disabled_next();
+}
+
+/**
+ * @brief Function for handling a valid beacon: take the response to the last request, and send the next one
+ * in the slot of TWO_WAY_NODE. Every TWO_WAY_SAMPLES exchanges, the rising edge moves to the headroom plus
+ * the nominal delay minus the measured one. The turnaround is brought to the transmitter clock with the
+ * mean interval error of the beacon statistics.
+ */
+static void twoway_radio_crcok(const sync_beacon_t *beacon) {
+    int32_t  delay;
+    uint32_t edge;
+
+    if (twoway_sent && beacon->sequence == twoway_sequence + 1) {
+        if (beacon->reply_node == TWO_WAY_NODE) {
+            int32_t drift = (int32_t)((int64_t)sync_beacon_stats_interval_mean(&beacon_stats) * 1000000 / beacon->period_us);
+
+            sync_twoway_add(&twoway, beacon->reply_time, (uint32_t)SYNC_TICKS_TO_NS(twoway_turnaround, TIMER_PRESCALER), drift);
+        } else {
+            twoway_lost++;
+        }
+    }
+    twoway_sent = false;
+
+    if (sync_twoway_delay(&twoway, TWO_WAY_SAMPLES, &delay)) {
+        if (!sync_twoway_edge(delay, (int32_t)(TWO_WAY_NOMINAL * 1000000), (uint32_t)(TWO_WAY_HEADROOM * 1000000), &edge)) {
+            NRF_LOG_WARNING("two-way: delay %d ns is longer than TWO_WAY_HEADROOM allows", delay);
+        }
+
+        // a compare of 0 would only match after a wrap of TIMER0
+        twoway_edge = (uint32_t)(((uint64_t)edge * SYNC_TICKS_PER_MS(TIMER_PRESCALER) + 500000) / 1000000);
+        if (twoway_edge == 0) {
+            twoway_edge = 1;
+        }
+
+        // TIMER0 may be running the current pulse, the edge is written once it stops
+        NRF_TIMER0->INTENSET = (TIMER_INTENSET_COMPARE0_Enabled << TIMER_INTENSET_COMPARE0_Pos);
+        NRF_LOG_INFO("two-way: delay %d ns (min %d ns, max %d ns), rising edge %u ns after the beacon", delay,
+                     twoway.delay_min, twoway.delay_max, edge);
+        NRF_LOG_INFO("two-way: %u exchanges, %u rejected, %u unanswered", twoway.samples, twoway.rejected, twoway_lost);
+        sync_twoway_init(&twoway);
+        twoway_lost = 0;
+    }
+
+    if (sync_twoway_slot(beacon->sequence, TWO_WAY_NODES) == TWO_WAY_NODE) {
+        twoway_request(beacon);
+    }
+}
+
+#endif // TWO_WAY_MODE
+
+/**
+ * @brief Function for initializing the beacon reception.
+ * TIMER2 runs freely and timestamps every beacon, the holdover and the servo use the same timestamps.
+ * Connections to be made:
+ *     - Timestamp the beacon: EVENTS_CRCOK from RADIO with TASKS_CAPTURE[0] from TIMER2 -> PPI channel 8
+ */
+void beacon_setup() {
+
+    sync_beacon_stats_init(&beacon_stats);
+    beacon_period = PULSE_PERIOD_TICKS;
+    beacon_width  = MS_TO_TICKS(PULSE_DURATION);
+    beacon_switch = 0;
+
+    NRF_TIMER2->BITMODE   = TIMER_BITMODE_BITMODE_32Bit;
+    NRF_TIMER2->PRESCALER = TIMER_PRESCALER;
+
+    NRF_PPI->CH[8].EEP       = (uint32_t)&NRF_RADIO->EVENTS_CRCOK;
+    NRF_PPI->CH[8].TEP       = (uint32_t)&NRF_TIMER2->TASKS_CAPTURE[0];
+
+    NRF_PPI->CHENSET = (PPI_CHENSET_CH8_Enabled << PPI_CHENSET_CH8_Pos);
+
+    NRF_RADIO->EVENTS_CRCOK = 0;
+    NRF_RADIO->INTENSET     = (RADIO_INTENSET_CRCOK_Enabled << RADIO_INTENSET_CRCOK_Pos);
+    NVIC_EnableIRQ(RADIO_IRQn);
+
+    NRF_TIMER0->EVENTS_COMPARE[0] = 0;
+    NVIC_EnableIRQ(TIMER0_IRQn);
+
+    NRF_TIMER2->TASKS_START = TIMER_TASKS_START_TASKS_START_Trigger;
+}
+
+/**
+ * @brief Function for handling the RADIO CRCOK event: read the beacon and adopt its schedule.
+ * The payload is parsed before the radio can receive the next one, a period later.
+ */
+static void beacon_radio_crcok() {
+    sync_beacon_t beacon;
+
+    if (!sync_beacon_parse(packet, &beacon)) {
+        beacon_stats.invalid++;
+#if BURST_MODE
+        burst_drop();
+#endif
+        return;
+    }
+
+#if BURST_MODE
+    if (!burst_radio_crcok(&beacon)) {
+        return;
+    }
+#endif
+
+    uint32_t missed = sync_beacon_stats_add(&beacon_stats, &beacon, NRF_TIMER2->CC[0], TIMER_PRESCALER);
+#if LOG_MODE
+    if (missed > 0) {
+        NRF_LOG_INFO("beacon %u: %u missed", beacon.sequence, missed);
+    }
+
+    if (sync_beacon_pending(&beacon) && beacon.switch_sequence != beacon_switch) {
+        beacon_switch = beacon.switch_sequence;
+        NRF_LOG_INFO("beacon %u: period %u us, width %u us from beacon %u", beacon.sequence, beacon.next_period_us,
+                     beacon.next_width_us, beacon.switch_sequence);
+    }
+#else
+    (void)missed;
+#endif
+
+    // the width is written after the pulse of this beacon, it is the one of the next beacon
+    uint32_t width_us;
+    uint32_t period_us;
+    sync_beacon_schedule(&beacon, beacon.sequence + 1, &period_us, &width_us);
+
+    uint32_t width  = SYNC_US_TO_TICKS(width_us, TIMER_PRESCALER);
+    uint32_t period = beacon_period;
+
+    // a period longer than the timer is not needed: only the TIMER2 modes use it and they refuse such periods
+    if (beacon.period_us != SYNC_BEACON_PERIOD_LONG &&
+        (uint64_t)beacon.period_us * SYNC_TICKS_PER_MS(TIMER_PRESCALER) / 1000 <= 0xFFFFFFFFUL) {
+        period = SYNC_US_TO_TICKS(beacon.period_us, TIMER_PRESCALER);
+    }
+
+    if (width != beacon_width) {
+        // TIMER0 may be running the current pulse, the width is written once it stops
+        beacon_width         = width;
+        NRF_TIMER0->INTENSET = (TIMER_INTENSET_COMPARE0_Enabled << TIMER_INTENSET_COMPARE0_Pos);
+#if LOG_MODE
+        NRF_LOG_INFO("beacon %u: pulse width %u us", beacon.sequence, width_us);
+#endif
+    }
+
+    if (period != beacon_period) {
+        beacon_period = period;
+#if HOLDOVER_MODE
+        sync_holdover_init(&holdover, beacon_period, MS_TO_TICKS(HOLDOVER_TOLERANCE), HOLDOVER_MAX_PERIODS);
+#endif
+#if SERVO_MODE
+        sync_servo_init(&servo, beacon_period, MS_TO_TICKS(SERVO_TOLERANCE), SERVO_KP_SHIFT, SERVO_KI_SHIFT);
+#endif
+#if RX_WINDOW_MODE
+        sync_window_init(&window, beacon_period, MS_TO_TICKS(RX_WINDOW_LEAD), MS_TO_TICKS(RX_WINDOW_GUARD),
+                         MS_TO_TICKS(RX_WINDOW_GUARD_MAX), RX_WINDOW_MAX_MISSES);
+#endif
+#if LOG_MODE
+        NRF_LOG_INFO("beacon %u: period %u us", beacon.sequence, beacon.period_us);
+#endif
+    }
+
+#if LOG_MODE
+    if (beacon_stats.received % BEACON_LOG_BEACONS == 0) {
+        NRF_LOG_INFO("beacons: %u received, %u missed, %u invalid", beacon_stats.received, beacon_stats.missed,
+                     beacon_stats.invalid);
+        NRF_LOG_INFO("interval error: mean %d ns, min %d ns, max %d ns", sync_beacon_stats_interval_mean(&beacon_stats),
+                     beacon_stats.interval_min, beacon_stats.interval_max);
+#if BURST_MODE
+        for (uint8_t copy = 0; copy < BURST_COPIES; copy++) {
+            NRF_LOG_INFO("burst: %u beacons from copy %u", burst_first[copy], copy);
+            burst_first[copy] = 0;
+        }
+#endif
+    }
+#endif
+
+#if TWO_WAY_MODE
+    twoway_radio_crcok(&beacon);
+#endif
+#if HOP_MODE
+    hop_beacon(&beacon, missed);
+#endif
+}
+
+/**
+ * @brief Function for handling the TIMER0 COMPARE[0] interrupt, only enabled when the width (or the two-way edge) changed.
+ * TIMER0 has just been cleared and stopped by its shortcuts, so CC[0] can be changed without missing a compare.
+ */
+void TIMER0_IRQHandler(void) {
+
+    if (NRF_TIMER0->EVENTS_COMPARE[0]) {
+        NRF_TIMER0->EVENTS_COMPARE[0] = 0;
+
+#if TWO_WAY_MODE
+        NRF_TIMER0->CC[1]    = twoway_edge;
+#endif
+#if TRIGGER_ON_ADDRESS || BURST_MODE || TWO_WAY_MODE
+        NRF_TIMER0->CC[0]    = NRF_TIMER0->CC[1] + beacon_width;
+#else
+        NRF_TIMER0->CC[0]    = beacon_width;
+#endif
+        NRF_TIMER0->INTENCLR = (TIMER_INTENCLR_COMPARE0_Clear << TIMER_INTENCLR_COMPARE0_Pos);
+    }
+}
+
+#if HOLDOVER_MODE
+
+/**
+ * @brief Function for initializing the holdover.
+ * TIMER2 runs freely: every beacon is timestamped on it, and its CC[1] holds the time of the next
+ * holdover pulse (TIMER2 and PPI channel 8 are set up by beacon_setup()). The beacon and holdover pulse links are in two channel groups so that only one of
+ * them can start a pulse in a given period, without waiting for the CPU:
+ *     - a beacon disables the holdover group, the CPU enables it again once CC[1] is one period ahead
+ *     - a holdover pulse disables the pulse group (the beacon link, see ppi_setup()) until the end of
+ *       the pulse, so a late beacon cannot restart it
+ * Connections to be made:
+ *     - Disarm the holdover pulse: EVENTS_CRCOK from RADIO with TASKS_CHG[PPI_GROUP_HOLDOVER].DIS -> PPI channel 8 FORK[8].TEP
+ *     - Set pin high at the predicted time: EVENTS_COMPARE[1] from TIMER2 with TASKS_SET[GPIOTE_CH] -> PPI channel 9, in holdover group
+ *     - Start Timer 0 that manages pulse duration: EVENTS_COMPARE[1] from TIMER2 with TASKS_START from TIMER0 -> PPI channel 9 FORK[9].TEP
+ *     - Disarm the beacon pulse: EVENTS_COMPARE[1] from TIMER2 with TASKS_CHG[PPI_GROUP_PULSE].DIS -> PPI channel 10, in holdover group
+ */
+void holdover_setup() {
+
+    sync_holdover_init(&holdover, beacon_period, MS_TO_TICKS(HOLDOVER_TOLERANCE), HOLDOVER_MAX_PERIODS);
+
+    NRF_PPI->FORK[8].TEP     = (uint32_t)&NRF_PPI->TASKS_CHG[PPI_GROUP_HOLDOVER].DIS;
+
+    NRF_PPI->CH[9].EEP       = (uint32_t)&NRF_TIMER2->EVENTS_COMPARE[1];
+    NRF_PPI->CH[9].TEP       = (uint32_t)&NRF_GPIOTE->TASKS_SET[GPIOTE_CH];
+    NRF_PPI->FORK[9].TEP     = (uint32_t)&NRF_TIMER0->TASKS_START;
+
+    NRF_PPI->CH[10].EEP      = (uint32_t)&NRF_TIMER2->EVENTS_COMPARE[1];
+    NRF_PPI->CH[10].TEP      = (uint32_t)&NRF_PPI->TASKS_CHG[PPI_GROUP_PULSE].DIS;
+
+    NRF_PPI->CHG[PPI_GROUP_HOLDOVER] = (PPI_CHG_CH9_Included  << PPI_CHG_CH9_Pos) |
+                                       (PPI_CHG_CH10_Included << PPI_CHG_CH10_Pos);
+
+    // holdover links stay disabled until the period has been learned
+
+    NRF_TIMER2->EVENTS_COMPARE[1] = 0;
+    NRF_TIMER2->INTENSET          = (TIMER_INTENSET_COMPARE1_Enabled << TIMER_INTENSET_COMPARE1_Pos);
+    NVIC_EnableIRQ(TIMER2_IRQn);
+}
+
+/**
+ * @brief Function for arming the next holdover pulse, or leaving it disarmed if there is none.
+ * CC[1] is set HOLDOVER_TOLERANCE after the predicted CRCOK (sync_holdover_next()): a beacon on
+ * schedule but late disarms the holdover group before the compare, instead of losing to it.
+ */
+static void holdover_schedule() {
+    uint32_t next;
+
+    if (sync_holdover_next(&holdover, &next)) {
+        NRF_TIMER2->CC[1]             = next;
+        NRF_TIMER2->EVENTS_COMPARE[1] = 0;
+        NRF_PPI->TASKS_CHG[PPI_GROUP_HOLDOVER].EN = 1;
+    } else {
+        NRF_PPI->TASKS_CHG[PPI_GROUP_HOLDOVER].DIS = 1;
+    }
+}
+
+/**
+ * @brief Function for handling the RADIO CRCOK event: a beacon was received.
+ */
+static void holdover_radio_crcok() {
+    sync_holdover_report_t report;
+
+    sync_holdover_beacon(&holdover, NRF_TIMER2->CC[0], &report);
+
+    if (report.missed > 0 || !report.on_schedule) {
+        NRF_LOG_INFO("holdover: %u periods, phase error %d ns%s", report.missed,
+                     SYNC_TICKS_TO_NS(report.phase_error, TIMER_PRESCALER), report.on_schedule ? "" : " (resync)");
+    }
+
+    holdover_schedule();
+}
+
+/**
+ * @brief Function for handling the TIMER2 COMPARE[1] event: the predicted beacon time has passed.
+ * The compare also fires when a beacon arrived just before it and its interrupt is not handled yet,
+ * in that case the holdover group is already disabled and no pulse was generated.
+ */
+static void holdover_timer2_compare1() {
+
+    if (NRF_PPI->CHEN & PPI_CHEN_CH9_Msk) {
+        sync_holdover_generated(&holdover);
+        holdover_schedule();
+    }
+}
+
+#endif // HOLDOVER_MODE
+
+#if CLOCK_MODE
+
+/**
+ * @brief Function for initializing the clock output.
+ * PWM1 runs in wave form mode, so every cycle carries its own length (countertop) and is high for its
+ * first half. The cycles of each grid period are computed by sync_clock.c and streamed through two
+ * half buffers played in a loop: when a half ends, PWM1_IRQHandler() refills it while the other one plays.
+ * PWM1 and the TIMERs share the HFCLK, so cycles adding up to the grid period in PWM ticks stay locked
+ * to the pulses. The clock is started by the first pulse of the grid, the start link then disables itself.
+ * Connections to be made:
+ *     - Start the clock on the grid: EVENTS_COMPARE[1] from TIMER2 with TASKS_SEQSTART[0] from PWM1 -> PPI channel 10, in clock group
+ *     - Start only once: EVENTS_COMPARE[1] from TIMER2 with CHG[PPI_GROUP_CLOCK].DIS -> PPI channel 10 FORK[10].TEP
+ */
+void clock_setup() {
+    NRF_GPIO_Type *port = (CLOCK_PIN_PORT == 1) ? NRF_P1 : NRF_P0;
+
+    // idle level while PWM1 is disabled
+    port->OUTCLR                    = (1UL << CLOCK_PIN_NUMBER);
+    port->PIN_CNF[CLOCK_PIN_NUMBER] = (GPIO_PIN_CNF_DIR_Output << GPIO_PIN_CNF_DIR_Pos);
+
+    NRF_PWM1->PSEL.OUT[0]     = (CLOCK_PIN_NUMBER               << PWM_PSEL_OUT_PIN_Pos)  |
+                                (CLOCK_PIN_PORT                 << PWM_PSEL_OUT_PORT_Pos) |
+                                (PWM_PSEL_OUT_CONNECT_Connected << PWM_PSEL_OUT_CONNECT_Pos);
+    NRF_PWM1->MODE            = (PWM_MODE_UPDOWN_Up  << PWM_MODE_UPDOWN_Pos);
+    NRF_PWM1->PRESCALER       = (CLOCK_PWM_PRESCALER << PWM_PRESCALER_PRESCALER_Pos);
+    NRF_PWM1->DECODER         = (PWM_DECODER_LOAD_WaveForm     << PWM_DECODER_LOAD_Pos) |   // countertop in every value
+                                (PWM_DECODER_MODE_RefreshCount << PWM_DECODER_MODE_Pos);
+    for (uint8_t half = 0; half < 2; half++) {
+        NRF_PWM1->SEQ[half].PTR      = (uint32_t)clock_buffer[half];
+        NRF_PWM1->SEQ[half].CNT      = CLOCK_BUFFER_CYCLES * SYNC_CLOCK_WAVE_VALUES;
+        NRF_PWM1->SEQ[half].REFRESH  = 0;
+        NRF_PWM1->SEQ[half].ENDDELAY = 0;
+    }
+    NRF_PWM1->LOOP            = PWM_LOOP_CNT_Msk;      // longest loop, then restarted by the shortcut
+    NRF_PWM1->SHORTS          = (PWM_SHORTS_LOOPSDONE_SEQSTART0_Enabled << PWM_SHORTS_LOOPSDONE_SEQSTART0_Pos);
+    NRF_PWM1->INTENSET        = (PWM_INTENSET_SEQEND0_Enabled << PWM_INTENSET_SEQEND0_Pos) |
+                                (PWM_INTENSET_SEQEND1_Enabled << PWM_INTENSET_SEQEND1_Pos);
+    NVIC_EnableIRQ(PWM1_IRQn);
+
+    NRF_PPI->CH[10].EEP      = (uint32_t)&NRF_TIMER2->EVENTS_COMPARE[1];
+    NRF_PPI->CH[10].TEP      = (uint32_t)&NRF_PWM1->TASKS_SEQSTART[0];
+    NRF_PPI->FORK[10].TEP    = (uint32_t)&NRF_PPI->TASKS_CHG[PPI_GROUP_CLOCK].DIS;
+
+    NRF_PPI->CHG[PPI_GROUP_CLOCK] = (1UL << 10);
+
+    // the start link is enabled with the grid (see clock_restart())
+}
+
+/**
+ * @brief Function for writing the next cycles into a half buffer.
+ */
+static void clock_fill(uint8_t half) {
+    uint16_t *value = clock_buffer[half];
+
+    for (uint32_t i = 0; i < CLOCK_BUFFER_CYCLES; i++) {
+        sync_clock_wave(value, sync_clock_next(&clock_synth));
+        value += SYNC_CLOCK_WAVE_VALUES;
+    }
+}
+
+/**
+ * @brief Function for stopping the clock and arming it on the next pulse of the grid.
+ * Called when the grid is (re)started, before the compare of its first pulse.
+ */
+static void clock_restart(uint32_t period) {
+    uint32_t ticks = period << CLOCK_TICK_SHIFT;
+
+    NRF_PPI->TASKS_CHG[PPI_GROUP_CLOCK].DIS = 1;
+    NRF_PWM1->ENABLE                        = (PWM_ENABLE_ENABLE_Disabled << PWM_ENABLE_ENABLE_Pos);
+    NRF_PWM1->EVENTS_SEQEND[0]              = 0;
+    NRF_PWM1->EVENTS_SEQEND[1]              = 0;
+    NVIC_ClearPendingIRQ(PWM1_IRQn);
+
+    if (ticks / CLOCK_CYCLES > SYNC_PWM_COUNTERTOP_MAX) {
+        NRF_LOG_ERROR("clock: CLOCK_FREQUENCY is too low for the PWM clock, clock disabled");
+        return;
+    }
+
+    sync_clock_init(&clock_synth, CLOCK_CYCLES, ticks);
+    clock_fill(0);
+    clock_fill(1);
+
+    NRF_PWM1->ENABLE                        = (PWM_ENABLE_ENABLE_Enabled << PWM_ENABLE_ENABLE_Pos);
+    NRF_PPI->TASKS_CHG[PPI_GROUP_CLOCK].EN  = 1;
+}
+
+/**
+ * @brief Function for handling the TIMER2 COMPARE[1] event: a grid period starts, fired ticks before next.
+ * The cycles already buffered keep their length, the rest of the period absorbs the correction.
+ */
+static void clock_timer2_compare1(uint32_t fired, uint32_t next) {
+    sync_clock_period(&clock_synth, (next - fired) << CLOCK_TICK_SHIFT);
+}
+
+/**
+ * @brief Function for handling the PWM1 interrupt: a half buffer was played, refill it.
+ */
+void PWM1_IRQHandler(void) {
+
+    if (NRF_PWM1->EVENTS_SEQEND[0]) {
+        NRF_PWM1->EVENTS_SEQEND[0] = 0;
+        clock_fill(0);
+    }
+
+    if (NRF_PWM1->EVENTS_SEQEND[1]) {
+        NRF_PWM1->EVENTS_SEQEND[1] = 0;
+        clock_fill(1);
+    }
+}
+
+#endif // CLOCK_MODE
+
+#if SERVO_MODE
+
+/**
+ * @brief Function for initializing the servo.
+ * TIMER2 runs freely: every beacon is timestamped on it (see beacon_setup()), and its CC[1] holds the
+ * time of the next pulse on the disciplined grid. The beacon link (PPI channel 0) is not used, so all pulses come
+ * from the same timer and a late or early beacon only moves the grid through the filter. It is also
+ * taken out of the pulse group, otherwise the falling edge would enable it again.
+ * Connections to be made:
+ *     - Set pin high on the grid: EVENTS_COMPARE[1] from TIMER2 with TASKS_SET[GPIOTE_CH] -> PPI channel 9
+ *     - Start Timer 0 that manages pulse duration: EVENTS_COMPARE[1] from TIMER2 with TASKS_START from TIMER0 -> PPI channel 9 FORK[9].TEP
+ */
+void servo_setup() {
+
+    sync_servo_init(&servo, beacon_period, MS_TO_TICKS(SERVO_TOLERANCE), SERVO_KP_SHIFT, SERVO_KI_SHIFT);
+
+    NRF_PPI->CH[9].EEP       = (uint32_t)&NRF_TIMER2->EVENTS_COMPARE[1];
+    NRF_PPI->CH[9].TEP       = (uint32_t)&NRF_GPIOTE->TASKS_SET[GPIOTE_CH];
+    NRF_PPI->FORK[9].TEP     = (uint32_t)&NRF_TIMER0->TASKS_START;
+
+    NRF_PPI->CHG[PPI_GROUP_PULSE] = 0;
+    NRF_PPI->CHENCLR = (PPI_CHENCLR_CH0_Clear  << PPI_CHENCLR_CH0_Pos) |
+                       (PPI_CHENCLR_CH13_Clear << PPI_CHENCLR_CH13_Pos);
+
+    // the grid link stays disabled until the first beacon
+
+    NRF_TIMER2->EVENTS_COMPARE[1] = 0;
+    NRF_TIMER2->INTENSET          = (TIMER_INTENSET_COMPARE1_Enabled << TIMER_INTENSET_COMPARE1_Pos);
+    NVIC_EnableIRQ(TIMER2_IRQn);
+}
+
+/**
+ * @brief Function for handling the RADIO CRCOK event: a beacon was received.
+ * The programmed compare is only replaced when the grid is (re)started, with the grid link disabled,
+ * otherwise the correction applies from the pulse after it (see sync_servo_beacon()).
+ */
+static void servo_radio_crcok() {
+    sync_servo_report_t report;
+
+    sync_servo_beacon(&servo, NRF_TIMER2->CC[0], &report);
+
+    if (report.reset) {
+        NRF_PPI->CHENCLR              = (PPI_CHENCLR_CH9_Clear << PPI_CHENCLR_CH9_Pos);
+        NRF_TIMER2->CC[1]             = sync_servo_advance(&servo);
+        NRF_TIMER2->EVENTS_COMPARE[1] = 0;
+#if CLOCK_MODE
+        clock_restart((uint32_t)(servo.period >> SYNC_SERVO_FRAC_BITS));
+#endif
+        NRF_PPI->CHENSET              = (PPI_CHENSET_CH9_Enabled << PPI_CHENSET_CH9_Pos);
+    }
+
+    if (report.reset || servo.beacons % SERVO_LOG_BEACONS == 0) {
+        NRF_LOG_INFO("servo: phase error %d ns, frequency offset %d ppb%s",
+                     SYNC_TICKS_TO_NS(report.phase_error, TIMER_PRESCALER), report.freq_offset_ppb,
+                     report.reset ? " (restart)" : "");
+    }
+}
+
+/**
+ * @brief Function for handling the TIMER2 COMPARE[1] event: a pulse was generated, program the next one.
+ */
+static void servo_timer2_compare1() {
+#if CLOCK_MODE
+    uint32_t fired = NRF_TIMER2->CC[1];
+#endif
+
+    NRF_TIMER2->CC[1] = sync_servo_advance(&servo);
+#if CLOCK_MODE
+    clock_timer2_compare1(fired, NRF_TIMER2->CC[1]);
+#endif
+}
+
+#endif // SERVO_MODE
+
+#if RX_WINDOW_MODE
+
+/**
+ * @brief Function for initializing the windowed receive.
+ * The radio keeps listening continuously (END to START shortcut) until the first beacon. After that,
+ * END disables it and it is only enabled again in the window predicted on TIMER2 (see beacon_setup()):
+ * CC[2] opens the window, CC[3] closes it if no beacon was received, and its interrupt widens the next one.
+ * Connections to be made:
+ *     - Open the window: EVENTS_COMPARE[2] from TIMER2 with TASKS_RXEN from RADIO -> PPI channel 11
+ *     - Close the window: EVENTS_COMPARE[3] from TIMER2 with TASKS_DISABLE from RADIO -> PPI channel 12
+ */
+void window_setup() {
+
+    sync_window_init(&window, beacon_period, MS_TO_TICKS(RX_WINDOW_LEAD), MS_TO_TICKS(RX_WINDOW_GUARD),
+                     MS_TO_TICKS(RX_WINDOW_GUARD_MAX), RX_WINDOW_MAX_MISSES);
+
+    NRF_PPI->CH[11].EEP      = (uint32_t)&NRF_TIMER2->EVENTS_COMPARE[2];
+    NRF_PPI->CH[11].TEP      = (uint32_t)&NRF_RADIO->TASKS_RXEN;
+
+    NRF_PPI->CH[12].EEP      = (uint32_t)&NRF_TIMER2->EVENTS_COMPARE[3];
+    NRF_PPI->CH[12].TEP      = (uint32_t)&NRF_RADIO->TASKS_DISABLE;
+
+    // window links stay disabled while searching
+
+    NRF_TIMER2->EVENTS_COMPARE[3] = 0;
+    NRF_TIMER2->INTENSET          = (TIMER_INTENSET_COMPARE3_Enabled << TIMER_INTENSET_COMPARE3_Pos);
+    NVIC_EnableIRQ(TIMER2_IRQn);
+}
+
+/**
+ * @brief Function for programming the next window, or going back to listening continuously.
+ */
+static void window_schedule() {
+    uint32_t open;
+    uint32_t close;
+
+    if (sync_window_next(&window, &open, &close)) {
+        if (!(NRF_PPI->CHEN & PPI_CHEN_CH11_Msk)) {
+            // leaving the search: stop the reception restarted by the END to START shortcut, the windows
+            // enable the radio from now on
+            NRF_RADIO->SHORTS      = (RADIO_SHORTS_READY_START_Enabled << RADIO_SHORTS_READY_START_Pos) |
+                                     (RADIO_SHORTS_END_DISABLE_Enabled << RADIO_SHORTS_END_DISABLE_Pos);
+            NRF_RADIO->TASKS_DISABLE = 1;
+            radio_relisten           = false;
+
+            NRF_LOG_INFO("window: %u us guard", SYNC_TICKS_TO_NS(sync_window_guard(&window), TIMER_PRESCALER) / 1000);
+        }
+
+        NRF_TIMER2->CC[2]             = open;
+        NRF_TIMER2->CC[3]             = close;
+        NRF_TIMER2->EVENTS_COMPARE[3] = 0;
+        NRF_PPI->CHENSET              = (PPI_CHENSET_CH11_Enabled << PPI_CHENSET_CH11_Pos) |
+                                        (PPI_CHENSET_CH12_Enabled << PPI_CHENSET_CH12_Pos);
+    } else if (NRF_PPI->CHEN & PPI_CHEN_CH11_Msk) {
+        NRF_PPI->CHENCLR  = (PPI_CHENCLR_CH11_Clear << PPI_CHENCLR_CH11_Pos) |
+                            (PPI_CHENCLR_CH12_Clear << PPI_CHENCLR_CH12_Pos);
+        NRF_TIMER2->EVENTS_COMPARE[3] = 0;
+
+        // the window may just have been closed, RXEN is only accepted once the radio is disabled
+        radio_relisten = true;
+        radio_disabled_next();
+
+        NRF_LOG_INFO("window: searching");
+    }
+}
+
+/**
+ * @brief Function for handling the RADIO CRCOK event: a beacon was received.
+ * When both are pending, RADIO is handled before TIMER2 (lower IRQ number, same priority), so a window
+ * closing right after the beacon is cleared here and not counted as a miss.
+ */
+static void window_radio_crcok() {
+    sync_window_beacon(&window, NRF_TIMER2->CC[0]);
+    window_schedule();
+}
+
+/**
+ * @brief Function for handling the TIMER2 COMPARE[3] event: the window closed without a beacon.
+ */
+static void window_timer2_compare3() {
+
+    if (NRF_PPI->CHEN & PPI_CHEN_CH12_Msk) {
+        sync_window_missed(&window);
+        window_schedule();
+#if HOP_MODE
+        hop_missed();
+#endif
+    }
+}
+
+#endif // RX_WINDOW_MODE
+
+#if GROUP_MODE
+
+/**
+ * @brief Function for initializing the sync groups of GROUP_TABLE.
+ * Every group gets a GPIOTE channel, a timer timing its pulse width (TIMER3, then TIMER4), three PPI
+ * channels and a channel group, arranged like the beacon links of ppi_setup(). All the beacon links
+ * start on EVENTS_CRCOK, so the RADIO ADDRESS interrupt reads RXMATCH and only leaves the links of the
+ * matching group connected to it (see group_connect()). The payload and the CRC of the beacon are
+ * still on air then: the routing must be done within their airtime, 200 us on the 2 Mbit PHYs and more on
+ * the others, and a compile-time check keeps GROUP_ROUTE_LATENCY below it.
+ * Connections to be made:
+ *     - Set pin high: EVENTS_CRCOK from RADIO with TASKS_SET[GROUP_GPIOTE_FIRST + i] -> PPI channel GROUP_PPI_FIRST + 3 * i, in group GROUP_PPI_GROUP_FIRST + i
+ *     - Start its timer: EVENTS_CRCOK from RADIO with TASKS_START from the group timer -> PPI channel GROUP_PPI_FIRST + 3 * i FORK.TEP
+ *     - Disarm the beacon link: EVENTS_CRCOK from RADIO with TASKS_CHG[GROUP_PPI_GROUP_FIRST + i].DIS -> PPI channel GROUP_PPI_FIRST + 1 + 3 * i
+ *     - Set pin low after pulse time: EVENTS_COMPARE[0] from the group timer with TASKS_CLR[GROUP_GPIOTE_FIRST + i] -> PPI channel GROUP_PPI_FIRST + 2 + 3 * i
+ *     - Rearm the beacon link: EVENTS_COMPARE[0] from the group timer with TASKS_CHG[GROUP_PPI_GROUP_FIRST + i].EN -> PPI channel GROUP_PPI_FIRST + 2 + 3 * i FORK.TEP
+ */
+void group_setup() {
+    uint32_t addresses = (1UL << GROUP_ADDRESS);
+    uint32_t chen      = 0;
+
+    for (uint8_t i = 0; i < GROUP_COUNT; i++) {
+        if (groups[i].address > 7 || (addresses & (1UL << groups[i].address))) {
+            NRF_LOG_ERROR("groups: address %u is not a free logical address, groups disabled", groups[i].address);
+            return;
+        }
+        addresses |= (1UL << groups[i].address);
+    }
+
+    for (uint8_t i = 0; i < GROUP_COUNT; i++) {
+        NRF_TIMER_Type *timer  = group_timers[i];
+        uint32_t        gpiote = GROUP_GPIOTE_FIRST + i;
+        uint32_t        ppi    = GROUP_PPI_FIRST + 3 * i;
+        uint32_t        chg    = GROUP_PPI_GROUP_FIRST + i;
+
+        sync_beacon_stats_init(&group_stats[i]);
+        group_width[i] = MS_TO_TICKS(PULSE_DURATION);
+
+        NRF_GPIOTE->CONFIG[gpiote] = (GPIOTE_CONFIG_MODE_Task       << GPIOTE_CONFIG_MODE_Pos)     |
+                                     (groups[i].pin                 << GPIOTE_CONFIG_PSEL_Pos)     |
+                                     (groups[i].port                << GPIOTE_CONFIG_PORT_Pos)     |
+                                     (GPIOTE_CONFIG_POLARITY_None   << GPIOTE_CONFIG_POLARITY_Pos) |
+                                     (GPIOTE_CONFIG_OUTINIT_Low     << GPIOTE_CONFIG_OUTINIT_Pos);
+
+        timer->BITMODE   = TIMER_BITMODE_BITMODE_32Bit;
+        timer->PRESCALER = TIMER_PRESCALER;
+        timer->CC[0]     = group_width[i];
+        timer->SHORTS    = (TIMER_SHORTS_COMPARE0_CLEAR_Enabled << TIMER_SHORTS_COMPARE0_CLEAR_Pos) |
+                           (TIMER_SHORTS_COMPARE0_STOP_Enabled  << TIMER_SHORTS_COMPARE0_STOP_Pos);
+
+        // beacon links stay disconnected until a beacon of the group is routed to them
+        NRF_PPI->CH[ppi].EEP         = 0;
+        NRF_PPI->CH[ppi].TEP         = (uint32_t)&NRF_GPIOTE->TASKS_SET[gpiote];
+        NRF_PPI->FORK[ppi].TEP       = (uint32_t)&timer->TASKS_START;
+
+        NRF_PPI->CH[ppi + 1].EEP     = 0;
+        NRF_PPI->CH[ppi + 1].TEP     = (uint32_t)&NRF_PPI->TASKS_CHG[chg].DIS;
+
+        NRF_PPI->CH[ppi + 2].EEP     = (uint32_t)&timer->EVENTS_COMPARE[0];
+        NRF_PPI->CH[ppi + 2].TEP     = (uint32_t)&NRF_GPIOTE->TASKS_CLR[gpiote];
+        NRF_PPI->FORK[ppi + 2].TEP   = (uint32_t)&NRF_PPI->TASKS_CHG[chg].EN;
+
+        NRF_PPI->CHG[chg] = (1UL << ppi);
+        chen |= (1UL << ppi) | (1UL << (ppi + 1)) | (1UL << (ppi + 2));
+
+        timer->EVENTS_COMPARE[0] = 0;
+        NVIC_EnableIRQ(i == 0 ? TIMER3_IRQn : TIMER4_IRQn);
+    }
+
+    group_route = 0;
+    NRF_PPI->CHENSET       = chen;
+    NRF_RADIO->RXADDRESSES = addresses;
+
+    NRF_RADIO->EVENTS_ADDRESS = 0;
+    NRF_RADIO->INTENSET       = (RADIO_INTENSET_ADDRESS_Enabled << RADIO_INTENSET_ADDRESS_Pos);
+}
+
+/**
+ * @brief Function for connecting the beacon links of a chain to EVENTS_CRCOK, or disconnecting them.
+ * Chain 0 is the pulse of GROUP_ADDRESS (ppi_setup(), and the holdover disarm of holdover_setup()),
+ * chain 1 + i the group groups[i]. A disconnected link keeps its channel group state, so a pulse in
+ * progress is still protected when its beacon links are connected again.
+ */
+static void group_connect(uint8_t chain, bool connect) {
+    uint32_t crcok = connect ? (uint32_t)&NRF_RADIO->EVENTS_CRCOK : 0;
+
+    if (chain == 0) {
+        NRF_PPI->CH[0].EEP   = crcok;
+        NRF_PPI->CH[13].EEP  = crcok;
+#if HOLDOVER_MODE
+        NRF_PPI->FORK[8].TEP = connect ? (uint32_t)&NRF_PPI->TASKS_CHG[PPI_GROUP_HOLDOVER].DIS : 0;
+#endif
+    } else {
+        uint32_t ppi = GROUP_PPI_FIRST + 3 * (chain - 1);
+
+        NRF_PPI->CH[ppi].EEP     = crcok;
+        NRF_PPI->CH[ppi + 1].EEP = crcok;
+    }
+}
+
+/**
+ * @brief Function for handling the RADIO ADDRESS event: route the beacon being received to its chain.
+ */
+static void group_radio_address() {
+    uint32_t match = NRF_RADIO->RXMATCH;
+    uint8_t  route = 0;
+
+    for (uint8_t i = 0; i < GROUP_COUNT; i++) {
+        if (groups[i].address == match) {
+            route = 1 + i;
+        }
+    }
+
+    if (route != group_route) {
+        group_connect(group_route, false);
+        group_connect(route, true);
+        group_route = route;
+    }
+}
+
+/**
+ * @brief Function for handling the RADIO CRCOK event for a beacon of GROUP_TABLE: adopt its width.
+ * The period is not needed, the group pulses only follow their beacons.
+ */
+static void group_radio_crcok(uint8_t i) {
+    sync_beacon_t beacon;
+
+    if (!sync_beacon_parse(packet, &beacon)) {
+        group_stats[i].invalid++;
+        return;
+    }
+
+    uint32_t missed = sync_beacon_stats_add(&group_stats[i], &beacon, NRF_TIMER2->CC[0], TIMER_PRESCALER);
+    if (missed > 0) {
+        NRF_LOG_INFO("group %u: beacon %u: %u missed", groups[i].address, beacon.sequence, missed);
+    }
+
+    // as in beacon_radio_crcok(), the width written after this pulse is the one of the next beacon
+    uint32_t width_us;
+    uint32_t period_us;
+    sync_beacon_schedule(&beacon, beacon.sequence + 1, &period_us, &width_us);
+
+    uint32_t width = SYNC_US_TO_TICKS(width_us, TIMER_PRESCALER);
+    if (width != group_width[i]) {
+        group_width[i]              = width;
+        group_timers[i]->INTENSET   = (TIMER_INTENSET_COMPARE0_Enabled << TIMER_INTENSET_COMPARE0_Pos);
+        NRF_LOG_INFO("group %u: beacon %u: pulse width %u us", groups[i].address, beacon.sequence, width_us);
+    }
+
+    if (group_stats[i].received % BEACON_LOG_BEACONS == 0) {
+        NRF_LOG_INFO("group %u: %u received, %u missed, %u invalid", groups[i].address, group_stats[i].received,
+                     group_stats[i].missed, group_stats[i].invalid);
+    }
+}
+
+/**
+ * @brief Function for handling the COMPARE[0] interrupt of a group timer, only enabled when the width changed.
+ * As for TIMER0, the timer has just been cleared and stopped by its shortcuts.
+ */
+static void group_timer_compare0(uint8_t i) {
+    NRF_TIMER_Type *timer = group_timers[i];
+
+    if (timer->EVENTS_COMPARE[0]) {
+        timer->EVENTS_COMPARE[0] = 0;
+
+        timer->CC[0]    = group_width[i];
+        timer->INTENCLR = (TIMER_INTENCLR_COMPARE0_Clear << TIMER_INTENCLR_COMPARE0_Pos);
+    }
+}
+
+/**
+ * @brief Function for handling the TIMER3 interrupt: the pulse of the first group ended.
+ */
+void TIMER3_IRQHandler(void) {
+    group_timer_compare0(0);
+}
+
+/**
+ * @brief Function for handling the TIMER4 interrupt: the pulse of the second group ended.
+ */
+void TIMER4_IRQHandler(void) {
+    group_timer_compare0(1);
+}
+
+#endif // GROUP_MODE
+
+#if HOLDOVER_MODE || SERVO_MODE || RX_WINDOW_MODE || HOP_MODE
+
+/**
+ * @brief Function for handling the TIMER2 interrupt.
+ */
+void TIMER2_IRQHandler(void) {
+
+    if (NRF_TIMER2->EVENTS_COMPARE[1]) {
+        NRF_TIMER2->EVENTS_COMPARE[1] = 0;
+#if HOLDOVER_MODE
+        holdover_timer2_compare1();
+#endif
+#if SERVO_MODE
+        servo_timer2_compare1();
+#endif
+    }
+
+#if RX_WINDOW_MODE
+    if (NRF_TIMER2->EVENTS_COMPARE[3]) {
+        NRF_TIMER2->EVENTS_COMPARE[3] = 0;
+        window_timer2_compare3();
+    }
+#elif HOP_MODE
+    if (NRF_TIMER2->EVENTS_COMPARE[3]) {
+        NRF_TIMER2->EVENTS_COMPARE[3] = 0;
+        hop_missed();
+    }
+#endif
+}
+
+#endif
+
+#if HOP_MODE || TWO_WAY_MODE || RX_WINDOW_MODE
+
+/**
+ * @brief Function for handling the RADIO DISABLED event asked for by radio_disabled_next().
+ * The two-way request goes first, on the channel of the beacon; the channel of the next beacon is set
+ * when it ends.
+ */
+static void radio_disabled() {
+
+    NRF_RADIO->INTENCLR        = (RADIO_INTENCLR_DISABLED_Clear << RADIO_INTENCLR_DISABLED_Pos);
+    NRF_RADIO->EVENTS_DISABLED = 0;
+
+#if TWO_WAY_MODE
+    if (twoway_requesting) {
+        twoway_radio_disabled();
+        return;
+    }
+#endif
+#if HOP_MODE
+    NRF_RADIO->FREQUENCY = hop_table[hop_index];
+#endif
+    if (radio_relisten) {
+        radio_relisten = false;
+        radio_listen();
+    }
+}
+
+#endif // HOP_MODE || TWO_WAY_MODE || RX_WINDOW_MODE
+
+/**
+ * @brief Function for handling the RADIO interrupt.
+ */
+void RADIO_IRQHandler(void) {
+
+#if CALIBRATION_MODE
+    if (NRF_RADIO->EVENTS_END) {
+        NRF_RADIO->EVENTS_END = 0;
+        calibration_radio_end();
+    }
+#endif
+
+#if GROUP_MODE
+    if (NRF_RADIO->EVENTS_ADDRESS) {
+        NRF_RADIO->EVENTS_ADDRESS = 0;
+        group_radio_address();
+    }
+#endif
+
+#if TWO_WAY_MODE
+    if (twoway_sending && NRF_RADIO->EVENTS_END) {
+        NRF_RADIO->EVENTS_END = 0;
+        twoway_radio_end();
+    }
+#endif
+
+#if HOP_MODE || TWO_WAY_MODE || RX_WINDOW_MODE
+    if ((NRF_RADIO->INTENSET & RADIO_INTENSET_DISABLED_Msk) && NRF_RADIO->STATE == RADIO_STATE_STATE_Disabled) {
+        radio_disabled();
+    }
+#endif
+
+    if (NRF_RADIO->EVENTS_CRCOK) {
+        NRF_RADIO->EVENTS_CRCOK = 0;
+#if GROUP_MODE
+        if (group_route != 0) {
+            // the other modes only follow GROUP_ADDRESS
+            group_radio_crcok(group_route - 1);
+            return;
+        }
+#endif
+        beacon_radio_crcok();
+#if HOLDOVER_MODE
+        holdover_radio_crcok();
+#endif
+#if SERVO_MODE
+        servo_radio_crcok();
+#endif
+#if RX_WINDOW_MODE
+        window_radio_crcok();
+#endif
+    }
+}
+
+#if LOG_MODE
+
+/**
+ * @brief Function for initializing the logger (UART backend, see sdk_config.h).
+ */
+void log_setup() {
+    ret_code_t err_code = NRF_LOG_INIT(NULL);
+    APP_ERROR_CHECK(err_code);
+
+    NRF_LOG_DEFAULT_BACKENDS_INIT();
+}
+
+#endif // LOG_MODE
+
 /**
  * @brief Function for application main entry.
  */
 int main(void) {
     // setup peripherals
+#if LOG_MODE
+    log_setup();
+#endif
     gpiote_setup();
     timer0_setup();
     radio_setup();
     ppi_setup();
+    beacon_setup();
+#if OUTPUTS_MODE
+    outputs_setup();
+#endif
+#if PWM_SEQUENCE_MODE
+    pwm_setup();
+#endif
+#if CALIBRATION_MODE
+    calibration_setup();
+#endif
+#if HOLDOVER_MODE
+    holdover_setup();
+#endif
+#if SERVO_MODE
+    servo_setup();
+#endif
+#if CLOCK_MODE
+    clock_setup();
+#endif
+#if RX_WINDOW_MODE
+    window_setup();
+#endif
+#if GROUP_MODE
+    group_setup();
+#endif
+#if HOP_MODE
+    hop_setup();
+#endif
+#if BURST_MODE
+    burst_setup();
+#endif
+#if TWO_WAY_MODE
+    twoway_setup();
+#endif
 
     // start
     // external HFCLK must be started and the Radio must be enabled as TX (now the radio thing will be done through PPI)
     NRF_CLOCK->TASKS_HFCLKSTART = CLOCK_TASKS_HFCLKSTART_TASKS_HFCLKSTART_Trigger;
 
     while (true) {
+#if LOG_MODE
+        if (!NRF_LOG_PROCESS()) {
+            __WFE();
+        }
+#else
         __WFE();
+#endif
     }
 }
 
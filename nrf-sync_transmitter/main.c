@@ -15,6 +15,25 @@
 #include "nrf52840_bitfields.h"
 #include "nrf52840.h"
 #include "nrf52840_peripherals.h"
+#include "app_error.h"
+#include "nrf_log.h"
+#include "nrf_log_ctrl.h"
+#include "nrf_log_default_backends.h"
+#include "app_uart.h"
+#include "sync_timing.h"
+#include "sync_phy.h"
+#include "sync_schedule.h"
+#include "sync_calib.h"
+#include "sync_beacon.h"
+#include "sync_energy.h"
+#include "sync_rtc.h"
+#include "sync_outputs.h"
+#include "sync_pwm.h"
+#include "sync_command.h"
+#include "sync_hop.h"
+#include "sync_scan.h"
+#include "sync_burst.h"
+#include "sync_twoway.h"
 
 //GPIOTE stuff
 #define OUTPUT_PIN_NUMBER    10UL      // output pin number
@@ -28,38 +47,453 @@
 //TIMER stuff
 #define PULSE_DURATION       10        // time in ms
 #define PULSE_PERIOD         1000      // time in ms -> 1 pulse per second
-#define TIMER_OFFSET         0.082     // time in ms
+#define TIMER_OFFSET_TRIM    0         // time in ms, hand-tuned correction added to the PHY timing model
+#define TIMER_OFFSET         (SYNC_PHY_OFFSET_MS(RADIO_PHY, PACKET_BALEN + 1, PACKET_LENGTH, PACKET_CRC_LENGTH) + \
+                              TIMER_OFFSET_TRIM + BURST_DELAY / 1000.0 + TWO_WAY_DELAY - TRIGGER_ADVANCE)
+                                                                   // time in ms to the receiver CRCOK, plus the delays
+                                                                   // of BURST_MODE and TWO_WAY_MODE, or to its address
+                                                                   // trigger with TRIGGER_ON_ADDRESS
+
+//Resolution stuff
+#define TIMER_HIGH_RESOLUTION 0        // 1: timers run at 16 MHz (62.5 ns ticks), periods up to ~268 s
+                                       // 0: timers run at 1 MHz (1 us ticks), periods up to ~71 min
+
+#if TIMER_HIGH_RESOLUTION
+#define TIMER_PRESCALER      SYNC_PRESCALER_16MHZ
+#else
+#define TIMER_PRESCALER      SYNC_PRESCALER_1MHZ
+#endif
+
+#define MS_TO_TICKS(ms)      SYNC_MS_TO_TICKS(ms, TIMER_PRESCALER)
+#define MS_TO_US(ms)         SYNC_MS_TO_TICKS(ms, SYNC_PRESCALER_1MHZ)
+
+#if !SYNC_TICKS_FIT_32BIT(PULSE_DURATION, TIMER_PRESCALER)
+#error "PULSE_DURATION overflows the 32-bit timer at this resolution"
+#endif
+
+//Schedule stuff
+#define SCHEDULE_FREE_RUNNING 0        // 1: TIMER0 is never stopped, every edge is a compare on one timebase and
+                                       //    the period is exactly PULSE_PERIOD (TIMER1 is not used)
+                                       // 0: TIMER0 is stopped at CC[2] and restarted by TIMER1 after the offset
+
+//Duty cycle stuff
+#define DUTY_CYCLE_MODE      0         // 1: HFCLK and the radio are stopped after every pulse, RTC2 keeps the period
+                                       //    (up to ~12 days) and TIMER1 adds the fine remainder after an RTC tick
+#define DUTY_CYCLE_WAKE_LEAD 1.0       // time in ms from HFCLK start to radio start, must cover the HFXO startup
+                                       // and RADIO_RAMPUP (with margin, the pulse jitter does not depend on it)
+#define DUTY_CYCLE_HFXO_STARTUP 0.4    // time in ms, HFXO startup time, only used by the energy model
+
+#define DUTY_CYCLE_PERIOD_US ((uint64_t)PULSE_PERIOD * 1000)
+
+#if DUTY_CYCLE_MODE && SCHEDULE_FREE_RUNNING
+#error "DUTY_CYCLE_MODE stops TIMER0 between pulses, disable SCHEDULE_FREE_RUNNING"
+#endif
+
+#if !DUTY_CYCLE_MODE && !SYNC_TICKS_FIT_32BIT(PULSE_PERIOD, TIMER_PRESCALER)
+#error "PULSE_PERIOD overflows the 32-bit timer at this resolution, longer periods need DUTY_CYCLE_MODE"
+#endif
+
+#if DUTY_CYCLE_MODE && (PULSE_PERIOD >= 1048576000)
+#error "DUTY_CYCLE_MODE periods must fit in half the 24-bit RTC counter with 125 ms ticks (~12 days)"
+#endif
+
+//Outputs stuff
+#define OUTPUTS_MODE         0         // 1: also drive the outputs of OUTPUT_TABLE, each with its own delay after the
+                                       //    rising edge of the pulse and its own width (TIMER3 and TIMER4)
+#define OUTPUT_TABLE         { OUTPUT(1UL, 11UL, 1, 2),     \
+                               OUTPUT(1UL, 12UL, 5, 0.5) }  // (port, pin, delay in ms, width in ms), same as the receiver
+#define OUTPUT_GPIOTE_FIRST  2         // GPIOTE channel of the first output, then one per output
+#define OUTPUT_PPI_FIRST     10        // PPI channel starting the output timers, then two per output
+
+#define OUTPUT(port, pin, delay, width) { (port), (pin), MS_TO_TICKS(delay), MS_TO_TICKS(width) }
+
+#define OUTPUT_MAX_GPIOTE    (GPIOTE_CH_NUM - OUTPUT_GPIOTE_FIRST)
+#define OUTPUT_MAX_PPI       ((PPI_CH_NUM - OUTPUT_PPI_FIRST - 1) / 2)
+#define OUTPUT_MAX_TIMER     (2 * (TIMER3_CC_NUM / 2))
+
+#if OUTPUTS_MODE && DUTY_CYCLE_MODE
+#error "OUTPUTS_MODE keeps TIMER3 and TIMER4 running after the pulse, when DUTY_CYCLE_MODE has stopped the HFXO"
+#endif
+
+//PWM stuff
+#define PWM_SEQUENCE_MODE    0         // 1: the rising edge also starts PWM0, which plays PWM_PATTERN on its own pin
+                                       //    from RAM through EasyDMA (bursts, trains, encoded IDs), with no CPU
+#define PWM_PIN_NUMBER       13UL      // PWM output pin number
+#define PWM_PIN_PORT         1UL       // PWM output pin port
+#define PWM_PATTERN          { PWM_SEGMENT(1, 0.1), PWM_SEGMENT(0, 0.1), PWM_SEGMENT(1, 0.1), \
+                               PWM_SEGMENT(0, 0.3), PWM_SEGMENT(1, 0.5) }   // (level, time in ms) from the rising
+                                                                            // edge, same as the receiver
+#define PWM_SLOT             0.1       // time in ms of one PWM period, holding at most one edge of the pattern
+#define PWM_PRESCALER        SYNC_PRESCALER_16MHZ  // PWM clock, same encoding as the TIMER prescaler
+#define PWM_SEQUENCE_MAX     64        // longest sequence in slots
+#define PWM_PPI_CH           9        // PPI channel starting the sequence
+
+#define PWM_MS_TO_TICKS(ms)  SYNC_MS_TO_TICKS(ms, PWM_PRESCALER)
+#define PWM_SEGMENT(level, time) { (level), PWM_MS_TO_TICKS(time) }
+
+#if PWM_SEQUENCE_MODE && DUTY_CYCLE_MODE
+#error "PWM_SEQUENCE_MODE keeps PWM0 running after the pulse, when DUTY_CYCLE_MODE has stopped the HFXO"
+#endif
+
+//Calibration stuff
+#define CALIBRATION_MODE     0         // 1: measure the radio timing and write the resulting offset into TIMER1 CC[0]
+#define CALIB_SAMPLES        16        // number of packets averaged before the offset is applied
+#define CALIB_RX_CHAIN_DELAY SYNC_PHY_RX_CHAIN_DELAY_MS(RADIO_PHY)   // time in ms, how much later the receiver END
+                                                                   // event fires compared to ours
+#define CALIB_RX_TRIGGER_DELAY (-TRIGGER_ADVANCE)  // time in ms from the receiver END to its pulse trigger, from the
+                                       // PHY model (0 on CRCOK, negative on the address) or as logged by the receiver
+                                       // in its own CALIBRATION_MODE. It is not sent over the air: only the transmitter
+                                       // side is measured at runtime, TWO_WAY_MODE measures each receiver instead
+
+#if CALIBRATION_MODE && SCHEDULE_FREE_RUNNING
+#error "CALIBRATION_MODE applies the offset through TIMER1 CC[0], disable SCHEDULE_FREE_RUNNING"
+#endif
+
+#if CALIBRATION_MODE && DUTY_CYCLE_MODE
+#error "CALIBRATION_MODE expects the radio to start with TIMER1, which DUTY_CYCLE_MODE delays by the fine remainder"
+#endif
+
+//Command stuff
+#define COMMAND_MODE         0         // 1: PULSE_PERIOD, PULSE_DURATION and TIMER_OFFSET can be changed at runtime with
+                                       //    the binary commands of sync_command.h, applied at the next period boundary
+#define COMMAND_RX_PIN_NUMBER 8UL      // command UART RX pin number
+#define COMMAND_RX_PIN_PORT  1UL       // command UART RX pin port
+#define COMMAND_TX_PIN_NUMBER 9UL      // command UART TX pin number (acknowledgements)
+#define COMMAND_TX_PIN_PORT  1UL       // command UART TX pin port
+#define COMMAND_BAUDRATE     UART_BAUDRATE_BAUDRATE_Baud115200
+#define COMMAND_FIFO_SIZE    64        // bytes of the RX and TX FIFOs, a power of two
+#define COMMAND_MARGIN       0.01      // time in ms, bound on the commit interrupt latency: shortest offset, and
+                                       // shortest gap between the end of the pulse and the end of the period.
+                                       // The commit runs at COMMAND_IRQ_PRIORITY, above every other interrupt,
+                                       // so its latency is the interrupt entry and the few loads before the
+                                       // writes, below 1 us at 64 MHz, plus any critical section of the SDK
+#define COMMAND_IRQ_PRIORITY APP_IRQ_PRIORITY_HIGHEST  // EGU0 commit interrupt priority
+#define COMMAND_OTHER_PRIORITY APP_IRQ_PRIORITY_HIGH   // RADIO and TIMER0 interrupts, preempted by the commit
+#define COMMAND_SWITCH_LEAD  4         // beacons announcing a change before the first one sent with it
+#define COMMAND_PPI_CH       8         // PPI channel triggering the commit (free without DUTY_CYCLE_MODE)
+#define COMMAND_EGU_CH       0         // EGU0 channel of the commit interrupt
+
+#define COMMAND_PIN(port, pin) (((port) << 5) | (pin))
+#define COMMAND_MAX_US       (0xFFFFFFFFUL / (SYNC_TICKS_PER_MS(TIMER_PRESCALER) / 1000))   // longest value in us
+
+#if COMMAND_MODE && (SCHEDULE_FREE_RUNNING || DUTY_CYCLE_MODE)
+#error "COMMAND_MODE rewrites the TIMER0 and TIMER1 compares of the default schedule, disable SCHEDULE_FREE_RUNNING and DUTY_CYCLE_MODE"
+#endif
+
+#if COMMAND_MODE && (COMMAND_SWITCH_LEAD < 1)
+#error "COMMAND_SWITCH_LEAD must be at least 1, the change is announced before it is applied"
+#endif
+
+#if COMMAND_MODE && CALIBRATION_MODE
+#error "COMMAND_MODE and CALIBRATION_MODE both write the offset into TIMER1 CC[0]"
+#endif
+
+//Group stuff
+#define GROUP_ADDRESS        0         // logical address (0 to 7) sent on, transmitters sharing a frequency need their own
+
+#if GROUP_ADDRESS > 7
+#error "GROUP_ADDRESS must be a logical address from 0 to 7"
+#endif
+
+//Hop stuff
+#define HOP_MODE             0         // 1: every beacon goes out on a channel of HOP_TABLE picked from its sequence
+                                       //    number (sync_hop.h), the radio is retuned after every beacon
+#define HOP_TABLE            { 4, 9, 14, 19, 24, 29, 34, 39, 44, 49, 54, 59, 64, 69, 74, 79 }   // FREQUENCY values
+                                       // (2400 + n MHz), same as the receiver
+#define HOP_MAP              0xFFFFUL  // channels of HOP_TABLE in use (bit i: entry i), announced in the beacons,
+                                       // COMMAND_MODE can change it (see the receiver loss statistics)
+#define HOP_SEED             GROUP_ADDRESS   // key of the hop sequence, same as the receiver
+#define HOP_SWITCH_LEAD      8         // beacons announcing a new channel map before the first one sent with it
+
+#if HOP_MODE && HOP_SWITCH_LEAD < 1
+#error "HOP_SWITCH_LEAD must be at least 1, the receivers need a beacon announcing the new channel map"
+#endif
+
+//Scan stuff
+#define SCAN_MODE            0         // 1: sample the noise floor of one channel of HOP_TABLE with RSSI right after a beacon,
+                                       //    and move the group to the best channels after every round of the table
+                                       //    (sync_scan.h), announced HOP_SWITCH_LEAD beacons ahead
+#define SCAN_BEACONS         4         // beacons between two samples
+#define SCAN_CHANNELS        1         // channels of the map chosen, 1 to stay on the best channel
+#define SCAN_HYSTERESIS      3UL       // improvement in dB the best channels need to replace the map in use
+
+#if SCAN_MODE && !HOP_MODE
+#error "SCAN_MODE moves the group with the channel maps of HOP_MODE, it is needed on both boards"
+#endif
+
+#if SCAN_MODE && (SCAN_BEACONS < 1 || SCAN_CHANNELS < 1)
+#error "SCAN_BEACONS and SCAN_CHANNELS must be at least 1"
+#endif
+
+//Burst stuff
+#define BURST_MODE           0         // 1: every beacon is sent BURST_COPIES times, BURST_SPACING apart, and the pulse
+                                       //    waits for the time of the last copy (sync_burst.h), same as the receiver
+#define BURST_COPIES         3         // copies per beacon, from 2 to SYNC_BURST_MAX_COPIES
+#define BURST_SPACING        600       // time in us between the starts of two copies, same as the receiver: the frame
+                                       // time plus a bound on the END interrupt latency
+#define BURST_MARGIN         50        // time in us from the last copy to the rising edge, same as the receiver
+#define BURST_PPI_CH         19        // PPI channel starting the next copy
+
+#if BURST_MODE
+#define BURST_DELAY          ((BURST_COPIES - 1) * BURST_SPACING + BURST_MARGIN)   // time in us added to the offset
+#else
+#define BURST_DELAY          0
+#endif
+
+#if BURST_MODE && (BURST_COPIES < 2 || BURST_COPIES > SYNC_BURST_MAX_COPIES)
+#error "BURST_COPIES must be from 2 to SYNC_BURST_MAX_COPIES"
+#endif
+
+#if BURST_MODE && CALIBRATION_MODE
+#error "CALIBRATION_MODE times a single packet, the copies of BURST_MODE overwrite its captures"
+#endif
+
+//Two-way stuff
+#define TWO_WAY_MODE         0         // 1: listen for a two-way request after every beacon and answer it in the next one
+                                       //    (sync_twoway.h), so every receiver measures its own delay
+#define TWO_WAY_NODES        4         // receivers taking turns, each one sends a request every TWO_WAY_NODES beacons
+#define TWO_WAY_ADDRESS      7         // logical address of the requests, not followed by the receivers
+#define TWO_WAY_REPLY_DELAY  500       // time in us from the beacon CRCOK to the request start, same as the receivers:
+                                       // covers the turnaround of both radios
+#define TWO_WAY_HEADROOM     0.05      // time in ms added to the offset, the receivers wait it minus their own delay error
+#define TWO_WAY_WINDOW       0.05      // time in ms of listening after the request is due
+#define TWO_WAY_PPI_CH       5         // PPI channel timestamping the request (free without CALIBRATION_MODE)
+#define TWO_WAY_TIMEOUT_PPI_CH 6       // PPI channel ending the listen after TWO_WAY_WINDOW (free without CALIBRATION_MODE)
+
+#if TWO_WAY_MODE
+#define TWO_WAY_DELAY        TWO_WAY_HEADROOM
+#else
+#define TWO_WAY_DELAY        0
+#endif
+
+#if TWO_WAY_MODE && (TWO_WAY_NODES < 1 || TWO_WAY_NODES > SYNC_TWOWAY_MAX_NODES)
+#error "TWO_WAY_NODES must be from 1 to SYNC_TWOWAY_MAX_NODES"
+#endif
+
+#if TWO_WAY_MODE && (TWO_WAY_ADDRESS > 7 || TWO_WAY_ADDRESS == GROUP_ADDRESS)
+#error "TWO_WAY_ADDRESS must be a logical address (0 to 7) other than GROUP_ADDRESS"
+#endif
+
+#if TWO_WAY_MODE && (DUTY_CYCLE_MODE || CALIBRATION_MODE || BURST_MODE)
+#error "TWO_WAY_MODE listens right after the beacon, DUTY_CYCLE_MODE, CALIBRATION_MODE and BURST_MODE use the radio then"
+#endif
+
+//Trigger stuff
+#define TRIGGER_ON_ADDRESS   0         // same as the receiver: 1 when it arms its pulse on EVENTS_ADDRESS, so the offset
+                                       // no longer waits for the payload and the CRC
+#define TRIGGER_DELAY        0.001     // time in ms from the receiver EVENTS_ADDRESS to its rising edge, same as the receiver
+
+#if TRIGGER_ON_ADDRESS
+#define TRIGGER_ADVANCE      (SYNC_PHY_ADDRESS_TO_END_MS(RADIO_PHY, PACKET_LENGTH, PACKET_CRC_LENGTH) - TRIGGER_DELAY)
+                                       // time in ms the receiver edge comes before its CRCOK
+#else
+#define TRIGGER_ADVANCE      0
+#endif
+
+#if TRIGGER_ON_ADDRESS && (BURST_MODE || TWO_WAY_MODE)
+#error "BURST_MODE and TWO_WAY_MODE receivers only support the CRCOK trigger, disable TRIGGER_ON_ADDRESS"
+#endif
+
+//Log stuff
+#define LOG_MODE             (OUTPUTS_MODE || PWM_SEQUENCE_MODE || CALIBRATION_MODE || HOP_MODE || BURST_MODE || \
+                              COMMAND_MODE || DUTY_CYCLE_MODE)    // the modes that log, the logger is only built for them
 
 //Radio stuff
-#define MAGIC_NUMBER         42
+#define RADIO_PHY            SYNC_PHY_NRF_1MBIT    // one of SYNC_PHY_NRF_1MBIT, SYNC_PHY_NRF_2MBIT, SYNC_PHY_BLE_1MBIT,
+                                                   // SYNC_PHY_BLE_2MBIT, SYNC_PHY_BLE_LR125KBIT or SYNC_PHY_BLE_LR500KBIT
+                                                   // (long range), must be the same on both boards
+#define PACKET_BALEN         SYNC_PHY_BALEN(RADIO_PHY)   // base address length in bytes (plus 1 prefix byte)
+#define PACKET_LENGTH        SYNC_BEACON_LENGTH    // payload length in bytes (see sync_beacon.h)
+#define PACKET_CRC_LENGTH    2UL       // CRC length in bytes
+
+#define RADIO_TX_POWER       RADIO_TXPOWER_TXPOWER_0dBm    // up to RADIO_TXPOWER_TXPOWER_Pos8dBm for long range sites
+
+#define RADIO_FAST_RAMPUP    0         // 1: MODECNF0.RU = Fast, TXEN/RXEN to READY in ~40 us instead of ~140 us
+
+#if RADIO_FAST_RAMPUP
+#define RADIO_RAMPUP         SYNC_RADIO_RAMPUP_FAST_MS     // time in ms
+#define RADIO_RU             RADIO_MODECNF0_RU_Fast
+#else
+#define RADIO_RAMPUP         SYNC_RADIO_RAMPUP_DEFAULT_MS  // time in ms
+#define RADIO_RU             RADIO_MODECNF0_RU_Default
+#endif
+
+static uint8_t       packet[PACKET_LENGTH];    // beacon, packed in place before every transmission
+static sync_beacon_t beacon;
+
+#if DUTY_CYCLE_MODE
+static sync_rtc_t      rtc;
+static sync_rtc_slot_t rtc_slot;               // period being prepared, or about to start
+#endif
+
+#if OUTPUTS_MODE
+static const sync_output_t outputs[] = OUTPUT_TABLE;
+static bool                outputs_enabled;    // OUTPUT_TABLE fits in the period, see outputs_setup()
+
+#define OUTPUT_COUNT         (sizeof(outputs) / sizeof(outputs[0]))
+
+_Static_assert(OUTPUT_COUNT <= OUTPUT_MAX_GPIOTE, "OUTPUT_TABLE needs more GPIOTE channels than available");
+_Static_assert(OUTPUT_COUNT <= OUTPUT_MAX_PPI,    "OUTPUT_TABLE needs more PPI channels than available");
+_Static_assert(OUTPUT_COUNT <= OUTPUT_MAX_TIMER,  "OUTPUT_TABLE needs more TIMER3/TIMER4 compares than available");
+#endif
+
+#if PWM_SEQUENCE_MODE
+static const sync_pwm_segment_t pwm_pattern[] = PWM_PATTERN;
+static uint16_t                 pwm_sequence[PWM_SEQUENCE_MAX];   // read by PWM0 through EasyDMA
+static uint16_t                 pwm_length;                       // slots of pwm_sequence, 0 if disabled
+
+#define PWM_SEGMENTS         (sizeof(pwm_pattern) / sizeof(pwm_pattern[0]))
+
+_Static_assert(PWM_MS_TO_TICKS(PWM_SLOT) <= SYNC_PWM_COUNTERTOP_MAX, "PWM_SLOT is longer than a PWM period can be at this PWM_PRESCALER");
+#endif
+
+#if CALIBRATION_MODE
+static sync_calib_t calib;
+static uint32_t     calib_offset;              // offset waiting to be written into TIMER1 CC[0]
+#endif
+
+#if HOP_MODE
+static const uint8_t  hop_table[] = HOP_TABLE;
+static volatile uint32_t hop_next_map;         // map to announce once no change is pending, set by the commands and the scan
+static uint8_t        hop_next;                // table index of the next beacon, tuned once the radio is disabled
+static bool           hop_sample;              // sample a channel (SCAN_MODE) before tuning to hop_next
+
+#define HOP_CHANNELS         (sizeof(hop_table) / sizeof(hop_table[0]))
+
+_Static_assert(HOP_CHANNELS <= SYNC_HOP_MAX_CHANNELS, "HOP_TABLE has more channels than the channel map");
+_Static_assert(HOP_MAP != 0 && ((uint64_t)HOP_MAP >> HOP_CHANNELS) == 0, "HOP_MAP must select channels of HOP_TABLE");
+#endif
+
+#if BURST_MODE
+static uint8_t  burst_packet[PACKET_LENGTH];   // copies after the first, written from packet right before they are sent
+static uint8_t  burst_copy;                    // copy on air
+static uint32_t burst_disable;                 // END to DISABLE shortcut, only kept for the last copy
+
+_Static_assert(BURST_SPACING > 1000 * SYNC_PHY_FRAME_TIME_MS(RADIO_PHY, PACKET_BALEN + 1, PACKET_LENGTH, PACKET_CRC_LENGTH),
+               "BURST_SPACING is shorter than a frame");
+#endif
+
+#if TWO_WAY_MODE
+static uint8_t  twoway_packet[PACKET_LENGTH];  // request, received right after the beacon
+static uint32_t twoway_chen;                    // ADDRESS link, off while listening
+static uint32_t twoway_shorts;                  // radio shortcuts of the beacons, restored after the listen
+static bool     twoway_listening;               // in RX, the next DISABLED ends the listen
+
+_Static_assert(TWO_WAY_REPLY_DELAY > 2000 * RADIO_RAMPUP, "TWO_WAY_REPLY_DELAY must cover the radio turnaround of both boards");
+#endif
 
-static uint8_t packet        = MAGIC_NUMBER; 
+#if SCAN_MODE
+static sync_scan_t scan;
+static bool        scan_sampling;              // the radio samples a channel, its events belong to scan_radio_event()
+static bool        scan_round;                 // the sample ends a round of HOP_TABLE
+static uint8_t     scan_index;                 // table index of the channel sampled
+static uint8_t     scan_next;                  // table index of the next beacon, tuned once the sample is in
+static uint32_t    scan_chen;                  // calibration and ADDRESS links, off while sampling
+static uint32_t    scan_shorts;                // radio shortcuts of the beacons, restored after the sample
+
+_Static_assert(SCAN_CHANNELS <= HOP_CHANNELS, "SCAN_CHANNELS is larger than HOP_TABLE");
+#endif
+
+#if COMMAND_MODE
+static sync_command_parser_t command_parser;
+static sync_command_config_t command_config;   // schedule in use, in us
+static sync_command_config_t command_next;     // schedule of the pending command, in us
+static sync_schedule_t       command_shadow;   // compares of command_next, committed at the end of a period
+static sync_command_t        command_pending;  // command acknowledged once command_shadow is committed
+static volatile bool         command_staged;   // command_shadow is ready, cleared by the TIMER0 interrupt
+static volatile bool         command_announced;// the beacons announce command_next, until its switch sequence
+static volatile bool         command_armed;    // the commit link is enabled, cleared by the EGU0 interrupt
+static volatile bool         command_applied;  // command_shadow was committed, cleared once acknowledged
+#endif
 
 
 /**
  * @brief Function for initializing output pin with GPIOTE.
- * It will be set in Task mode with action on pin configured to toggle.
- * Pin is set to begin low. 
+ * It will be set in Task mode, edges are driven with TASKS_SET and TASKS_CLR
+ * so the pin level never depends on the previous edge. Pin is set to begin low. 
  */
 void gpiote_setup() {
     NRF_GPIOTE->CONFIG[GPIOTE_CH_PULSE] = (GPIOTE_CONFIG_MODE_Task       << GPIOTE_CONFIG_MODE_Pos)     |
                                           (OUTPUT_PIN_NUMBER             << GPIOTE_CONFIG_PSEL_Pos)     |
                                           (OUTPUT_PIN_PORT               << GPIOTE_CONFIG_PORT_Pos)     |
-                                          (GPIOTE_CONFIG_POLARITY_Toggle << GPIOTE_CONFIG_POLARITY_Pos) |
+                                          (GPIOTE_CONFIG_POLARITY_None   << GPIOTE_CONFIG_POLARITY_Pos) |
                                           (GPIOTE_CONFIG_OUTINIT_Low     << GPIOTE_CONFIG_OUTINIT_Pos);
 }
 
+#if SCHEDULE_FREE_RUNNING
+
+/**
+ * @brief Function for initializing TIMER0 in free-running mode.
+ * This Timer will be in charge of managing the offset, the pulse duration and the period.
+ * It is started once and never stopped: CC[2] clears it and starts the radio, so the next
+ * period begins exactly PULSE_PERIOD after the previous one no matter what the radio does.
+ * PRESCALER = TIMER_PRESCALER, MODE = Timer
+ */
+void timer0_setup() {
+
+    sync_schedule_t    schedule = {
+        .period = MS_TO_TICKS(PULSE_PERIOD),
+        .offset = MS_TO_TICKS(TIMER_OFFSET),
+        .width  = MS_TO_TICKS(PULSE_DURATION),
+    };
+    sync_schedule_cc_t cc;
+
+    if (!sync_schedule_compute(&schedule, &cc)) {
+        // pulse does not fit in the period, nothing sensible to generate
+        while (true) {
+            __WFE();
+        }
+    }
+
+    NRF_TIMER0->BITMODE   = TIMER_BITMODE_BITMODE_32Bit;
+    NRF_TIMER0->PRESCALER = TIMER_PRESCALER;
+
+    NRF_TIMER0->CC[0]   = cc.rise;      // offset after the radio start -> pin high
+    NRF_TIMER0->CC[1]   = cc.fall;      // end of the pulse             -> pin low
+    NRF_TIMER0->CC[2]   = cc.period;    // end of period                -> radio start
+
+    // event when CC[2] is shortcutted to clear timer task only, the timer keeps counting
+
+    NRF_TIMER0->SHORTS  = (TIMER_SHORTS_COMPARE2_CLEAR_Enabled << TIMER_SHORTS_COMPARE2_CLEAR_Pos);
+}
+
+#else
+
+#if DUTY_CYCLE_MODE
+
+/**
+ * @brief Function for initializing TIMER0 for the duty-cycled mode.
+ * This Timer will be in charge of managing the pulse duration only, the period is kept by RTC2.
+ * PRESCALER = TIMER_PRESCALER, MODE = Timer
+ */
+void timer0_setup() {
+
+    NRF_TIMER0->BITMODE   = TIMER_BITMODE_BITMODE_32Bit;
+    NRF_TIMER0->PRESCALER = TIMER_PRESCALER;
+
+    NRF_TIMER0->CC[1]   = MS_TO_TICKS(PULSE_DURATION);
+
+    // event when CC[1] will be connected via PPI to the GPIOTE task and to stop HFCLK,
+    // and shortcutted to clear timer task and to stop timer
+
+    NRF_TIMER0->SHORTS  = (TIMER_SHORTS_COMPARE1_CLEAR_Enabled << TIMER_SHORTS_COMPARE1_CLEAR_Pos) |
+                          (TIMER_SHORTS_COMPARE1_STOP_Enabled  << TIMER_SHORTS_COMPARE1_STOP_Pos);
+}
+
+#else
+
 /**
  * @brief Function for initializing TIMER0.
  * This Timer will be in charge of managing the pulse duration and period.
- * Default values: PRESCALER = 4, MODE = Timer
+ * PRESCALER = TIMER_PRESCALER, MODE = Timer
  */
 void timer0_setup() {
 
-    NRF_TIMER0->BITMODE = TIMER_BITMODE_BITMODE_32Bit;
+    NRF_TIMER0->BITMODE   = TIMER_BITMODE_BITMODE_32Bit;
+    NRF_TIMER0->PRESCALER = TIMER_PRESCALER;
 
-    NRF_TIMER0->CC[1]   = PULSE_DURATION * 1000;
-    NRF_TIMER0->CC[2]   = PULSE_PERIOD   * 1000; // end of Timer (minus Timer offset to avoid counting twice the offset)
+    NRF_TIMER0->CC[1]   = MS_TO_TICKS(PULSE_DURATION);
+    NRF_TIMER0->CC[2]   = MS_TO_TICKS(PULSE_PERIOD); // end of Timer (minus Timer offset to avoid counting twice the offset)
 
     // event when CC[1] will be connected via PPI to the GPIOTE task
     // event when CC[2] is shortcutted to clear timer task and to stop timer
@@ -69,22 +503,27 @@ void timer0_setup() {
                           (TIMER_SHORTS_COMPARE2_STOP_Enabled  << TIMER_SHORTS_COMPARE2_STOP_Pos);
 }
 
+#endif // DUTY_CYCLE_MODE
+
 /**
  * @brief Function for initializing TIMER1. This Timer will be in charge of managing the offset.
- * Default values: PRESCALER = 4, MODE = Timer
+ * PRESCALER = TIMER_PRESCALER, MODE = Timer
  */
  void timer1_setup() {
     
-    NRF_TIMER1->BITMODE = TIMER_BITMODE_BITMODE_32Bit;
+    NRF_TIMER1->BITMODE   = TIMER_BITMODE_BITMODE_32Bit;
+    NRF_TIMER1->PRESCALER = TIMER_PRESCALER;
 
-    NRF_TIMER1->CC[0]   = TIMER_OFFSET * 1000; 
+    NRF_TIMER1->CC[0]   = MS_TO_TICKS(TIMER_OFFSET); 
 
-     // once this timer reaches the offset time, it clears, stops and through PPI starts Timer 0 and toggles the GPIOTE
+     // once this timer reaches the offset time, it clears, stops and through PPI starts Timer 0 and sets the GPIOTE pin
 
     NRF_TIMER1->SHORTS  = (TIMER_SHORTS_COMPARE0_CLEAR_Enabled << TIMER_SHORTS_COMPARE0_CLEAR_Pos) | 
                           (TIMER_SHORTS_COMPARE0_STOP_Enabled  << TIMER_SHORTS_COMPARE0_STOP_Pos);
  }
 
+#endif // SCHEDULE_FREE_RUNNING
+
 /**
  * @brief Function for initializing RADIO. 
  * Radio will be in charge of sending a determined packet that the receiver will
@@ -93,9 +532,11 @@ void timer0_setup() {
  */
 void radio_setup() {
 
-    NRF_RADIO->TXPOWER       = (RADIO_TXPOWER_TXPOWER_0dBm << RADIO_TXPOWER_TXPOWER_Pos);
+    NRF_RADIO->TXPOWER       = (RADIO_TX_POWER << RADIO_TXPOWER_TXPOWER_Pos);
     NRF_RADIO->FREQUENCY     = 7UL; // frequency bin 7, 2407MHz
-    NRF_RADIO->MODE          = (RADIO_MODE_MODE_Nrf_1Mbit << RADIO_MODE_MODE_Pos);
+    NRF_RADIO->MODE          = (SYNC_PHY_MODE(RADIO_PHY) << RADIO_MODE_MODE_Pos);
+    NRF_RADIO->MODECNF0      = (RADIO_RU                   << RADIO_MODECNF0_RU_Pos) |   // ramp-up time
+                               (RADIO_MODECNF0_DTX_Center  << RADIO_MODECNF0_DTX_Pos);   // default TX value (reset value)
 
     // address configuration (just random numbers I chose)
     NRF_RADIO->PREFIX0       = (0xF3UL << RADIO_PREFIX0_AP3_Pos) |   // prefix byte of address 3
@@ -112,14 +553,14 @@ void radio_setup() {
 
     NRF_RADIO->BASE1         = 0x16081931UL;     // base address for prefix 1-7
 
-    NRF_RADIO->TXADDRESS     = 0UL;              // set device address 0 to use when transmitting
+    NRF_RADIO->TXADDRESS     = GROUP_ADDRESS;    // logical address of the sync group, selects the prefix and base
 
     // packet configuration
-    NRF_RADIO->PCNF0    = 0UL; //not really interested in these
+    NRF_RADIO->PCNF0    = SYNC_PHY_PCNF0(RADIO_PHY); // preamble length (and coded PHY fields), the rest is not used
 
-    NRF_RADIO->PCNF1    = (1UL                          << RADIO_PCNF1_MAXLEN_Pos)  |    // only sending a 1 byte number
-                          (1UL                          << RADIO_PCNF1_STATLEN_Pos) |    // since the LENGHT field is not set, this specifies the lenght of the payload
-                          (4UL                          << RADIO_PCNF1_BALEN_Pos)   |
+    NRF_RADIO->PCNF1    = (PACKET_LENGTH                << RADIO_PCNF1_MAXLEN_Pos)  |    // only sending the beacon
+                          (PACKET_LENGTH                << RADIO_PCNF1_STATLEN_Pos) |    // since the LENGHT field is not set, this specifies the lenght of the payload
+                          (PACKET_BALEN                 << RADIO_PCNF1_BALEN_Pos)   |
                           (RADIO_PCNF1_ENDIAN_Little    << RADIO_PCNF1_ENDIAN_Pos)  | 
                           (RADIO_PCNF1_WHITEEN_Disabled << RADIO_PCNF1_WHITEEN_Pos);
 
@@ -128,16 +569,202 @@ void radio_setup() {
     NRF_RADIO->CRCINIT  = 0xFFFFUL;                                       // initial value
     NRF_RADIO->CRCPOLY  = 0x11021UL;                                      // CRC poly: x^16 + x^12^x^5 + 1
 
+#if DUTY_CYCLE_MODE
+    // shortcuts
+    // - END and DISABLE (Radio is enabled again by the next HFCLK start)
+    NRF_RADIO->SHORTS   = (RADIO_SHORTS_END_DISABLE_Enabled << RADIO_SHORTS_END_DISABLE_Pos);
+#endif
+
     // pointer to packet payload
-    NRF_RADIO->PACKETPTR = (uint32_t)&packet;
+    NRF_RADIO->PACKETPTR = (uint32_t)packet;
+}
+
+#if SCHEDULE_FREE_RUNNING
+
+/**
+ * @brief Function for initializing PPI in free-running mode.
+ * Connections to be made:
+ *     - Set pin high after offset time: EVENTS_COMPARE[0] from TIMER0 with TASKS_SET[GPIOTE_CH_PULSE] -> PPI channel 0
+ *     - Set pin low after pulse time: EVENTS_COMPARE[1] from TIMER0 with TASKS_CLR[GPIOTE_CH_PULSE] -> PPI channel 1
+ *     - Send another packet at the end of the period: EVENTS_COMPARE[2] from TIMER0 with TASKS_START from RADIO -> PPI channel 2
+ *     - Begin transmission: EVENTS_HFCLKSTARTED from CLOCK to TASKS_TXEN from RADIO -> PPI channel 3
+ *     - Begin transmission: EVENTS_READY from RADIO to TASKS_START from TIMER0 (only happens once, timer is never stopped) -> PPI channel 4
+ *     - Begin transmission: EVENTS_READY from RADIO to TASKS_START from RADIO -> PPI channel 4 FORK[4].TEP
+ */
+void ppi_setup() {
+
+    // get endpoint addresses
+    uint32_t gpiote_task_set_addr           = (uint32_t)&NRF_GPIOTE->TASKS_SET[GPIOTE_CH_PULSE];
+    uint32_t gpiote_task_clr_addr           = (uint32_t)&NRF_GPIOTE->TASKS_CLR[GPIOTE_CH_PULSE];
+    uint32_t timer0_task_start_addr         = (uint32_t)&NRF_TIMER0->TASKS_START;
+    uint32_t radio_tasks_txen_addr          = (uint32_t)&NRF_RADIO->TASKS_TXEN;
+    uint32_t radio_tasks_start_addr         = (uint32_t)&NRF_RADIO->TASKS_START;
+    uint32_t timer0_events_compare_0_addr   = (uint32_t)&NRF_TIMER0->EVENTS_COMPARE[0];
+    uint32_t timer0_events_compare_1_addr   = (uint32_t)&NRF_TIMER0->EVENTS_COMPARE[1];
+    uint32_t timer0_events_compare_2_addr   = (uint32_t)&NRF_TIMER0->EVENTS_COMPARE[2];
+    uint32_t clock_events_hfclkstart_addr   = (uint32_t)&NRF_CLOCK->EVENTS_HFCLKSTARTED;
+    uint32_t radio_events_ready_addr        = (uint32_t)&NRF_RADIO->EVENTS_READY;
+
+    // set endpoints
+    NRF_PPI->CH[0].EEP       = timer0_events_compare_0_addr;
+    NRF_PPI->CH[0].TEP       = gpiote_task_set_addr;
+
+    NRF_PPI->CH[1].EEP       = timer0_events_compare_1_addr;
+    NRF_PPI->CH[1].TEP       = gpiote_task_clr_addr;
+
+    NRF_PPI->CH[2].EEP       = timer0_events_compare_2_addr;
+    NRF_PPI->CH[2].TEP       = radio_tasks_start_addr;
+
+    NRF_PPI->CH[3].EEP       = clock_events_hfclkstart_addr;
+    NRF_PPI->CH[3].TEP       = radio_tasks_txen_addr;
+
+    NRF_PPI->CH[4].EEP       = radio_events_ready_addr;
+    NRF_PPI->CH[4].TEP       = timer0_task_start_addr;
+    NRF_PPI->FORK[4].TEP     = radio_tasks_start_addr;
+
+    // enable channels
+    NRF_PPI->CHENSET = (PPI_CHENSET_CH0_Enabled << PPI_CHENSET_CH0_Pos) | 
+                       (PPI_CHENSET_CH1_Enabled << PPI_CHENSET_CH1_Pos) |
+                       (PPI_CHENSET_CH2_Enabled << PPI_CHENSET_CH2_Pos) |
+                       (PPI_CHENSET_CH3_Enabled << PPI_CHENSET_CH3_Pos) |
+                       (PPI_CHENSET_CH4_Enabled << PPI_CHENSET_CH4_Pos);
+}
+
+#elif DUTY_CYCLE_MODE
+
+/**
+ * @brief Function for initializing PPI in duty-cycled mode.
+ * Connections to be made:
+ *     - Set pin high after offset time: EVENTS_COMPARE[0] from TIMER1 with TASKS_SET[GPIOTE_CH_PULSE] -> PPI channel 0
+ *     - Start Timer 0 that manages pulse duration: EVENTS_COMPARE[0] from TIMER1 with TASKS_START from TIMER0 -> PPI channel 0 FORK[0].TEP
+ *     - Set pin low after pulse time: EVENTS_COMPARE[1] from TIMER0 with TASKS_CLR[GPIOTE_CH_PULSE] -> PPI channel 1
+ *     - Stop HFCLK after the pulse: EVENTS_COMPARE[1] from TIMER0 with TASKS_HFCLKSTOP from CLOCK -> PPI channel 1 FORK[1].TEP
+ *     - Wake up: EVENTS_COMPARE[0] from RTC2 with TASKS_HFCLKSTART from CLOCK -> PPI channel 2
+ *     - Enable the radio: EVENTS_HFCLKSTARTED from CLOCK to TASKS_TXEN from RADIO -> PPI channel 3
+ *     - Start Timer 1 that manages the remainder and the offset: EVENTS_COMPARE[1] from RTC2 with TASKS_START from TIMER1 -> PPI channel 4
+ *     - Send the packet after the remainder: EVENTS_COMPARE[3] from TIMER1 with TASKS_START from RADIO -> PPI channel 8
+ * The radio waits in TXIDLE between READY and the start, so the HFXO startup time does not move the pulse.
+ */
+void ppi_setup() {
+
+    // get endpoint addresses
+    uint32_t gpiote_task_set_addr           = (uint32_t)&NRF_GPIOTE->TASKS_SET[GPIOTE_CH_PULSE];
+    uint32_t gpiote_task_clr_addr           = (uint32_t)&NRF_GPIOTE->TASKS_CLR[GPIOTE_CH_PULSE];
+    uint32_t timer0_task_start_addr         = (uint32_t)&NRF_TIMER0->TASKS_START;
+    uint32_t timer1_task_start_addr         = (uint32_t)&NRF_TIMER1->TASKS_START;
+    uint32_t clock_tasks_hfclkstart_addr    = (uint32_t)&NRF_CLOCK->TASKS_HFCLKSTART;
+    uint32_t clock_tasks_hfclkstop_addr     = (uint32_t)&NRF_CLOCK->TASKS_HFCLKSTOP;
+    uint32_t radio_tasks_txen_addr          = (uint32_t)&NRF_RADIO->TASKS_TXEN;
+    uint32_t radio_tasks_start_addr         = (uint32_t)&NRF_RADIO->TASKS_START;
+    uint32_t timer1_events_compare_0_addr   = (uint32_t)&NRF_TIMER1->EVENTS_COMPARE[0];
+    uint32_t timer0_events_compare_1_addr   = (uint32_t)&NRF_TIMER0->EVENTS_COMPARE[1];
+    uint32_t rtc2_events_compare_0_addr     = (uint32_t)&NRF_RTC2->EVENTS_COMPARE[0];
+    uint32_t rtc2_events_compare_1_addr     = (uint32_t)&NRF_RTC2->EVENTS_COMPARE[1];
+    uint32_t timer1_events_compare_3_addr   = (uint32_t)&NRF_TIMER1->EVENTS_COMPARE[3];
+    uint32_t clock_events_hfclkstart_addr   = (uint32_t)&NRF_CLOCK->EVENTS_HFCLKSTARTED;
+
+    // set endpoints
+    NRF_PPI->CH[0].EEP       = timer1_events_compare_0_addr;
+    NRF_PPI->CH[0].TEP       = gpiote_task_set_addr;
+    NRF_PPI->FORK[0].TEP     = timer0_task_start_addr;
+
+    NRF_PPI->CH[1].EEP       = timer0_events_compare_1_addr;
+    NRF_PPI->CH[1].TEP       = gpiote_task_clr_addr;
+    NRF_PPI->FORK[1].TEP     = clock_tasks_hfclkstop_addr;
+
+    NRF_PPI->CH[2].EEP       = rtc2_events_compare_0_addr;
+    NRF_PPI->CH[2].TEP       = clock_tasks_hfclkstart_addr;
+
+    NRF_PPI->CH[3].EEP       = clock_events_hfclkstart_addr;
+    NRF_PPI->CH[3].TEP       = radio_tasks_txen_addr;
+
+    NRF_PPI->CH[4].EEP       = rtc2_events_compare_1_addr;
+    NRF_PPI->CH[4].TEP       = timer1_task_start_addr;
+
+    NRF_PPI->CH[8].EEP       = timer1_events_compare_3_addr;
+    NRF_PPI->CH[8].TEP       = radio_tasks_start_addr;
+
+    // enable channels
+    NRF_PPI->CHENSET = (PPI_CHENSET_CH0_Enabled << PPI_CHENSET_CH0_Pos) |
+                       (PPI_CHENSET_CH1_Enabled << PPI_CHENSET_CH1_Pos) |
+                       (PPI_CHENSET_CH2_Enabled << PPI_CHENSET_CH2_Pos) |
+                       (PPI_CHENSET_CH3_Enabled << PPI_CHENSET_CH3_Pos) |
+                       (PPI_CHENSET_CH4_Enabled << PPI_CHENSET_CH4_Pos) |
+                       (PPI_CHENSET_CH8_Enabled << PPI_CHENSET_CH8_Pos);
+}
+
+/**
+ * @brief Function for initializing RTC2, which keeps the period while HFCLK is stopped.
+ * LFCLK runs from the 32.768 kHz crystal, the prescaler is chosen for the period (see sync_rtc.h).
+ * CC[0] wakes HFCLK at least DUTY_CYCLE_WAKE_LEAD before CC[1], which starts TIMER1. The COMPARE[0]
+ * interrupt loads TIMER1 (stopped since the previous period) with the fine remainder of this period,
+ * the COMPARE[1] interrupt moves both compares to the next period. The 24-bit counter is never cleared.
+ */
+void rtc_setup() {
+
+    if (!sync_rtc_init(&rtc, DUTY_CYCLE_PERIOD_US, MS_TO_US(DUTY_CYCLE_WAKE_LEAD))) {
+        // period too long for the RTC or shorter than the wake lead, nothing sensible to generate
+        while (true) {
+            __WFE();
+        }
+    }
+
+    sync_rtc_next(&rtc, &rtc_slot);
+
+    NRF_CLOCK->LFCLKSRC            = (CLOCK_LFCLKSRC_SRC_Xtal << CLOCK_LFCLKSRC_SRC_Pos);
+    NRF_CLOCK->EVENTS_LFCLKSTARTED = 0;
+    NRF_CLOCK->TASKS_LFCLKSTART    = CLOCK_TASKS_LFCLKSTART_TASKS_LFCLKSTART_Trigger;
+    while (!NRF_CLOCK->EVENTS_LFCLKSTARTED) {
+    }
+
+    NRF_RTC2->PRESCALER = rtc.prescaler;
+    NRF_RTC2->CC[0]     = rtc_slot.wake;
+    NRF_RTC2->CC[1]     = rtc_slot.fire;
+
+    NRF_RTC2->EVTENSET  = (RTC_EVTENSET_COMPARE0_Enabled << RTC_EVTENSET_COMPARE0_Pos) |
+                          (RTC_EVTENSET_COMPARE1_Enabled << RTC_EVTENSET_COMPARE1_Pos);
+
+    NRF_RTC2->EVENTS_COMPARE[0] = 0;
+    NRF_RTC2->EVENTS_COMPARE[1] = 0;
+    NRF_RTC2->INTENSET  = (RTC_INTENSET_COMPARE0_Enabled << RTC_INTENSET_COMPARE0_Pos) |
+                          (RTC_INTENSET_COMPARE1_Enabled << RTC_INTENSET_COMPARE1_Pos);
+    NVIC_EnableIRQ(RTC2_IRQn);
+
+    NRF_RTC2->TASKS_START = RTC_TASKS_START_TASKS_START_Trigger;
+}
+
+/**
+ * @brief Function for handling the RTC2 interrupt.
+ * COMPARE[0]: HFCLK is starting, load TIMER1 with the remainder and the offset of this period. The
+ * radio starts one tick after the remainder since a compare on 0 would not match right after the start.
+ * COMPARE[1]: TIMER1 was just started, program the next period.
+ */
+void RTC2_IRQHandler(void) {
+
+    if (NRF_RTC2->EVENTS_COMPARE[0]) {
+        NRF_RTC2->EVENTS_COMPARE[0] = 0;
+
+        NRF_TIMER1->CC[3] = 1 + SYNC_US_TO_TICKS(rtc_slot.remainder_us, TIMER_PRESCALER);
+        NRF_TIMER1->CC[0] = NRF_TIMER1->CC[3] + MS_TO_TICKS(TIMER_OFFSET);
+    }
+
+    if (NRF_RTC2->EVENTS_COMPARE[1]) {
+        NRF_RTC2->EVENTS_COMPARE[1] = 0;
+
+        sync_rtc_next(&rtc, &rtc_slot);
+        NRF_RTC2->CC[0] = rtc_slot.wake;
+        NRF_RTC2->CC[1] = rtc_slot.fire;
+    }
 }
 
+#else
+
 /**
  * @brief Function for initializing PPI. 
  * Connections to be made:
- *     - Toggle pin high after offset time: EVENTS_COMPARE[0] from TIMER1 with TASKS_OUT[GPIOTE_CH_PULSE] (will set pin high) -> PPI channel 0
+ *     - Set pin high after offset time: EVENTS_COMPARE[0] from TIMER1 with TASKS_SET[GPIOTE_CH_PULSE] -> PPI channel 0
  *     - Start Timer 0 that manages pulse duration: EVENTS_COMPARE[0] from TIMER1 with TASKS_START from TIMER0 -> PPI channel 0 FORK[0].TEP (same event triggers 2 tasks)
- *     - Toggle pin low after pulse time: EVENTS_COMPARE[1] with TASKS_OUT[GPIOTE_CH_PULSE] (will set pin low) -> PPI channel 1
+ *     - Set pin low after pulse time: EVENTS_COMPARE[1] with TASKS_CLR[GPIOTE_CH_PULSE] -> PPI channel 1
  *     - Start Timer 1 that manages the offset after Timer 0 ends: EVENTS_COMPARE[2] from TIMER0 with TASKS_START from TIMER1 -> PPI channel 2
  *     - Send another packet after Timer 0 ends: EVENTS_COMPARE[2] with TASKS_START from RADIO -> PPI channel 2 FORK[2].TEP (at the same time that the offset timer starts)
  *          *the offset will include the time difference between the Radio starting and when the packet is actually sent
@@ -148,7 +775,8 @@ void radio_setup() {
 void ppi_setup() {
     
     // get endpoint addresses
-    uint32_t gpiote_task_addr               = (uint32_t)&NRF_GPIOTE->TASKS_OUT[GPIOTE_CH_PULSE];
+    uint32_t gpiote_task_set_addr           = (uint32_t)&NRF_GPIOTE->TASKS_SET[GPIOTE_CH_PULSE];
+    uint32_t gpiote_task_clr_addr           = (uint32_t)&NRF_GPIOTE->TASKS_CLR[GPIOTE_CH_PULSE];
     uint32_t timer0_task_start_addr         = (uint32_t)&NRF_TIMER0->TASKS_START;
     uint32_t timer1_task_start_addr         = (uint32_t)&NRF_TIMER1->TASKS_START;
     uint32_t radio_tasks_txen_addr          = (uint32_t)&NRF_RADIO->TASKS_TXEN;
@@ -161,11 +789,11 @@ void ppi_setup() {
 
     // set endpoints
     NRF_PPI->CH[0].EEP       = timer1_events_compare_0_addr;
-    NRF_PPI->CH[0].TEP       = gpiote_task_addr;
+    NRF_PPI->CH[0].TEP       = gpiote_task_set_addr;
     NRF_PPI->FORK[0].TEP     = timer0_task_start_addr;
 
     NRF_PPI->CH[1].EEP       = timer0_events_compare_1_addr;
-    NRF_PPI->CH[1].TEP       = gpiote_task_addr;
+    NRF_PPI->CH[1].TEP       = gpiote_task_clr_addr;
 
     NRF_PPI->CH[2].EEP       = timer0_events_compare_2_addr;
     NRF_PPI->CH[2].TEP       = timer1_task_start_addr;
@@ -186,24 +814,1137 @@ void ppi_setup() {
                        (PPI_CHENSET_CH4_Enabled << PPI_CHENSET_CH4_Pos);
 }
 
+#endif // SCHEDULE_FREE_RUNNING
+
+#if OUTPUTS_MODE
+
+/**
+ * @brief Function for initializing the extra outputs.
+ * Every output gets a GPIOTE channel and two compares on TIMER3, then TIMER4 (see sync_outputs.h).
+ * The output timers are started by the compare that sets the pulse pin, so the delays are counted
+ * from the rising edge with no latency.
+ * Connections to be made:
+ *     - Start the output timers: EVENTS_COMPARE[0] from TIMER1 (TIMER0 when free-running) with TASKS_START from TIMER3 -> PPI channel OUTPUT_PPI_FIRST
+ *     - Start the output timers: same event with TASKS_START from TIMER4 -> PPI channel OUTPUT_PPI_FIRST FORK.TEP
+ *     - Set output i high: EVENTS_COMPARE[rise] from its timer with TASKS_SET[OUTPUT_GPIOTE_FIRST + i] -> PPI channel OUTPUT_PPI_FIRST + 1 + 2 * i
+ *     - Set output i low: EVENTS_COMPARE[fall] from its timer with TASKS_CLR[OUTPUT_GPIOTE_FIRST + i] -> PPI channel OUTPUT_PPI_FIRST + 2 + 2 * i
+ */
+void outputs_setup() {
+    NRF_TIMER_Type      *timers[] = { NRF_TIMER3, NRF_TIMER4 };
+    sync_outputs_plan_t  plan;
+    uint32_t             chen     = (1UL << OUTPUT_PPI_FIRST);
+
+    if (!sync_outputs_plan(outputs, OUTPUT_COUNT, TIMER3_CC_NUM, 0, MS_TO_TICKS(PULSE_PERIOD), &plan)) {
+        NRF_LOG_ERROR("outputs: OUTPUT_TABLE does not fit in the period, outputs disabled");
+        return;
+    }
+    outputs_enabled = true;
+
+    for (uint8_t t = 0; t < plan.timers; t++) {
+        timers[t]->BITMODE   = TIMER_BITMODE_BITMODE_32Bit;
+        timers[t]->PRESCALER = TIMER_PRESCALER;
+
+        // the latest falling edge clears and stops the timer until the next pulse
+        timers[t]->SHORTS    = (TIMER_SHORTS_COMPARE0_CLEAR_Enabled << (TIMER_SHORTS_COMPARE0_CLEAR_Pos + plan.stop_cc[t])) |
+                               (TIMER_SHORTS_COMPARE0_STOP_Enabled  << (TIMER_SHORTS_COMPARE0_STOP_Pos  + plan.stop_cc[t]));
+    }
+
+    for (uint8_t i = 0; i < plan.count; i++) {
+        const sync_output_cc_t *cc      = &plan.outputs[i];
+        NRF_TIMER_Type         *timer   = timers[cc->timer];
+        uint32_t                gpiote  = OUTPUT_GPIOTE_FIRST + i;
+        uint32_t                ppi     = OUTPUT_PPI_FIRST + 1 + 2 * i;
+
+        NRF_GPIOTE->CONFIG[gpiote] = (GPIOTE_CONFIG_MODE_Task       << GPIOTE_CONFIG_MODE_Pos)     |
+                                     (outputs[i].pin                << GPIOTE_CONFIG_PSEL_Pos)     |
+                                     (outputs[i].port               << GPIOTE_CONFIG_PORT_Pos)     |
+                                     (GPIOTE_CONFIG_POLARITY_None   << GPIOTE_CONFIG_POLARITY_Pos) |
+                                     (GPIOTE_CONFIG_OUTINIT_Low     << GPIOTE_CONFIG_OUTINIT_Pos);
+
+        timer->CC[cc->cc_rise]   = cc->rise;
+        timer->CC[cc->cc_fall]   = cc->fall;
+
+        NRF_PPI->CH[ppi].EEP     = (uint32_t)&timer->EVENTS_COMPARE[cc->cc_rise];
+        NRF_PPI->CH[ppi].TEP     = (uint32_t)&NRF_GPIOTE->TASKS_SET[gpiote];
+
+        NRF_PPI->CH[ppi + 1].EEP = (uint32_t)&timer->EVENTS_COMPARE[cc->cc_fall];
+        NRF_PPI->CH[ppi + 1].TEP = (uint32_t)&NRF_GPIOTE->TASKS_CLR[gpiote];
+
+        chen |= (1UL << ppi) | (1UL << (ppi + 1));
+    }
+
+#if SCHEDULE_FREE_RUNNING
+    NRF_PPI->CH[OUTPUT_PPI_FIRST].EEP      = (uint32_t)&NRF_TIMER0->EVENTS_COMPARE[0];
+#else
+    NRF_PPI->CH[OUTPUT_PPI_FIRST].EEP      = (uint32_t)&NRF_TIMER1->EVENTS_COMPARE[0];
+#endif
+    NRF_PPI->CH[OUTPUT_PPI_FIRST].TEP      = (uint32_t)&NRF_TIMER3->TASKS_START;
+    if (plan.timers > 1) {
+        NRF_PPI->FORK[OUTPUT_PPI_FIRST].TEP = (uint32_t)&NRF_TIMER4->TASKS_START;
+    }
+
+    NRF_PPI->CHENSET = chen;
+}
+
+#endif // OUTPUTS_MODE
+
+#if PWM_SEQUENCE_MODE
+
+/**
+ * @brief Function for initializing the PWM sequence.
+ * PWM_PATTERN is compiled into pwm_sequence once (see sync_pwm.h), then every rising edge of the pulse
+ * starts PWM0, which plays it through EasyDMA and stops at the end of the sequence. While PWM0 is
+ * stopped its pin is driven low by the GPIO configuration. The SEQSTART to first period latency is the
+ * same on both boards.
+ * Connections to be made:
+ *     - Play the pattern: EVENTS_COMPARE[0] from TIMER1 (TIMER0 when free-running) with TASKS_SEQSTART[0] from PWM0 -> PPI channel PWM_PPI_CH
+ */
+void pwm_setup() {
+    NRF_GPIO_Type *port       = (PWM_PIN_PORT == 1) ? NRF_P1 : NRF_P0;
+    uint16_t       countertop = PWM_MS_TO_TICKS(PWM_SLOT);
+    uint16_t       length;
+
+    length = sync_pwm_compile(pwm_pattern, PWM_SEGMENTS, countertop, pwm_sequence, PWM_SEQUENCE_MAX);
+    if (length == 0 || (uint64_t)length * countertop >= (uint64_t)PULSE_PERIOD * SYNC_TICKS_PER_MS(PWM_PRESCALER)) {
+        NRF_LOG_ERROR("pwm: PWM_PATTERN does not fit in PWM_SEQUENCE_MAX slots or in the period, sequence disabled");
+        return;
+    }
+    pwm_length = length;
+
+    port->OUTCLR                  = (1UL << PWM_PIN_NUMBER);
+    port->PIN_CNF[PWM_PIN_NUMBER] = (GPIO_PIN_CNF_DIR_Output << GPIO_PIN_CNF_DIR_Pos);
+
+    NRF_PWM0->PSEL.OUT[0]     = (PWM_PIN_NUMBER                 << PWM_PSEL_OUT_PIN_Pos)  |
+                                (PWM_PIN_PORT                   << PWM_PSEL_OUT_PORT_Pos) |
+                                (PWM_PSEL_OUT_CONNECT_Connected << PWM_PSEL_OUT_CONNECT_Pos);
+    NRF_PWM0->MODE            = (PWM_MODE_UPDOWN_Up << PWM_MODE_UPDOWN_Pos);
+    NRF_PWM0->PRESCALER       = (PWM_PRESCALER      << PWM_PRESCALER_PRESCALER_Pos);
+    NRF_PWM0->COUNTERTOP      = (countertop         << PWM_COUNTERTOP_COUNTERTOP_Pos);
+    NRF_PWM0->LOOP            = (PWM_LOOP_CNT_Disabled << PWM_LOOP_CNT_Pos);
+    NRF_PWM0->DECODER         = (PWM_DECODER_LOAD_Common       << PWM_DECODER_LOAD_Pos) |   // one value per period
+                                (PWM_DECODER_MODE_RefreshCount << PWM_DECODER_MODE_Pos);
+    NRF_PWM0->SEQ[0].PTR      = (uint32_t)pwm_sequence;
+    NRF_PWM0->SEQ[0].CNT      = length;
+    NRF_PWM0->SEQ[0].REFRESH  = 0;      // every value lasts one period
+    NRF_PWM0->SEQ[0].ENDDELAY = 0;
+
+    // the output goes back to the GPIO level at the end of the sequence
+    NRF_PWM0->SHORTS          = (PWM_SHORTS_SEQEND0_STOP_Enabled << PWM_SHORTS_SEQEND0_STOP_Pos);
+    NRF_PWM0->ENABLE          = (PWM_ENABLE_ENABLE_Enabled << PWM_ENABLE_ENABLE_Pos);
+
+#if SCHEDULE_FREE_RUNNING
+    NRF_PPI->CH[PWM_PPI_CH].EEP    = (uint32_t)&NRF_TIMER0->EVENTS_COMPARE[0];
+#else
+    NRF_PPI->CH[PWM_PPI_CH].EEP    = (uint32_t)&NRF_TIMER1->EVENTS_COMPARE[0];
+#endif
+    NRF_PPI->CH[PWM_PPI_CH].TEP    = (uint32_t)&NRF_PWM0->TASKS_SEQSTART[0];
+
+    NRF_PPI->CHENSET = (1UL << PWM_PPI_CH);
+
+    NRF_LOG_INFO("pwm: %u slots of %u ticks", length, countertop);
+}
+
+#endif // PWM_SEQUENCE_MODE
+
+#if CALIBRATION_MODE
+
+/**
+ * @brief Function for initializing the offset calibration.
+ * TIMER1 is started together with the radio, so capturing it on the radio events gives
+ * their time from the radio start. CC[1] and CC[2] are free since TIMER1 only uses CC[0].
+ * Connections to be made:
+ *     - Timestamp the address: EVENTS_ADDRESS from RADIO with TASKS_CAPTURE[1] from TIMER1 -> PPI channel 5
+ *     - Timestamp the end of the packet: EVENTS_END from RADIO with TASKS_CAPTURE[2] from TIMER1 -> PPI channel 6
+ * The END interrupt (enabled by beacon_setup()) collects the captures until CALIB_SAMPLES are averaged.
+ */
+void calibration_setup() {
+
+    sync_calib_init(&calib);
+
+    NRF_PPI->CH[5].EEP       = (uint32_t)&NRF_RADIO->EVENTS_ADDRESS;
+    NRF_PPI->CH[5].TEP       = (uint32_t)&NRF_TIMER1->TASKS_CAPTURE[1];
+
+    NRF_PPI->CH[6].EEP       = (uint32_t)&NRF_RADIO->EVENTS_END;
+    NRF_PPI->CH[6].TEP       = (uint32_t)&NRF_TIMER1->TASKS_CAPTURE[2];
+
+    NRF_PPI->CHENSET = (PPI_CHENSET_CH5_Enabled << PPI_CHENSET_CH5_Pos) |
+                       (PPI_CHENSET_CH6_Enabled << PPI_CHENSET_CH6_Pos);
+}
+
+/**
+ * @brief Function for handling the RADIO END event while calibrating.
+ * Once enough samples are collected, captures are disabled and the offset is handed over
+ * to the TIMER1 interrupt, which writes it right after the next COMPARE[0] (TIMER1 stopped).
+ */
+static void calibration_radio_end() {
+
+    sync_calib_add_tx(&calib, NRF_TIMER1->CC[1], NRF_TIMER1->CC[2]);
+
+    // clear the captures so an event that is missed next period is rejected
+    NRF_TIMER1->CC[1] = 0;
+    NRF_TIMER1->CC[2] = 0;
+
+    if (sync_calib_offset(&calib, CALIB_SAMPLES, SYNC_MS_TO_TICKS_SIGNED(CALIB_RX_CHAIN_DELAY, TIMER_PRESCALER),
+                          SYNC_MS_TO_TICKS_SIGNED(CALIB_RX_TRIGGER_DELAY, TIMER_PRESCALER), &calib_offset)) {
+        NRF_PPI->CHENCLR    = (PPI_CHENCLR_CH5_Clear << PPI_CHENCLR_CH5_Pos) |
+                              (PPI_CHENCLR_CH6_Clear << PPI_CHENCLR_CH6_Pos);
+
+        NRF_TIMER1->EVENTS_COMPARE[0] = 0;
+        NRF_TIMER1->INTENSET          = (TIMER_INTENSET_COMPARE0_Enabled << TIMER_INTENSET_COMPARE0_Pos);
+        NVIC_EnableIRQ(TIMER1_IRQn);
+    }
+}
+
+/**
+ * @brief Function for handling the TIMER1 COMPARE[0] interrupt.
+ * TIMER1 has just been cleared and stopped by its shortcuts and will not start again
+ * until the next period, so CC[0] can be changed without missing a compare.
+ */
+void TIMER1_IRQHandler(void) {
+
+    if (NRF_TIMER1->EVENTS_COMPARE[0]) {
+        NRF_TIMER1->EVENTS_COMPARE[0] = 0;
+
+        NRF_TIMER1->CC[0]    = calib_offset;
+        NRF_TIMER1->INTENCLR = (TIMER_INTENCLR_COMPARE0_Clear << TIMER_INTENCLR_COMPARE0_Pos);
+
+        NRF_LOG_INFO("calibrated offset: %u ticks (%u samples, %u rejected)", calib_offset, calib.tx_samples, calib.rejected);
+    }
+}
+
+#endif // CALIBRATION_MODE
+
+/**
+ * @brief Function for initializing the beacon.
+ * TIMER2 runs freely and timestamps the address of every beacon. The payload read by EasyDMA
+ * is the one packed at the previous END, so the timestamp it carries is the one of the beacon before.
+ * With DUTY_CYCLE_MODE, a running TIMER2 would keep HFCLK requested after the HFCLKSTOP: it only runs
+ * from HFCLKSTARTED to the end of the beacon, and the timestamp comes from the RTC2 schedule instead.
+ * Connections to be made:
+ *     - Timestamp the address: EVENTS_ADDRESS from RADIO with TASKS_CAPTURE[0] from TIMER2 -> PPI channel 7
+ *     - Start TIMER2 with HFCLK (DUTY_CYCLE_MODE): EVENTS_HFCLKSTARTED from CLOCK with TASKS_START from TIMER2 -> PPI channel 3 FORK[3].TEP
+ */
+void beacon_setup() {
+
+    beacon.sequence  = 0;
+#if SCHEDULE_FREE_RUNNING
+    beacon.period_us = SYNC_BEACON_MS_TO_US(PULSE_PERIOD);
+#elif DUTY_CYCLE_MODE
+    beacon.period_us = (DUTY_CYCLE_PERIOD_US < SYNC_BEACON_PERIOD_LONG) ? (uint32_t)DUTY_CYCLE_PERIOD_US : SYNC_BEACON_PERIOD_LONG;
+#else
+    beacon.period_us = SYNC_BEACON_MS_TO_US(PULSE_PERIOD + TIMER_OFFSET);   // TIMER0 restarts after the TIMER1 offset
+#endif
+    beacon.width_us  = SYNC_BEACON_MS_TO_US(PULSE_DURATION);
+    beacon.timestamp = 0;
+    beacon.prescaler = TIMER_PRESCALER;
+    beacon.copy      = 0;
+    beacon.copies    = 1;                       // no burst, see burst_setup()
+    beacon.reply_time = 0;
+    beacon.reply_node = SYNC_BEACON_NO_REPLY;   // no two-way request, see twoway_radio_disabled()
+
+    // no change announced
+    beacon.next_period_us  = beacon.period_us;
+    beacon.next_width_us   = beacon.width_us;
+    beacon.switch_sequence = beacon.sequence;
+    beacon.channel_map     = 0;                 // fixed channel, see hop_setup()
+
+    sync_beacon_pack(packet, &beacon);
+
+    NRF_TIMER2->BITMODE   = TIMER_BITMODE_BITMODE_32Bit;
+    NRF_TIMER2->PRESCALER = TIMER_PRESCALER;
+
+    NRF_PPI->CH[7].EEP       = (uint32_t)&NRF_RADIO->EVENTS_ADDRESS;
+    NRF_PPI->CH[7].TEP       = (uint32_t)&NRF_TIMER2->TASKS_CAPTURE[0];
+
+    NRF_PPI->CHENSET = (PPI_CHENSET_CH7_Enabled << PPI_CHENSET_CH7_Pos);
+
+    NRF_RADIO->EVENTS_END = 0;
+    NRF_RADIO->INTENSET   = (RADIO_INTENSET_END_Enabled << RADIO_INTENSET_END_Pos);
+    NVIC_EnableIRQ(RADIO_IRQn);
+
+#if DUTY_CYCLE_MODE
+    NRF_PPI->FORK[3].TEP = (uint32_t)&NRF_TIMER2->TASKS_START;
+#else
+    NRF_TIMER2->TASKS_START = TIMER_TASKS_START_TASKS_START_Trigger;
+#endif
+}
+
+/**
+ * @brief Function for handling the RADIO END event: pack the next beacon.
+ * The next transmission starts one period later, so the buffer is not in use.
+ * With DUTY_CYCLE_MODE, TIMER2 is stopped until the next HFCLK start, and the timestamp is the start of
+ * the period that just ended on the RTC2 schedule (rtc_slot already holds the next one). It is the address
+ * time minus a constant, on the clock that keeps the period.
+ */
+static void beacon_radio_end() {
+
+    beacon.sequence++;
+#if DUTY_CYCLE_MODE
+    beacon.timestamp = SYNC_US_TO_TICKS((rtc.index - 1) * rtc.period_us, TIMER_PRESCALER);
+
+    NRF_TIMER2->TASKS_STOP  = TIMER_TASKS_STOP_TASKS_STOP_Trigger;
+    NRF_TIMER2->TASKS_CLEAR = TIMER_TASKS_CLEAR_TASKS_CLEAR_Trigger;
+#else
+    beacon.timestamp = NRF_TIMER2->CC[0];
+#endif
+
+    sync_beacon_pack(packet, &beacon);
+}
+
+#if HOP_MODE
+
+/**
+ * @brief Function for initializing the frequency hopping.
+ * END disables the radio after every beacon (in every schedule), its interrupt picks the channel of the
+ * next beacon and the DISABLED interrupt tunes the radio to it. Without DUTY_CYCLE_MODE it also enables
+ * it again at once, so the radio waits in TXIDLE for the start at the end of the period as before; the
+ * READY link that starts the first beacon is then disabled. With DUTY_CYCLE_MODE, the next HFCLK start
+ * enables it.
+ */
+void hop_setup() {
+
+    if (sync_hop_count(HOP_MAP) < SYNC_HOP_MIN_CHANNELS) {
+        NRF_LOG_ERROR("hop: HOP_MAP needs at least %u channels, hopping disabled", SYNC_HOP_MIN_CHANNELS);
+        return;
+    }
+
+#if SCAN_MODE
+    if (!sync_scan_init(&scan, HOP_CHANNELS)) {
+        NRF_LOG_ERROR("scan: HOP_TABLE is empty, hopping disabled");
+        return;
+    }
+#endif
+
+    // no change announced
+    hop_next_map            = HOP_MAP;
+    beacon.channel_map      = HOP_MAP;
+    beacon.next_channel_map = HOP_MAP;
+    beacon.channel_switch   = beacon.sequence;
+    sync_beacon_pack(packet, &beacon);
+
+    NRF_RADIO->FREQUENCY = hop_table[sync_hop_index(HOP_SEED, HOP_MAP, beacon.sequence)];
+    NRF_RADIO->SHORTS   |= (RADIO_SHORTS_END_DISABLE_Enabled << RADIO_SHORTS_END_DISABLE_Pos);
+}
+
+#if SCAN_MODE
+
+/**
+ * @brief Function for sampling the noise floor of the next channel of the scan, the radio being disabled.
+ * The radio is enabled in RX on the channel, and the READY to START shortcut starts it. Nothing waits in
+ * the interrupt: RSSI is sampled at READY, the radio is disabled at RSSIEND, and tuned to next at DISABLED
+ * (see scan_radio_event()). A packet received meanwhile must not be timestamped nor taken for the end of a
+ * beacon, so the ADDRESS and END links and the END interrupt are off until then.
+ */
+static void scan_sample(uint8_t next) {
+
+    scan_round  = sync_scan_next(&scan, &scan_index);
+    scan_next   = next;
+    scan_chen   = NRF_PPI->CHEN & (PPI_CHEN_CH5_Msk | PPI_CHEN_CH6_Msk | PPI_CHEN_CH7_Msk);
+    scan_shorts = NRF_RADIO->SHORTS;
+
+    NRF_PPI->CHENCLR    = scan_chen;
+    NRF_RADIO->INTENCLR = (RADIO_INTENCLR_END_Clear << RADIO_INTENCLR_END_Pos);
+
+    NRF_RADIO->FREQUENCY       = hop_table[scan_index];
+    NRF_RADIO->SHORTS          = (RADIO_SHORTS_READY_START_Enabled << RADIO_SHORTS_READY_START_Pos);
+    NRF_RADIO->EVENTS_READY    = 0;
+    NRF_RADIO->EVENTS_RSSIEND  = 0;
+    NRF_RADIO->EVENTS_DISABLED = 0;
+    NRF_RADIO->INTENSET        = (RADIO_INTENSET_READY_Enabled    << RADIO_INTENSET_READY_Pos)   |
+                                 (RADIO_INTENSET_RSSIEND_Enabled  << RADIO_INTENSET_RSSIEND_Pos) |
+                                 (RADIO_INTENSET_DISABLED_Enabled << RADIO_INTENSET_DISABLED_Pos);
+    scan_sampling              = true;
+    NRF_RADIO->TASKS_RXEN      = 1;
+}
+
+/**
+ * @brief Function for handling the RADIO events of a sample.
+ * READY: start the RSSI sample. RSSIEND: keep the sample and disable the radio. DISABLED: set the radio
+ * back for the beacons on the channel of the next one. After a round of HOP_TABLE, the best channels are
+ * announced if they beat the map in use.
+ */
+static void scan_radio_event() {
+    uint32_t map;
+
+    if (NRF_RADIO->EVENTS_READY) {
+        NRF_RADIO->EVENTS_READY    = 0;
+        NRF_RADIO->TASKS_RSSISTART = 1;
+    }
+
+    if (NRF_RADIO->EVENTS_RSSIEND) {
+        NRF_RADIO->EVENTS_RSSIEND = 0;
+        sync_scan_add(&scan, scan_index, (uint8_t)NRF_RADIO->RSSISAMPLE);
+        NRF_RADIO->TASKS_DISABLE  = 1;
+    }
+
+    if (!NRF_RADIO->EVENTS_DISABLED) {
+        return;
+    }
+    NRF_RADIO->EVENTS_DISABLED = 0;
+    NRF_RADIO->INTENCLR        = (RADIO_INTENCLR_READY_Clear    << RADIO_INTENCLR_READY_Pos)   |
+                                 (RADIO_INTENCLR_RSSIEND_Clear  << RADIO_INTENCLR_RSSIEND_Pos) |
+                                 (RADIO_INTENCLR_DISABLED_Clear << RADIO_INTENCLR_DISABLED_Pos);
+    scan_sampling              = false;
+
+    NRF_RADIO->SHORTS     = scan_shorts;
+    NRF_RADIO->EVENTS_END = 0;
+    NRF_RADIO->INTENSET   = (RADIO_INTENSET_END_Enabled << RADIO_INTENSET_END_Pos);
+    NRF_PPI->CHENSET      = scan_chen;
+
+    NRF_RADIO->FREQUENCY = hop_table[scan_next];
+#if !DUTY_CYCLE_MODE
+    NRF_RADIO->TASKS_TXEN = 1;
+#endif
+
+    if (!scan_round) {
+        return;
+    }
+    map = sync_scan_best(&scan, SCAN_CHANNELS, hop_next_map, SCAN_HYSTERESIS);
+    if (map != hop_next_map) {
+        NRF_LOG_INFO("scan: channel %u scores %d/16 dB, moving to map 0x%08x", sync_hop_first(map),
+                     sync_scan_score(&scan, sync_hop_first(map)), map);
+        hop_next_map = map;
+    }
+}
+
+#endif // SCAN_MODE
+
+/**
+ * @brief Function for tuning the radio to the channel of the next beacon, the radio being disabled.
+ * Without DUTY_CYCLE_MODE it is enabled again at once, to wait in TXIDLE. With SCAN_MODE, a channel
+ * may be sampled first, and the radio is tuned at the end of the sample instead.
+ */
+static void hop_radio_disabled() {
+
+    NRF_RADIO->INTENCLR        = (RADIO_INTENCLR_DISABLED_Clear << RADIO_INTENCLR_DISABLED_Pos);
+    NRF_RADIO->EVENTS_DISABLED = 0;
+
+#if SCAN_MODE
+    if (hop_sample) {
+        scan_sample(hop_next);
+        return;
+    }
+#endif
+
+    NRF_RADIO->FREQUENCY = hop_table[hop_next];
+
+#if !DUTY_CYCLE_MODE
+    NRF_RADIO->TASKS_TXEN = 1;
+#endif
+}
+
+/**
+ * @brief Function for handling the RADIO END event: pick the channel of the next beacon.
+ * Called before beacon_radio_end(), so the maps of the beacon that just ended give the channel of the
+ * next beacon. A new map is announced in the next beacon, to be used HOP_SWITCH_LEAD beacons later,
+ * once the previous change is done. With SCAN_MODE, a channel is sampled every SCAN_BEACONS beacons.
+ * Nothing waits for the ramp-down: the radio is tuned from the DISABLED interrupt (hop_radio_disabled()).
+ */
+static void hop_radio_end() {
+    uint32_t sequence = beacon.sequence + 1;
+
+    if (beacon.channel_map == 0) {
+        return;
+    }
+
+    uint8_t index = sync_hop_index(HOP_SEED, sync_beacon_channel_map(&beacon, sequence), sequence);
+
+    if (sequence == beacon.channel_switch) {
+        beacon.channel_map = beacon.next_channel_map;
+    }
+    if (hop_next_map != beacon.channel_map && (int32_t)(beacon.channel_switch - sequence) <= 0) {
+        beacon.next_channel_map = hop_next_map;
+        beacon.channel_switch   = sequence + HOP_SWITCH_LEAD;
+    }
+
+#if !DUTY_CYCLE_MODE
+    NRF_PPI->CHENCLR = (PPI_CHENCLR_CH4_Clear << PPI_CHENCLR_CH4_Pos);
+#endif
+
+    hop_next   = index;
+#if SCAN_MODE
+    hop_sample = (sequence % SCAN_BEACONS == 0);
+#else
+    hop_sample = false;
+#endif
+
+    // with TWO_WAY_MODE the listen already disabled the radio
+    if (NRF_RADIO->STATE == RADIO_STATE_STATE_Disabled) {
+        hop_radio_disabled();
+        return;
+    }
+
+    // the END to DISABLE shortcut has just been triggered, the DISABLED interrupt tunes the radio. If the
+    // radio got there before the event was cleared, the interrupt is pended by hand
+    NRF_RADIO->EVENTS_DISABLED = 0;
+    NRF_RADIO->INTENSET        = (RADIO_INTENSET_DISABLED_Enabled << RADIO_INTENSET_DISABLED_Pos);
+    if (NRF_RADIO->STATE == RADIO_STATE_STATE_Disabled) {
+        NVIC_SetPendingIRQ(RADIO_IRQn);
+    }
+}
+
+#endif // HOP_MODE
+
+#if BURST_MODE
+
+/**
+ * @brief Function for initializing the beacon bursts.
+ * The address of every copy is captured on TIMER2 CC[0] (see beacon_setup()). The END interrupt of
+ * every copy but the last sets CC[1] BURST_SPACING after it, which starts the next copy from TXIDLE:
+ * the copies are exactly BURST_SPACING apart whatever the interrupt latency, as long as it is shorter
+ * than the gap between two frames. The END to DISABLE shortcut (DUTY_CYCLE_MODE, HOP_MODE) is only
+ * set for the last copy. The copy link is disabled between bursts, CC[1] passes by once per TIMER2 wrap.
+ * Connections to be made:
+ *     - Send the next copy: EVENTS_COMPARE[1] from TIMER2 with TASKS_START from RADIO -> PPI channel BURST_PPI_CH
+ */
+void burst_setup() {
+
+    burst_copy         = 0;
+    burst_disable      = NRF_RADIO->SHORTS & RADIO_SHORTS_END_DISABLE_Msk;
+    NRF_RADIO->SHORTS &= ~burst_disable;
+
+    beacon.copies = BURST_COPIES;
+    sync_beacon_pack(packet, &beacon);
+
+    NRF_PPI->CH[BURST_PPI_CH].EEP = (uint32_t)&NRF_TIMER2->EVENTS_COMPARE[1];
+    NRF_PPI->CH[BURST_PPI_CH].TEP = (uint32_t)&NRF_RADIO->TASKS_START;
+}
+
+/**
+ * @brief Function for handling the RADIO END event of a copy: arm the next one, or end the burst.
+ * The next copy is the current beacon with its copy index, so a beacon repacked meanwhile (COMMAND_MODE)
+ * goes out the same in every copy. If the interrupt came too late for the next copy, the burst ends
+ * there. After the last copy, TIMER2 CC[0] is moved back to the address of the first one, so the
+ * timestamp is the same whichever copy a receiver got.
+ * Returns true at the end of the burst.
+ */
+static bool burst_radio_end() {
+
+    if (burst_copy + 1 < BURST_COPIES) {
+        burst_copy++;
+        sync_beacon_copy(burst_packet, packet, burst_copy);
+        NRF_RADIO->PACKETPTR = (uint32_t)burst_packet;
+        if (burst_copy + 1 == BURST_COPIES) {
+            NRF_RADIO->SHORTS |= burst_disable;
+        }
+
+        NRF_TIMER2->CC[1]            = NRF_TIMER2->CC[0] + SYNC_US_TO_TICKS(BURST_SPACING, TIMER_PRESCALER);
+        NRF_TIMER2->TASKS_CAPTURE[2] = 1;
+        if ((int32_t)(NRF_TIMER2->CC[1] - NRF_TIMER2->CC[2]) > (int32_t)SYNC_US_TO_TICKS(1, TIMER_PRESCALER)) {
+            NRF_PPI->CHENSET = (1UL << BURST_PPI_CH);
+            return false;
+        }
+
+        // this copy is not sent, the last one sent ended in TXIDLE
+        NRF_LOG_WARNING("burst: END interrupt too late for copy %u", burst_copy);
+        burst_copy--;
+        if (burst_disable) {
+            NRF_RADIO->TASKS_DISABLE = 1;
+        }
+    }
+
+    NRF_PPI->CHENCLR      = (1UL << BURST_PPI_CH);
+    NRF_RADIO->SHORTS    &= ~burst_disable;
+    NRF_RADIO->PACKETPTR  = (uint32_t)packet;
+    NRF_TIMER2->CC[0]    -= burst_copy * SYNC_US_TO_TICKS(BURST_SPACING, TIMER_PRESCALER);
+    burst_copy            = 0;
+
+    return true;
+}
+
+/**
+ * @brief Function for logging the modelled trade-off of the burst lengths (see sync_burst.h).
+ */
+void burst_report() {
+    sync_burst_channel_t channel;
+    sync_burst_report_t  report;
+    uint32_t             frame = MS_TO_US(SYNC_PHY_FRAME_TIME_MS(RADIO_PHY, PACKET_BALEN + 1, PACKET_LENGTH, PACKET_CRC_LENGTH));
+
+    sync_burst_default_channel(&channel);
+
+    for (uint32_t copies = 1; copies <= BURST_COPIES; copies++) {
+        sync_burst_evaluate(&channel, copies, BURST_SPACING, BURST_MARGIN, frame, &report);
+        NRF_LOG_INFO("burst model: %u copies, delay %u us, airtime %u us, loss %u ppb", report.copies, report.delay,
+                     report.airtime, report.loss);
+    }
+}
+
+#endif // BURST_MODE
+
+#if TWO_WAY_MODE
+
+/**
+ * @brief Function for initializing the two-way exchanges.
+ * The CRCOK of a request is captured on TIMER2 CC[3]. The transmitter never receives anything else.
+ * Connections to be made:
+ *     - Timestamp the request: EVENTS_CRCOK from RADIO with TASKS_CAPTURE[3] from TIMER2 -> PPI channel TWO_WAY_PPI_CH
+ *     - End the listen: EVENTS_COMPARE[2] from TIMER2 with TASKS_DISABLE from RADIO -> PPI channel TWO_WAY_TIMEOUT_PPI_CH
+ *       (enabled while listening only, see twoway_radio_end())
+ */
+void twoway_setup() {
+
+    NRF_RADIO->RXADDRESSES = (1UL << TWO_WAY_ADDRESS);
+
+    NRF_PPI->CH[TWO_WAY_PPI_CH].EEP = (uint32_t)&NRF_RADIO->EVENTS_CRCOK;
+    NRF_PPI->CH[TWO_WAY_PPI_CH].TEP = (uint32_t)&NRF_TIMER2->TASKS_CAPTURE[3];
+
+    NRF_PPI->CH[TWO_WAY_TIMEOUT_PPI_CH].EEP = (uint32_t)&NRF_TIMER2->EVENTS_COMPARE[2];
+    NRF_PPI->CH[TWO_WAY_TIMEOUT_PPI_CH].TEP = (uint32_t)&NRF_RADIO->TASKS_DISABLE;
+
+    NRF_PPI->CHENSET = (1UL << TWO_WAY_PPI_CH);
+}
+
+/**
+ * @brief Function for listening for the request, the radio being disabled after the beacon.
+ * READY starts the reception and END disables the radio. TIMER2 CC[2] disables it instead if the request
+ * has not ended TWO_WAY_WINDOW after it is due, about one ms after the beacon.
+ */
+static void twoway_listen() {
+
+    NRF_TIMER2->CC[2]             = NRF_TIMER2->CC[0] + SYNC_US_TO_TICKS(TWO_WAY_REPLY_DELAY, TIMER_PRESCALER) +
+                                    MS_TO_TICKS(SYNC_PHY_ADDRESS_TO_END_MS(RADIO_PHY, PACKET_LENGTH, PACKET_CRC_LENGTH) +
+                                                SYNC_PHY_RX_CHAIN_DELAY_MS(RADIO_PHY) +
+                                                SYNC_PHY_OFFSET_MS(RADIO_PHY, PACKET_BALEN + 1, PACKET_LENGTH, PACKET_CRC_LENGTH) +
+                                                TWO_WAY_WINDOW);
+    NRF_TIMER2->EVENTS_COMPARE[2] = 0;
+    NRF_PPI->CHENSET              = (1UL << TWO_WAY_TIMEOUT_PPI_CH);
+
+    NRF_RADIO->EVENTS_DISABLED = 0;
+    twoway_listening           = true;
+    NRF_RADIO->TASKS_RXEN      = 1;
+}
+
+/**
+ * @brief Function for handling the RADIO END event: listen for the request of the node of this beacon.
+ * Nothing waits in the interrupt: the radio is disabled (by the END to DISABLE shortcut with HOP_MODE),
+ * the DISABLED interrupt enables it in RX (see twoway_listen()), and the next DISABLED interrupt ends the
+ * listen, whether the request ended or the timeout hit (see twoway_radio_disabled()). The ADDRESS link and
+ * the END interrupt are off until then, so TIMER2 CC[0] still holds the address of the beacon. The READY
+ * link that starts the first beacon is disabled for good.
+ */
+static void twoway_radio_end() {
+
+    twoway_chen   = NRF_PPI->CHEN & PPI_CHEN_CH7_Msk;
+    twoway_shorts = NRF_RADIO->SHORTS;
+
+    NRF_PPI->CHENCLR    = twoway_chen | (PPI_CHENCLR_CH4_Clear << PPI_CHENCLR_CH4_Pos);
+    NRF_RADIO->INTENCLR = (RADIO_INTENCLR_END_Clear << RADIO_INTENCLR_END_Pos);
+
+    NRF_RADIO->PACKETPTR    = (uint32_t)twoway_packet;
+    NRF_RADIO->EVENTS_CRCOK = 0;
+    NRF_RADIO->SHORTS       = (RADIO_SHORTS_READY_START_Enabled << RADIO_SHORTS_READY_START_Pos) |
+                              (RADIO_SHORTS_END_DISABLE_Enabled << RADIO_SHORTS_END_DISABLE_Pos);
+
+    twoway_listening           = false;
+    NRF_RADIO->EVENTS_DISABLED = 0;
+    NRF_RADIO->INTENSET        = (RADIO_INTENSET_DISABLED_Enabled << RADIO_INTENSET_DISABLED_Pos);
+
+    // in TXIDLE without HOP_MODE. With it, DISABLED is on its way, or was cleared above if already there
+    uint32_t state = NRF_RADIO->STATE;
+    if (state == RADIO_STATE_STATE_TxIdle) {
+        NRF_RADIO->TASKS_DISABLE = 1;
+    } else if (state == RADIO_STATE_STATE_Disabled) {
+        twoway_listen();
+    }
+}
+
+/**
+ * @brief Function for handling the RADIO DISABLED event that ends the listen: check the request and
+ * set the radio back for the beacons. The next beacon answers the request.
+ */
+static void twoway_radio_disabled() {
+    uint8_t  node;
+    uint32_t sequence;
+
+    NRF_PPI->CHENCLR    = (1UL << TWO_WAY_TIMEOUT_PPI_CH);
+    NRF_RADIO->INTENCLR = (RADIO_INTENCLR_DISABLED_Clear << RADIO_INTENCLR_DISABLED_Pos);
+    twoway_listening    = false;
+
+    beacon.reply_time = 0;
+    beacon.reply_node = SYNC_BEACON_NO_REPLY;
+
+    if (NRF_RADIO->EVENTS_CRCOK && sync_twoway_parse_request(twoway_packet, &node, &sequence) &&
+        sequence == beacon.sequence && node == sync_twoway_slot(beacon.sequence, TWO_WAY_NODES)) {
+        uint32_t reply = (uint32_t)SYNC_TICKS_TO_NS(NRF_TIMER2->CC[3] - NRF_TIMER2->CC[0], TIMER_PRESCALER);
+
+        if (reply <= SYNC_BEACON_REPLY_MAX) {
+            beacon.reply_time = reply;
+            beacon.reply_node = node;
+        }
+    }
+
+    NRF_RADIO->SHORTS     = twoway_shorts;
+    NRF_RADIO->PACKETPTR  = (uint32_t)packet;
+    NRF_RADIO->EVENTS_END = 0;
+    NRF_RADIO->INTENSET   = (RADIO_INTENSET_END_Enabled << RADIO_INTENSET_END_Pos);
+    NRF_PPI->CHENSET      = twoway_chen;
+
+#if !HOP_MODE
+    // back in TXIDLE for the start at the end of the period, hop_radio_end() does it on the next channel
+    NRF_RADIO->TASKS_TXEN = 1;
+#endif
+}
+
+#endif // TWO_WAY_MODE
+
+/**
+ * @brief Function for handling the RADIO interrupt.
+ */
+void RADIO_IRQHandler(void) {
+
+#if SCAN_MODE
+    if (scan_sampling) {
+        scan_radio_event();
+        return;
+    }
+#endif
+
+#if TWO_WAY_MODE
+    if (NRF_RADIO->EVENTS_DISABLED && (NRF_RADIO->INTENSET & RADIO_INTENSET_DISABLED_Msk)) {
+        NRF_RADIO->EVENTS_DISABLED = 0;
+
+        if (!twoway_listening) {
+            twoway_listen();
+            return;
+        }
+        twoway_radio_disabled();
+#if HOP_MODE
+        hop_radio_end();
+#endif
+        beacon_radio_end();
+    }
+#endif
+
+#if HOP_MODE && !TWO_WAY_MODE
+    if ((NRF_RADIO->INTENSET & RADIO_INTENSET_DISABLED_Msk) && NRF_RADIO->STATE == RADIO_STATE_STATE_Disabled) {
+        hop_radio_disabled();
+    }
+#endif
+
+    if (NRF_RADIO->EVENTS_END) {
+        NRF_RADIO->EVENTS_END = 0;
+
+#if BURST_MODE
+        if (!burst_radio_end()) {
+            return;
+        }
+#endif
+
+#if CALIBRATION_MODE
+        if (NRF_PPI->CHEN & PPI_CHEN_CH5_Msk) {
+            calibration_radio_end();
+        }
+#endif
+#if TWO_WAY_MODE
+        // the next beacon is prepared once the listen is over
+        twoway_radio_end();
+#else
+#if HOP_MODE
+        hop_radio_end();
+#endif
+        beacon_radio_end();
+#endif
+    }
+}
+
+#if COMMAND_MODE
+
+/**
+ * @brief Function for handling the command UART events.
+ * Received bytes are read from the FIFO in the main loop (see command_process()).
+ */
+static void command_uart_event(app_uart_evt_t *event) {
+
+    if (event->evt_type == APP_UART_COMMUNICATION_ERROR || event->evt_type == APP_UART_FIFO_ERROR) {
+        NRF_LOG_WARNING("command: UART error %u", event->data.error_code);
+    }
+}
+
+/**
+ * @brief Function for initializing the runtime commands.
+ * Commands arrive on a second UART (instance 1, the log keeps instance 0). A change is double buffered:
+ * the main loop stages its compares in command_shadow, and the TIMER0 COMPARE[1] interrupt (falling edge)
+ * announces it in the beacons for COMMAND_SWITCH_LEAD periods (see sync_beacon.h). At the falling edge
+ * before the switch sequence, it repacks the beacon with the new schedule and arms the commit link, and
+ * the EGU0 interrupt triggered by the end of the period writes all compares at once:
+ *     - TIMER0 CC[1] (width) and CC[2] (period): TIMER0 has just been cleared and stopped
+ *     - TIMER1 CC[0] (offset): TIMER1 has just started, the offset is at least COMMAND_MARGIN
+ * so every period is generated entirely with the old or entirely with the new schedule. The EGU0 interrupt
+ * preempts the RADIO and TIMER0 ones, so the only bound on its latency is COMMAND_MARGIN.
+ * Connections to be made:
+ *     - Commit the shadow compares: EVENTS_COMPARE[2] from TIMER0 with TASKS_TRIGGER[COMMAND_EGU_CH] from EGU0 -> PPI channel COMMAND_PPI_CH
+ */
+void command_setup() {
+    uint32_t               err_code;
+    app_uart_comm_params_t params = {
+        .rx_pin_no    = COMMAND_PIN(COMMAND_RX_PIN_PORT, COMMAND_RX_PIN_NUMBER),
+        .tx_pin_no    = COMMAND_PIN(COMMAND_TX_PIN_PORT, COMMAND_TX_PIN_NUMBER),
+        .rts_pin_no   = UART_PIN_DISCONNECTED,
+        .cts_pin_no   = UART_PIN_DISCONNECTED,
+        .flow_control = APP_UART_FLOW_CONTROL_DISABLED,
+        .use_parity   = false,
+        .baud_rate    = COMMAND_BAUDRATE,
+    };
+
+    command_config.period = MS_TO_US(PULSE_PERIOD);
+    command_config.width  = MS_TO_US(PULSE_DURATION);
+    command_config.offset = MS_TO_US(TIMER_OFFSET);
+#if HOP_MODE
+    command_config.channels = HOP_MAP;
+#else
+    command_config.channels = 0;
+#endif
+    command_staged        = false;
+    command_announced     = false;
+    command_armed         = false;
+    command_applied       = false;
+    sync_command_parser_init(&command_parser);
+
+    APP_UART_FIFO_INIT(&params, COMMAND_FIFO_SIZE, COMMAND_FIFO_SIZE, command_uart_event, APP_IRQ_PRIORITY_LOWEST, err_code);
+    APP_ERROR_CHECK(err_code);
+
+    NRF_PPI->CH[COMMAND_PPI_CH].EEP = (uint32_t)&NRF_TIMER0->EVENTS_COMPARE[2];
+    NRF_PPI->CH[COMMAND_PPI_CH].TEP = (uint32_t)&NRF_EGU0->TASKS_TRIGGER[COMMAND_EGU_CH];
+
+    // the commit link stays disabled until a change is staged
+
+    NRF_TIMER0->EVENTS_COMPARE[1] = 0;
+    NRF_TIMER0->INTENSET          = (TIMER_INTENSET_COMPARE1_Enabled << TIMER_INTENSET_COMPARE1_Pos);
+    NVIC_SetPriority(TIMER0_IRQn, COMMAND_OTHER_PRIORITY);
+    NVIC_EnableIRQ(TIMER0_IRQn);
+
+    // the commit must not wait for a RADIO or TIMER0 handler, they all default to the highest priority
+    NVIC_SetPriority(RADIO_IRQn, COMMAND_OTHER_PRIORITY);
+
+    NRF_EGU0->EVENTS_TRIGGERED[COMMAND_EGU_CH] = 0;
+    NRF_EGU0->INTENSET                         = (1UL << COMMAND_EGU_CH);
+    NVIC_SetPriority(SWI0_EGU0_IRQn, COMMAND_IRQ_PRIORITY);
+    NVIC_EnableIRQ(SWI0_EGU0_IRQn);
+}
+
+/**
+ * @brief Function for sending an acknowledgement.
+ */
+static void command_reply(sync_command_t *command) {
+    uint8_t frame[SYNC_COMMAND_LENGTH];
+
+    command->id |= SYNC_COMMAND_ACK;
+    sync_command_pack(frame, command);
+
+    for (uint8_t i = 0; i < SYNC_COMMAND_LENGTH; i++) {
+        if (app_uart_put(frame[i]) != NRF_SUCCESS) {
+            NRF_LOG_WARNING("command: TX FIFO full, acknowledgement dropped");
+            return;
+        }
+    }
+}
+
+#if OUTPUTS_MODE || PWM_SEQUENCE_MODE
+
+/**
+ * @brief Function for checking that the extra outputs and the PWM sequence still end before the next rising
+ * edge with a new period in us. outputs_setup() and pwm_setup() only checked them against PULSE_PERIOD.
+ */
+static bool command_fits(uint32_t period) {
+#if OUTPUTS_MODE
+    sync_outputs_plan_t plan;
+
+    if (outputs_enabled &&
+        !sync_outputs_plan(outputs, OUTPUT_COUNT, TIMER3_CC_NUM, 0, SYNC_US_TO_TICKS(period, TIMER_PRESCALER), &plan)) {
+        return false;
+    }
+#endif
+#if PWM_SEQUENCE_MODE
+    if ((uint64_t)pwm_length * PWM_MS_TO_TICKS(PWM_SLOT) * 1000 >= (uint64_t)period * SYNC_TICKS_PER_MS(PWM_PRESCALER)) {
+        return false;
+    }
+#endif
+    return true;
+}
+
+#endif // OUTPUTS_MODE || PWM_SEQUENCE_MODE
+
+/**
+ * @brief Function for handling a received command.
+ * Reads are acknowledged at once, accepted changes once they are committed. The compares are
+ * converted here, so the commit interrupt only copies them.
+ */
+static void command_handle(sync_command_t *command) {
+    sync_command_config_t next;
+
+#if HOP_MODE
+    command_config.channels = hop_next_map;   // may have been changed by the scan
+#endif
+#if SCAN_MODE
+    if (command->id == SYNC_COMMAND_LOSS) {
+        if ((command->value >> 16) >= HOP_CHANNELS || (command->value & 0xFFFFUL) > 1000) {
+            command->status = SYNC_COMMAND_RANGE;
+        } else {
+            command->status = SYNC_COMMAND_OK;
+            sync_scan_loss(&scan, (uint8_t)(command->value >> 16), command->value & 0xFFFFUL);
+        }
+        command_reply(command);
+        return;
+    }
+#endif
+    next = command_config;
+
+    if (command->id != SYNC_COMMAND_READ && (command_staged || command_announced || command_armed || command_applied)) {
+        command->status = SYNC_COMMAND_BUSY;
+#if HOP_MODE
+    } else if (command->id == SYNC_COMMAND_CHANNELS &&
+               (sync_hop_count(command->value) < SYNC_HOP_MIN_CHANNELS || ((uint64_t)command->value >> HOP_CHANNELS) != 0)) {
+        command->status = SYNC_COMMAND_RANGE;
+#else
+    } else if (command->id == SYNC_COMMAND_CHANNELS) {
+        command->status = SYNC_COMMAND_UNKNOWN;
+#endif
+    } else {
+        command->status = sync_command_apply(&next, command, MS_TO_US(COMMAND_MARGIN), COMMAND_MAX_US);
+    }
+
+#if OUTPUTS_MODE || PWM_SEQUENCE_MODE
+    if (command->status == SYNC_COMMAND_OK && !command_fits(next.period)) {
+        command->status = SYNC_COMMAND_RANGE;
+    }
+#endif
+
+    if (command->status != SYNC_COMMAND_OK || command->id == SYNC_COMMAND_READ) {
+        command_reply(command);
+        return;
+    }
+
+#if HOP_MODE
+    if (command->id == SYNC_COMMAND_CHANNELS) {
+        // announced once the previous change of channel map is done, the schedule is not touched
+        command_config.channels = next.channels;
+        hop_next_map            = next.channels;
+        command_reply(command);
+
+        NRF_LOG_INFO("command: channel map 0x%08x", next.channels);
+        return;
+    }
+#endif
+
+    command_next          = next;
+    command_shadow.offset = SYNC_US_TO_TICKS(next.offset, TIMER_PRESCALER);
+    command_shadow.width  = SYNC_US_TO_TICKS(next.width,  TIMER_PRESCALER);
+    command_shadow.period = SYNC_US_TO_TICKS(next.period, TIMER_PRESCALER);
+    command_pending       = *command;
+    command_staged        = true;
+}
+
+/**
+ * @brief Function for processing the received bytes and the applied changes, from the main loop.
+ */
+static void command_process() {
+    sync_command_t command;
+    uint8_t        byte;
+
+    if (command_applied) {
+        command_config  = command_next;
+        command_applied = false;
+        command_reply(&command_pending);
+
+        NRF_LOG_INFO("command: period %u us, width %u us, offset %u us from beacon %u",
+                     command_config.period, command_config.width, command_config.offset, beacon.switch_sequence);
+    }
+
+    while (app_uart_get(&byte) == NRF_SUCCESS) {
+        switch (sync_command_parse(&command_parser, byte, &command)) {
+            case SYNC_COMMAND_PARSE_FRAME:
+                command_handle(&command);
+                break;
+            case SYNC_COMMAND_PARSE_ERROR:
+                command_reply(&command);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/**
+ * @brief Function for handling the TIMER0 interrupt: the falling edge, announce or arm a staged change.
+ * The radio is idle until the end of the period, so the beacon sent then (sequence number
+ * beacon.sequence, see beacon_radio_end()) can be repacked.
+ */
+void TIMER0_IRQHandler(void) {
+
+    if (NRF_TIMER0->EVENTS_COMPARE[1]) {
+        NRF_TIMER0->EVENTS_COMPARE[1] = 0;
+
+        if (command_staged) {
+            // TIMER0 restarts after the TIMER1 offset, as in beacon_setup()
+            beacon.next_period_us  = command_next.period + command_next.offset;
+            beacon.next_width_us   = command_next.width;
+            beacon.switch_sequence = beacon.sequence + COMMAND_SWITCH_LEAD;
+            sync_beacon_pack(packet, &beacon);
+
+            command_staged    = false;
+            command_announced = true;
+        } else if (command_announced && beacon.sequence == beacon.switch_sequence) {
+            // the beacon sent at the end of this period starts the new schedule
+            beacon.period_us = beacon.next_period_us;
+            beacon.width_us  = beacon.next_width_us;
+            sync_beacon_pack(packet, &beacon);
+
+            command_announced = false;
+            command_armed     = true;
+            NRF_PPI->CHENSET  = (1UL << COMMAND_PPI_CH);
+        }
+    }
+}
+
+/**
+ * @brief Function for handling the EGU0 interrupt: the period ended, commit the shadow compares.
+ */
+void SWI0_EGU0_IRQHandler(void) {
+
+    if (NRF_EGU0->EVENTS_TRIGGERED[COMMAND_EGU_CH]) {
+        NRF_EGU0->EVENTS_TRIGGERED[COMMAND_EGU_CH] = 0;
+
+        NRF_TIMER0->CC[1] = command_shadow.width;
+        NRF_TIMER0->CC[2] = command_shadow.period;
+        NRF_TIMER1->CC[0] = command_shadow.offset;
+
+        NRF_PPI->CHENCLR  = (1UL << COMMAND_PPI_CH);
+        command_armed     = false;
+        command_applied   = true;
+    }
+}
+
+#endif // COMMAND_MODE
+
+#if LOG_MODE
+
+#if DUTY_CYCLE_MODE
+
+/**
+ * @brief Function for logging the modelled energy of one period (see sync_energy.h), duty-cycled and as
+ * the default transmitter would spend it with HFCLK and the radio always on.
+ */
+void energy_report() {
+    sync_energy_model_t    model;
+    sync_energy_timeline_t timeline;
+    sync_energy_report_t   duty_cycled;
+    sync_energy_report_t   continuous;
+    sync_rtc_t             rtc_model;
+    sync_energy_timing_t   timing = {
+        .period       = DUTY_CYCLE_PERIOD_US,
+        .hfxo_startup = MS_TO_US(DUTY_CYCLE_HFXO_STARTUP),
+        .rampup       = MS_TO_US(RADIO_RAMPUP),
+        .airtime      = MS_TO_US(SYNC_PHY_TX_CHAIN_DELAY_MS +
+                                 SYNC_PHY_FRAME_TIME_MS(RADIO_PHY, PACKET_BALEN + 1, PACKET_LENGTH, PACKET_CRC_LENGTH)),
+        .offset       = MS_TO_US(TIMER_OFFSET),
+        .width        = MS_TO_US(PULSE_DURATION),
+    };
+
+    if (!sync_rtc_init(&rtc_model, DUTY_CYCLE_PERIOD_US, MS_TO_US(DUTY_CYCLE_WAKE_LEAD))) {
+        return;
+    }
+    sync_energy_default_model(&model);
+
+#if BURST_MODE
+    // the radio stays in TXIDLE between the copies, counted as on air
+    timing.airtime += (BURST_COPIES - 1) * BURST_SPACING;
+#endif
+
+    // HFCLK also runs during the fine remainder, half a tick on average. TIMER2 only runs from HFCLKSTARTED
+    // to the end of the beacon (see beacon_setup()), within the steps of the timeline
+    timing.wake_lead = rtc_model.lead * sync_rtc_tick_us(&rtc_model) + sync_rtc_tick_us(&rtc_model) / 2;
+    sync_energy_duty_cycled_timeline(&timing, &timeline);
+    if (!sync_energy_evaluate(&model, &timeline, &duty_cycled)) {
+        return;
+    }
+
+    sync_energy_continuous_timeline(&timing, &timeline);
+    if (!sync_energy_evaluate(&model, &timeline, &continuous)) {
+        return;
+    }
+
+    NRF_LOG_INFO("energy model: %u uJ per period, %u nA average (%u uJ, %u nA without DUTY_CYCLE_MODE)",
+                 (uint32_t)(duty_cycled.energy_nj / 1000), duty_cycled.average_na,
+                 (uint32_t)(continuous.energy_nj / 1000), continuous.average_na);
+}
+
+#endif // DUTY_CYCLE_MODE
+
+/**
+ * @brief Function for initializing the logger (UART backend, see sdk_config.h).
+ */
+void log_setup() {
+    ret_code_t err_code = NRF_LOG_INIT(NULL);
+    APP_ERROR_CHECK(err_code);
+
+    NRF_LOG_DEFAULT_BACKENDS_INIT();
+}
+
+#endif // LOG_MODE
+
 /**
  * @brief Function for application main entry.
  */
 int main(void) {
 
     // setup peripherals
+#if LOG_MODE
+    log_setup();
+#endif
     gpiote_setup();
     timer0_setup();
+#if !SCHEDULE_FREE_RUNNING
     timer1_setup();
+#endif
     radio_setup();
     ppi_setup();
+    beacon_setup();
+#if OUTPUTS_MODE
+    outputs_setup();
+#endif
+#if PWM_SEQUENCE_MODE
+    pwm_setup();
+#endif
+#if CALIBRATION_MODE
+    calibration_setup();
+#endif
+#if COMMAND_MODE
+    command_setup();
+#endif
+#if HOP_MODE
+    hop_setup();
+#endif
+#if BURST_MODE
+    burst_setup();
+    burst_report();
+#endif
+#if TWO_WAY_MODE
+    twoway_setup();
+#endif
+#if DUTY_CYCLE_MODE
+    energy_report();
+#endif
 
     // start
+#if DUTY_CYCLE_MODE
+    // HFCLK and the Radio are started by RTC2 ahead of every period (through PPI)
+    rtc_setup();
+#else
     // external HFCLK must be started and the Radio must be enabled as TX (the radio thing will be done through PPI)
     NRF_CLOCK->TASKS_HFCLKSTART = CLOCK_TASKS_HFCLKSTART_TASKS_HFCLKSTART_Trigger;
+#endif
 
     while (true) {
+#if COMMAND_MODE
+        command_process();
+#endif
+#if LOG_MODE
+        if (!NRF_LOG_PROCESS()) {
+            __WFE();
+        }
+#else
         __WFE();
+#endif
     }
 }
 
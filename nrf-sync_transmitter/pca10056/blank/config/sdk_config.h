@@ -548,7 +548,7 @@
 // <e> UART1_ENABLED - Enable UART1 instance
 //==========================================================
 #ifndef UART1_ENABLED
-#define UART1_ENABLED 0
+#define UART1_ENABLED 1
 #endif
 // </e>
 
@@ -691,9 +691,10 @@
 // <o> APP_UART_DRIVER_INSTANCE  - UART instance used
  
 // <0=> 0 
+// <1=> 1 
 
 #ifndef APP_UART_DRIVER_INSTANCE
-#define APP_UART_DRIVER_INSTANCE 0
+#define APP_UART_DRIVER_INSTANCE 1
 #endif
 
 // </e>